@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Mini arnés de microbenchmarks. Cada caso recibe cuántas iteraciones hacer y
+ * las ejecuta en un solo bucle; el arnés calibra ese número para que una
+ * medición dure ~TIEMPO_OBJETIVO y repite la medición REPETICIONES veces.
+ * Se reporta la mediana (estable frente a interrupciones) y el mínimo.
+ */
+namespace bench {
+
+// Impedir que el compilador elimine un cálculo cuyo resultado no se usa
+template <typename T> inline void usar(T &&valor) {
+  asm volatile("" : : "g"(&valor) : "memory");
+}
+
+struct Resultado {
+  std::string nombre;
+  std::string parametro; // Tamaño del caso ("10000 rutas"), puede ir vacío
+  uint64_t iteraciones = 0; // Por medición
+  double ns_op = 0;         // Mediana
+  double ns_op_min = 0;
+};
+
+class Suite {
+public:
+  static constexpr auto TIEMPO_OBJETIVO = std::chrono::milliseconds(50);
+  static constexpr int REPETICIONES = 7;
+
+  explicit Suite(std::string filtro = "") : filtro_(std::move(filtro)) {}
+
+  void correr(const std::string &nombre, const std::string &parametro,
+              const std::function<void(uint64_t)> &caso) {
+    std::string completo = parametro.empty() ? nombre : nombre + "/" + parametro;
+    if (!filtro_.empty() && completo.find(filtro_) == std::string::npos)
+      return;
+
+    // Calibrar: duplicar iteraciones hasta acercarse al tiempo objetivo
+    uint64_t iteraciones = 1;
+    for (;;) {
+      double ns = medir(caso, iteraciones);
+      if (ns >= objetivo_ns() / 2 || iteraciones >= (uint64_t(1) << 40)) {
+        iteraciones = std::max<uint64_t>(
+            1, static_cast<uint64_t>(iteraciones * objetivo_ns() /
+                                     std::max(ns, 1.0)));
+        break;
+      }
+      iteraciones *= 2;
+    }
+
+    std::vector<double> muestras;
+    for (int r = 0; r < REPETICIONES; ++r)
+      muestras.push_back(medir(caso, iteraciones) / iteraciones);
+    std::sort(muestras.begin(), muestras.end());
+
+    Resultado res{nombre, parametro, iteraciones, muestras[muestras.size() / 2],
+                  muestras.front()};
+    std::printf("%-34s %-16s %12.1f ns/op %12.1f min %14.0f ops/s\n",
+                res.nombre.c_str(), res.parametro.c_str(), res.ns_op,
+                res.ns_op_min, 1e9 / res.ns_op);
+    std::fflush(stdout);
+    resultados_.push_back(std::move(res));
+  }
+
+  const std::vector<Resultado> &resultados() const { return resultados_; }
+
+  // Resultados en JSON para comparar entre versiones
+  bool guardar_json(const std::string &ruta, const std::string &version) const {
+    std::FILE *f = std::fopen(ruta.c_str(), "w");
+    if (!f)
+      return false;
+    auto segundos = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+    std::fprintf(f, "{\n  \"version\": \"%s\",\n  \"timestamp\": %lld,\n",
+                 escapar(version).c_str(), static_cast<long long>(segundos));
+    std::fprintf(f, "  \"compiler\": \"%s\",\n  \"results\": [\n",
+                 escapar(__VERSION__).c_str());
+    for (std::size_t i = 0; i < resultados_.size(); ++i) {
+      const Resultado &r = resultados_[i];
+      std::fprintf(f,
+                   "    {\"name\": \"%s\", \"param\": \"%s\", "
+                   "\"iterations\": %llu, \"ns_per_op\": %.2f, "
+                   "\"ns_per_op_min\": %.2f, \"ops_per_sec\": %.0f}%s\n",
+                   escapar(r.nombre).c_str(), escapar(r.parametro).c_str(),
+                   static_cast<unsigned long long>(r.iteraciones), r.ns_op,
+                   r.ns_op_min, 1e9 / r.ns_op,
+                   i + 1 < resultados_.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+  }
+
+private:
+  static double objetivo_ns() {
+    return std::chrono::duration<double, std::nano>(TIEMPO_OBJETIVO).count();
+  }
+
+  static double medir(const std::function<void(uint64_t)> &caso,
+                      uint64_t iteraciones) {
+    auto inicio = std::chrono::steady_clock::now();
+    caso(iteraciones);
+    auto fin = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(fin - inicio).count();
+  }
+
+  static std::string escapar(const std::string &texto) {
+    std::string salida;
+    for (char c : texto) {
+      if (c == '"' || c == '\\')
+        salida += '\\';
+      salida += c;
+    }
+    return salida;
+  }
+
+  std::string filtro_;
+  std::vector<Resultado> resultados_;
+};
+
+} // namespace bench
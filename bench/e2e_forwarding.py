@@ -0,0 +1,375 @@
+#!/usr/bin/env python3
+"""
+Benchmark de forwarding de punta a punta con varias instancias del router.
+
+Genera una topología en cadena o en malla (cuadrícula) para N routers, lanza
+un proceso ./router por router en localhost, configura direcciones y rutas
+estáticas por la CLI, genera tráfico con el traffic-generator del primer
+router hacia la Loopback del último y reporta:
+
+  - throughput enviado y recibido (pps, Mbps)
+  - latencia de punta a punta (promedio, p50, p99, máxima)
+  - por salto: paquetes recibidos, reenviados, descartados por el router y
+    perdidos en el enlace anterior (enviados por el salto previo y nunca
+    recibidos)
+
+Uso: bench/e2e_forwarding.py [--routers N] [--topology chain|mesh] ...
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+# ----------------------------- Topología -----------------------------
+
+class Red:
+    """Routers, enlaces y caminos de una topología generada."""
+
+    def __init__(self, n, tipo):
+        self.n = n
+        self.tipo = tipo
+        self.enlaces = []  # (a, b): índices de router, a < b
+        if tipo == "chain":
+            for i in range(n - 1):
+                self.enlaces.append((i, i + 1))
+            self.columnas = n
+        else:
+            # Cuadrícula lo más cuadrada posible; el último router queda en la
+            # esquina opuesta al primero si n es un rectángulo completo
+            self.columnas = math.ceil(math.sqrt(n))
+            for i in range(n):
+                fila, col = divmod(i, self.columnas)
+                if col + 1 < self.columnas and i + 1 < n:
+                    self.enlaces.append((i, i + 1))
+                if i + self.columnas < n:
+                    self.enlaces.append((i, i + self.columnas))
+
+        # Interfaces de cada router en orden: GigabitEthernet0/<k>
+        self.interfaces = [[] for _ in range(n)]  # (enlace, vecino)
+        for e, (a, b) in enumerate(self.enlaces):
+            self.interfaces[a].append((e, b))
+            self.interfaces[b].append((e, a))
+
+    def nombre(self, i):
+        return "Router%d" % (i + 1)
+
+    def interfaz(self, i, k):
+        return "GigabitEthernet0/%d" % k
+
+    def ip_enlace(self, e, router):
+        # Un /24 por enlace; el router de menor índice es .1
+        a, _ = self.enlaces[e]
+        return "10.%d.%d.%d" % (1 + e // 256, e % 256, 1 if router == a else 2)
+
+    def loopback(self, i):
+        return "10.255.%d.%d" % (i // 250, i % 250 + 1)
+
+    def siguiente(self, origen, destino):
+        """Vecino hacia 'destino': recorrer columnas y después filas (XY)."""
+        if self.tipo == "chain":
+            return origen + 1 if destino > origen else origen - 1
+        fila, col = divmod(origen, self.columnas)
+        fila_d, col_d = divmod(destino, self.columnas)
+        if col != col_d:
+            candidato = origen + (1 if col_d > col else -1)
+            if candidato < self.n:
+                return candidato
+        if fila != fila_d:
+            return origen + (self.columnas if fila_d > fila else -self.columnas)
+        return origen + (1 if col_d > col else -1)
+
+    def camino(self, origen, destino):
+        ruta = [origen]
+        while ruta[-1] != destino:
+            ruta.append(self.siguiente(ruta[-1], destino))
+        return ruta
+
+    def indice_interfaz(self, router, vecino):
+        for k, (_, v) in enumerate(self.interfaces[router]):
+            if v == vecino:
+                return k
+        raise ValueError("sin enlace %d-%d" % (router, vecino))
+
+    def ip_vecino(self, router, vecino):
+        e, _ = self.interfaces[router][self.indice_interfaz(router, vecino)]
+        return self.ip_enlace(e, vecino)
+
+    def escribir_topologia(self, ruta, puerto_base, enlace_shm, prefijo):
+        with open(ruta, "w") as f:
+            f.write("# Generado por bench/e2e_forwarding.py (%s, %d routers)\n"
+                    % (self.tipo, self.n))
+            for i in range(self.n):
+                for k, (e, vecino) in enumerate(self.interfaces[i]):
+                    if enlace_shm:
+                        f.write("%s %s shm %s-e%d\n" % (
+                            self.nombre(i), self.interfaz(i, k), prefijo, e))
+                    else:
+                        local = puerto_base + 2 * e + (0 if i < vecino else 1)
+                        remoto = puerto_base + 2 * e + (1 if i < vecino else 0)
+                        f.write("%s %s %d 127.0.0.1 %d\n" % (
+                            self.nombre(i), self.interfaz(i, k), local, remoto))
+
+    def configuracion(self, i):
+        """Comandos de CLI que dejan al router 'i' listo para reenviar."""
+        lineas = ["enable", "configure terminal"]
+        for k, (e, _) in enumerate(self.interfaces[i]):
+            lineas += ["interface " + self.interfaz(i, k),
+                       "ip address %s 255.255.255.0" % self.ip_enlace(e, i),
+                       "no shutdown", "exit"]
+        lineas += ["interface Loopback0",
+                   "ip address %s 255.255.255.255" % self.loopback(i), "exit"]
+        for destino in range(self.n):
+            if destino == i:
+                continue
+            vecino = self.siguiente(i, destino)
+            lineas.append("ip route %s 255.255.255.255 %s" % (
+                self.loopback(destino), self.ip_vecino(i, vecino)))
+        lineas.append("end")
+        return lineas
+
+
+# ----------------------------- Procesos -----------------------------
+
+class Instancia:
+    def __init__(self, nombre, binario, topologia, args, log):
+        self.nombre = nombre
+        self.log_ruta = log
+        self.log = open(log, "w")
+        self.proc = subprocess.Popen(
+            [binario, nombre, topologia] + args, stdin=subprocess.PIPE,
+            stdout=self.log, stderr=subprocess.STDOUT, text=True, bufsize=1)
+
+    def enviar(self, lineas):
+        for linea in lineas:
+            self.proc.stdin.write(linea + "\n")
+        self.proc.stdin.flush()
+
+    def marca(self, texto):
+        # Un comando inexistente deja una marca reconocible en el log
+        self.enviar(["#" + texto])
+
+    def cerrar(self, espera=5):
+        try:
+            self.proc.stdin.close()
+        except BrokenPipeError:
+            pass
+        try:
+            self.proc.wait(timeout=espera)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            self.proc.wait()
+        self.log.close()
+
+    def salida(self):
+        with open(self.log_ruta, errors="replace") as f:
+            return f.read()
+
+
+# ----------------------------- Parseo -----------------------------
+
+def seccion(texto, marca):
+    """Texto del log desde la marca dada hasta el final."""
+    pos = texto.rfind("#" + marca)
+    return texto[pos:] if pos >= 0 else ""
+
+
+def numero(patron, texto, defecto=0):
+    m = re.search(patron, texto)
+    return float(m.group(1)) if m else defecto
+
+
+def parsear_trafico_ip(texto):
+    return {
+        "rx": int(numero(r"Rcvd:\s+(\d+) total", texto)),
+        "local": int(numero(r"(\d+) local destination", texto)),
+        "forwarded": int(numero(r"Sent:\s+(\d+) forwarded", texto)),
+        "drop_ttl": int(numero(r"Drop:\s+(\d+) TTL", texto)),
+        "drop_no_route": int(numero(r"(\d+) no route", texto)),
+        "drop_if_down": int(numero(r"(\d+) interface down", texto)),
+        "drop_tx": int(numero(r"(\d+) send errors", texto)),
+        "drop_no_buffer": int(numero(r"(\d+) no buffer", texto)),
+    }
+
+
+def parsear_motor(texto):
+    return {
+        "rx_packets": int(numero(r"RX: (\d+) packets", texto)),
+        "tx_packets": int(numero(r"TX: (\d+) packets", texto)),
+        "tx_errors": int(numero(r"TX: \d+ packets, \d+ syscalls, (\d+) errors",
+                                texto)),
+        "pool_exhausted": int(numero(r"(\d+) exhausted", texto)),
+    }
+
+
+def parsear_generador(texto):
+    resultado = {
+        "tx_packets": int(numero(r"(\d+) packets, \d+ bytes in", texto)),
+        "tx_bytes": int(numero(r"\d+ packets, (\d+) bytes in", texto)),
+        "tx_seconds": numero(r"bytes in ([\d.]+) s", texto),
+        "tx_pps": numero(r"([\d.]+) pps, [\d.]+ Mbps", texto),
+        "tx_mbps": numero(r"[\d.]+ pps, ([\d.]+) Mbps", texto),
+    }
+    # Fila del receptor: Flow Dsts Packets pps Mbps Loss% avg p50/p99 max
+    fila = re.search(r"^\s+([0-9a-f]+)\s+(\d+)\s+(\d+)\s+([\d.]+)\s+([\d.]+)"
+                     r"\s+([\d.]+)\s+([\d.]+)\s+(\d+)/(\d+)\s+([\d.]+)",
+                     texto, re.M)
+    if fila:
+        resultado.update({
+            "rx_packets": int(fila.group(3)),
+            "rx_pps": float(fila.group(4)),
+            "rx_mbps": float(fila.group(5)),
+            "loss_pct": float(fila.group(6)),
+            "latency_avg_us": float(fila.group(7)),
+            "latency_p50_us": float(fila.group(8)),
+            "latency_p99_us": float(fila.group(9)),
+            "latency_max_us": float(fila.group(10)),
+        })
+    return resultado
+
+
+# ----------------------------- Principal -----------------------------
+
+def main():
+    raiz = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    p = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    p.add_argument("--routers", type=int, default=4)
+    p.add_argument("--topology", choices=["chain", "mesh"], default="chain")
+    p.add_argument("--rate", default="50000",
+                   help="pps del generador o 'max'")
+    p.add_argument("--duration", type=float, default=5.0, help="segundos")
+    p.add_argument("--size", default="256",
+                   help="bytes de payload, N o MIN-MAX")
+    p.add_argument("--binary", default=os.path.join(raiz, "router"))
+    p.add_argument("--router-args", default="",
+                   help="opciones extra para cada router, p. ej. '--workers 2'")
+    p.add_argument("--link", choices=["udp", "shm"], default="udp")
+    p.add_argument("--base-port", type=int, default=21000)
+    p.add_argument("--settle", type=float, default=1.0,
+                   help="segundos de espera para configurar y vaciar colas")
+    p.add_argument("--json", help="guardar el reporte en este archivo")
+    p.add_argument("--keep", action="store_true",
+                   help="conservar el directorio con topología y logs")
+    args = p.parse_args()
+
+    if args.routers < 2:
+        p.error("se necesitan al menos 2 routers")
+    if not os.access(args.binary, os.X_OK):
+        p.error("no se encontró el binario %s (make compile)" % args.binary)
+
+    red = Red(args.routers, args.topology)
+    origen, destino = 0, args.routers - 1
+    camino = red.camino(origen, destino)
+
+    trabajo = tempfile.mkdtemp(prefix="router-e2e-")
+    topologia = os.path.join(trabajo, "topology.txt")
+    red.escribir_topologia(topologia, args.base_port, args.link == "shm",
+                           "e2e%d" % os.getpid())
+
+    instancias = []
+    try:
+        extra = args.router_args.split()
+        for i in range(red.n):
+            instancias.append(Instancia(red.nombre(i), args.binary, topologia,
+                                        extra, os.path.join(
+                                            trabajo, red.nombre(i) + ".log")))
+        for i, inst in enumerate(instancias):
+            inst.enviar(red.configuracion(i))
+        time.sleep(args.settle)
+
+        salida = red.interfaz(origen, red.indice_interfaz(origen, camino[1]))
+        instancias[origen].enviar([
+            "traffic-generator start %s %s size %s rate %s duration %g" % (
+                salida, red.loopback(destino), args.size, args.rate,
+                args.duration)])
+        time.sleep(args.duration + args.settle)
+
+        for inst in instancias:
+            inst.marca("RESULTADOS")
+            inst.enviar(["show ip traffic", "show engine statistics",
+                         "show traffic-generator"])
+    finally:
+        for inst in instancias:
+            inst.cerrar()
+
+    # Reporte
+    textos = [seccion(inst.salida(), "RESULTADOS") for inst in instancias]
+    if not all(textos):
+        print("ERROR: algún router no respondió; logs en " + trabajo,
+              file=sys.stderr)
+        return 1
+
+    generador = parsear_generador(textos[origen])
+    receptor = parsear_generador(textos[destino])
+    saltos = []
+    enviados_previos = None
+    for i in camino:
+        ip = parsear_trafico_ip(textos[i])
+        motor = parsear_motor(textos[i])
+        salto = {"router": red.nombre(i)}
+        salto.update(ip)
+        salto.update(motor)
+        salto["link_loss"] = (max(0, enviados_previos - motor["rx_packets"])
+                              if enviados_previos is not None else 0)
+        salto["drops"] = sum(v for k, v in ip.items() if k.startswith("drop"))
+        enviados_previos = motor["tx_packets"]
+        saltos.append(salto)
+
+    reporte = {
+        "topology": args.topology,
+        "routers": args.routers,
+        "link": args.link,
+        "hops": len(camino) - 1,
+        "rate": args.rate,
+        "size": args.size,
+        "duration_s": args.duration,
+        "router_args": args.router_args,
+        "sent": {k: generador.get(k, 0) for k in
+                 ("tx_packets", "tx_bytes", "tx_pps", "tx_mbps")},
+        "received": {k: receptor.get(k, 0) for k in
+                     ("rx_packets", "rx_pps", "rx_mbps", "loss_pct",
+                      "latency_avg_us", "latency_p50_us", "latency_p99_us",
+                      "latency_max_us")},
+        "per_hop": saltos,
+    }
+
+    print("Topología: %s, %d routers, %d saltos (%s)" % (
+        args.topology, args.routers, len(camino) - 1,
+        " -> ".join(red.nombre(i) for i in camino)))
+    print("Enviado:   %d paquetes, %.0f pps, %.1f Mbps" % (
+        generador.get("tx_packets", 0), generador.get("tx_pps", 0),
+        generador.get("tx_mbps", 0)))
+    print("Recibido:  %d paquetes, %.0f pps, %.1f Mbps, pérdida %.2f%%" % (
+        receptor.get("rx_packets", 0), receptor.get("rx_pps", 0),
+        receptor.get("rx_mbps", 0), receptor.get("loss_pct", 0)))
+    print("Latencia:  avg %.1f us, p50 %.0f us, p99 %.0f us, max %.1f us" % (
+        receptor.get("latency_avg_us", 0), receptor.get("latency_p50_us", 0),
+        receptor.get("latency_p99_us", 0), receptor.get("latency_max_us", 0)))
+    print()
+    print("%-10s %12s %12s %12s %10s %12s" % (
+        "Salto", "RX", "Reenviados", "Locales", "Descartes", "Perd. enlace"))
+    for s in saltos:
+        print("%-10s %12d %12d %12d %10d %12d" % (
+            s["router"], s["rx_packets"], s["forwarded"], s["local"],
+            s["drops"], s["link_loss"]))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(reporte, f, indent=2)
+        print("\nReporte en " + args.json)
+    if args.keep:
+        print("Topología y logs en " + trabajo)
+    else:
+        shutil.rmtree(trabajo, ignore_errors=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,232 @@
+#include "bench.hpp"
+#include "../include/packet.hpp"
+#include "../include/router_cli.hpp"
+#include "../include/router_core.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+
+constexpr std::size_t MUESTRAS = 4096; // Entradas precalculadas (potencia de 2)
+
+// Tabla con 'n' rutas estáticas de prefijos variados (/8 a /32), como una
+// tabla aprendida por OSPF
+void llenar_rutas(RouterCore &core, std::size_t n, std::mt19937 &azar,
+                  std::vector<uint32_t> &destinos) {
+  std::uniform_int_distribution<uint32_t> ip;
+  std::uniform_int_distribution<int> largo(8, 32);
+  for (std::size_t i = 0; i < n; ++i) {
+    int bits = largo(azar);
+    uint32_t mascara = bits == 32 ? 0xFFFFFFFFu : ~(0xFFFFFFFFu >> bits);
+    uint32_t red = ip(azar) & mascara;
+    core.set_route(ip_a_texto(red), ip_a_texto(mascara), "10.0.0.1", 0, "S");
+    destinos.push_back(red | (ip(azar) & ~mascara));
+  }
+}
+
+// La mitad de las búsquedas cae en una ruta y la otra mitad es al azar
+std::vector<uint32_t> consultas(const std::vector<uint32_t> &destinos,
+                                std::mt19937 &azar) {
+  std::uniform_int_distribution<uint32_t> ip;
+  std::vector<uint32_t> salida(MUESTRAS);
+  for (std::size_t i = 0; i < MUESTRAS; ++i)
+    salida[i] = i % 2 && !destinos.empty()
+                    ? destinos[ip(azar) % destinos.size()]
+                    : ip(azar);
+  return salida;
+}
+
+void bench_find_route(bench::Suite &suite, std::mt19937 &azar) {
+  for (std::size_t n : {10, 1000, 100000}) {
+    RouterCore core;
+    std::vector<uint32_t> destinos;
+    llenar_rutas(core, n, azar, destinos);
+    std::vector<uint32_t> ips = consultas(destinos, azar);
+    std::vector<std::string> textos;
+    for (uint32_t ip : ips)
+      textos.push_back(ip_a_texto(ip));
+
+    std::string parametro = std::to_string(n) + " rutas";
+    suite.correr("find_route", parametro, [&](uint64_t iteraciones) {
+      for (uint64_t i = 0; i < iteraciones; ++i)
+        bench::usar(core.find_route(ips[i & (MUESTRAS - 1)]));
+    });
+    suite.correr("find_route(texto)", parametro, [&](uint64_t iteraciones) {
+      for (uint64_t i = 0; i < iteraciones; ++i)
+        bench::usar(core.find_route(textos[i & (MUESTRAS - 1)]));
+    });
+  }
+}
+
+void bench_calcular_red(bench::Suite &suite, std::mt19937 &azar) {
+  std::uniform_int_distribution<uint32_t> ip;
+  std::uniform_int_distribution<int> largo(8, 30);
+  std::vector<std::pair<std::string, std::string>> entradas;
+  for (std::size_t i = 0; i < MUESTRAS; ++i)
+    entradas.emplace_back(ip_a_texto(ip(azar)),
+                          ip_a_texto(~(0xFFFFFFFFu >> largo(azar))));
+
+  RouterCore core;
+  suite.correr("calcular_red", "", [&](uint64_t iteraciones) {
+    for (uint64_t i = 0; i < iteraciones; ++i) {
+      const auto &e = entradas[i & (MUESTRAS - 1)];
+      bench::usar(core.calcular_red(e.first, e.second));
+    }
+  });
+}
+
+void bench_expandir_nombre(bench::Suite &suite) {
+  const std::vector<std::string> nombres = {
+      "g0/0",   "Gi0/1",    "GigabitEthernet0/2", "fa0/1", "f0/0.10",
+      "Lo0",    "loopback1", "Gig0/0/0",          "e0/3",  "Serial0/0"};
+  suite.correr("expandir_nombre_interfaz", "", [&](uint64_t iteraciones) {
+    for (uint64_t i = 0; i < iteraciones; ++i)
+      bench::usar(RouterCore::expandir_nombre_interfaz(
+          nombres[i % nombres.size()]));
+  });
+}
+
+// Líneas típicas de una sesión, abreviadas y completas, contra el árbol real
+// del modo privilegiado
+void bench_cli(bench::Suite &suite) {
+  RouterCore core;
+  core.init_default_state();
+  RouterCLI cli(core);
+  const ArbolComandos &arbol =
+      cli.obtener_arbol_de_modo(CliMode::PRIVILEGED_EXEC);
+  const std::vector<std::string> lineas = {
+      "show ip route",  "sh ip int br", "conf t", "ping 10.0.0.1 repeat 5",
+      "show running-config", "sh ver", "copy run start",
+      "show engine statistics"};
+
+  suite.correr("tokenize", "", [&](uint64_t iteraciones) {
+    for (uint64_t i = 0; i < iteraciones; ++i)
+      bench::usar(ArbolComandos::tokenize(lineas[i % lineas.size()]));
+  });
+
+  std::vector<std::vector<std::string>> tokens;
+  for (const auto &linea : lineas)
+    tokens.push_back(ArbolComandos::tokenize(linea));
+  suite.correr("detectar_comando", "", [&](uint64_t iteraciones) {
+    std::vector<const CommandNodo *> camino;
+    std::string error;
+    for (uint64_t i = 0; i < iteraciones; ++i) {
+      camino.clear();
+      bench::usar(
+          arbol.detectar_comando(tokens[i % tokens.size()], camino, error));
+    }
+  });
+}
+
+void bench_running_config(bench::Suite &suite) {
+  for (std::size_t n : {10, 1000}) {
+    RouterCore core;
+    for (std::size_t i = 0; i < n; ++i) {
+      InfoInterfaz &intf =
+          core.agregar_interfaz("GigabitEthernet0/" + std::to_string(i));
+      intf.ip = ip_a_texto(0x0A000001u + (static_cast<uint32_t>(i) << 8));
+      intf.netmask = "255.255.255.0";
+      intf.description = "Enlace " + std::to_string(i);
+      intf.up = true;
+      uint32_t red = static_cast<uint32_t>(i) << 8;
+      core.rutas_estaticas.push_back({ip_a_texto(0xAC100000u + red),
+                                      "255.255.255.0",
+                                      ip_a_texto(0x0A000002u + red)});
+    }
+
+    suite.correr("generar_running_config",
+                 std::to_string(n) + " intf+rutas", [&](uint64_t iteraciones) {
+                   for (uint64_t i = 0; i < iteraciones; ++i) {
+                     core.generar_running_config();
+                     bench::usar(core.running_config.texto);
+                   }
+                 });
+  }
+}
+
+// Codificación de la cabecera del cable y validación al recibir, más la copia
+// del datagrama completo como en un enlace por memoria compartida
+void bench_paquetes(bench::Suite &suite) {
+  SimulatedPacket pkt;
+  pkt.protocol = PROTO_DATOS;
+  pkt.src_ip = 0x0A000001;
+  pkt.dst_ip = 0x0A000102;
+
+  WireHeader hdr;
+  suite.correr("codificar_cabecera", "", [&](uint64_t iteraciones) {
+    for (uint64_t i = 0; i < iteraciones; ++i) {
+      pkt.dst_ip = static_cast<uint32_t>(i);
+      codificar_cabecera(pkt, hdr);
+      bench::usar(hdr);
+    }
+  });
+
+  codificar_cabecera(pkt, hdr);
+  SimulatedPacket recibido;
+  suite.correr("decodificar_cabecera", "", [&](uint64_t iteraciones) {
+    for (uint64_t i = 0; i < iteraciones; ++i) {
+      bench::usar(decodificar_cabecera(hdr, pkt.wire_size(), recibido));
+      bench::usar(recibido);
+    }
+  });
+
+  for (std::size_t bytes : {64, 1024}) {
+    pkt.payload_len = static_cast<uint16_t>(bytes);
+    alignas(WireHeader) char datagrama[sizeof(WireHeader) + PACKET_MAX_PAYLOAD];
+    suite.correr("paquete_ida_y_vuelta", std::to_string(bytes) + " B",
+                 [&](uint64_t iteraciones) {
+                   for (uint64_t i = 0; i < iteraciones; ++i) {
+                     WireHeader &salida =
+                         *reinterpret_cast<WireHeader *>(datagrama);
+                     codificar_cabecera(pkt, salida);
+                     std::memcpy(datagrama + sizeof(WireHeader), pkt.payload,
+                                 pkt.payload_len);
+                     bench::usar(datagrama);
+
+                     WireHeader entrada;
+                     std::memcpy(&entrada, datagrama, sizeof(entrada));
+                     std::memcpy(recibido.payload,
+                                 datagrama + sizeof(WireHeader), bytes);
+                     bench::usar(decodificar_cabecera(
+                         entrada, sizeof(WireHeader) + bytes, recibido));
+                     bench::usar(recibido);
+                   }
+                 });
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string json, filtro;
+  for (int i = 1; i < argc; ++i) {
+    std::string opcion = argv[i];
+    if (opcion == "--json" && i + 1 < argc) {
+      json = argv[++i];
+    } else if (opcion == "--filter" && i + 1 < argc) {
+      filtro = argv[++i];
+    } else {
+      std::cerr << "Uso: " << argv[0] << " [--json ARCHIVO] [--filter TEXTO]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::mt19937 azar(12345); // Semilla fija: mismas tablas en cada corrida
+  bench::Suite suite(filtro);
+  bench_find_route(suite, azar);
+  bench_calcular_red(suite, azar);
+  bench_expandir_nombre(suite);
+  bench_cli(suite);
+  bench_running_config(suite);
+  bench_paquetes(suite);
+
+  if (!json.empty()) {
+    if (!suite.guardar_json(json, RouterCore().version)) {
+      std::cerr << "No se pudo escribir " << json << std::endl;
+      return 1;
+    }
+    std::cout << "Resultados en " << json << std::endl;
+  }
+  return 0;
+}
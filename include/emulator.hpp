@@ -0,0 +1,75 @@
+#pragma once
+
+#include "mem_link.hpp"
+#include "network_engine.hpp"
+#include "router_cli.hpp"
+#include "router_core.hpp"
+#include "timer_wheel.hpp"
+#include "topology.hpp"
+#include "worker_pool.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct OpcionesEmulador {
+  std::string topologia;
+  std::size_t workers = 0;   // 0: un worker por núcleo
+  std::size_t pool_size = 0; // 0: según la cantidad de routers
+  bool huge_pages = false;
+};
+
+/**
+ * Emulación de una red completa en un solo proceso. Cada router del archivo
+ * de topología es un RouterCore con su NetworkEngine, y cada par de extremos
+ * de la topología (puertos UDP cruzados, o el mismo nombre en 'shm'/'mem') se
+ * convierte en un enlace en memoria. Ningún router tiene hilos propios: un
+ * MemScheduler con unos pocos workers atiende a los que tienen paquetes
+ * pendientes, los temporizadores de los protocolos de todos los routers
+ * comparten una TimerWheel, y todos comparten un pool de buffers. La consola del emulador
+ * permite conectarse a la CLI de cualquier router.
+ */
+class Emulador {
+public:
+  static constexpr std::size_t BUFFERS_POR_ROUTER = 64;
+
+  explicit Emulador(const OpcionesEmulador &opciones);
+  ~Emulador();
+  Emulador(const Emulador &) = delete;
+  Emulador &operator=(const Emulador &) = delete;
+
+  // Crear los routers y los enlaces de la topología
+  bool cargar();
+
+  // Arrancar los workers y atender la consola hasta 'quit' o fin de entrada
+  void run();
+
+  // Ejecutar una línea de la consola. Devuelve false para salir.
+  bool ejecutar(const std::string &linea);
+
+  std::size_t routers() const { return nodos_.size(); }
+
+private:
+  struct Nodo {
+    std::unique_ptr<NetworkEngine> net;
+    std::unique_ptr<RouterCore> core;
+    std::unique_ptr<RouterCLI> cli; // Se crea al conectarse por primera vez
+  };
+
+  Nodo *buscar(const std::string &nombre);
+  RouterCLI &consola(Nodo &nodo);
+  void listar(const std::string &filtro);
+  void estadisticas();
+  std::string prompt() const;
+
+  OpcionesEmulador opciones_;
+  std::shared_ptr<PacketPool> pool_;
+  std::unique_ptr<MemScheduler> planificador_;
+  TimerWheel temporizadores_; // Una sola rueda para todos los routers
+  WorkerPool calculo_;        // Y un solo pool para el SPF de sus áreas
+  std::vector<std::unique_ptr<Nodo>> nodos_; // En el orden de la topología
+  std::unordered_map<std::string, std::size_t> por_nombre_;
+  std::size_t enlaces_ = 0;
+  Nodo *conectado_ = nullptr; // Router cuya CLI recibe las líneas
+};
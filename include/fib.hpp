@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Máscara de red para una longitud de prefijo (0..32)
+inline uint32_t mascara_de_prefijo(uint8_t largo) {
+  return largo == 0 ? 0u : ~0u << (32 - largo);
+}
+
+// Longitud de prefijo de una máscara (cuenta los unos iniciales)
+uint8_t prefijo_de_mascara(uint32_t mascara);
+
+// Unos seguidos de ceros, sin huecos (255.0.255.0 no lo es)
+inline bool mascara_contigua(uint32_t mascara) {
+  return mascara == mascara_de_prefijo(prefijo_de_mascara(mascara));
+}
+
+/**
+ * Forwarding Information Base: trie binario con compresión de caminos.
+ * Cada nodo guarda un prefijo completo, por lo que las cadenas de nodos con
+ * un solo hijo desaparecen. La búsqueda es Longest Prefix Match real, no
+ * reserva memoria y recorre a lo más un nodo por bit del prefijo (O(32)).
+ * El valor asociado a cada prefijo es un índice opaco (p. ej. la posición de
+ * la ruta en la RIB).
+ */
+class FibTrie {
+public:
+  static constexpr uint32_t SIN_VALOR = UINT32_MAX;
+
+  FibTrie();
+
+  // Vaciar el trie dejando sólo la raíz 0.0.0.0/0 sin valor
+  void limpiar();
+
+  // Insertar o reemplazar el valor de red/largo
+  void insertar(uint32_t red, uint8_t largo, uint32_t valor);
+
+  // Valor del prefijo más largo que contiene a 'ip' (SIN_VALOR si no hay)
+  uint32_t buscar(uint32_t ip) const;
+
+  // Valor asociado exactamente a red/largo (SIN_VALOR si no existe)
+  uint32_t buscar_exacto(uint32_t red, uint8_t largo) const;
+
+  std::size_t cantidad_nodos() const { return nodos_.size(); }
+
+private:
+  static constexpr uint32_t NULO = UINT32_MAX;
+
+  struct Nodo {
+    uint32_t prefijo;  // Bits significativos del prefijo (resto en cero)
+    uint8_t largo;     // Longitud del prefijo
+    uint32_t hijo[2];  // Índices en nodos_ (NULO si no hay hijo)
+    uint32_t valor;    // SIN_VALOR en nodos internos sin ruta
+  };
+
+  std::vector<Nodo> nodos_; // nodos_[0] es la raíz 0.0.0.0/0
+
+  uint32_t nuevo_nodo(uint32_t prefijo, uint8_t largo, uint32_t valor);
+};
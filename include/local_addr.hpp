@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Direcciones IPv4 propias del router (primarias, secundarias y Loopbacks de
+ * las interfaces activas). Tabla hash de direccionamiento abierto con sondeo
+ * lineal y a lo más la mitad de las posiciones ocupadas: decidir si un paquete
+ * es para el router cuesta un hash y, casi siempre, una sola lectura, sin
+ * importar cuántas direcciones tenga. 0.0.0.0 marca una posición vacía (nunca
+ * es una dirección local).
+ */
+class TablaLocal {
+public:
+  // Reconstruir la tabla con estas direcciones (se ignoran 0 y repetidas)
+  void construir(const std::vector<uint32_t> &direcciones) {
+    std::size_t capacidad =
+        std::bit_ceil(std::max<std::size_t>(16, direcciones.size() * 2));
+    slots_.assign(capacidad, 0);
+    bits_ = std::countr_zero(capacidad);
+    mascara_ = static_cast<uint32_t>(capacidad - 1);
+    cantidad_ = 0;
+    for (uint32_t ip : direcciones) {
+      if (ip == 0)
+        continue;
+      uint32_t i = posicion(ip);
+      while (slots_[i] != 0 && slots_[i] != ip)
+        i = (i + 1) & mascara_;
+      if (slots_[i] == 0) {
+        slots_[i] = ip;
+        cantidad_++;
+      }
+    }
+  }
+
+  bool contiene(uint32_t ip) const {
+    if (ip == 0 || slots_.empty())
+      return false;
+    for (uint32_t i = posicion(ip);; i = (i + 1) & mascara_) {
+      if (slots_[i] == ip)
+        return true;
+      if (slots_[i] == 0)
+        return false;
+    }
+  }
+
+  std::size_t size() const { return cantidad_; }
+
+private:
+  // Hash de Fibonacci: los bits altos del producto quedan bien repartidos
+  // aunque las direcciones sean consecutivas
+  uint32_t posicion(uint32_t ip) const {
+    return static_cast<uint32_t>((ip * 0x9E3779B1u) >> (32 - bits_));
+  }
+
+  std::vector<uint32_t> slots_;
+  int bits_ = 0;
+  uint32_t mascara_ = 0;
+  std::size_t cantidad_ = 0;
+};
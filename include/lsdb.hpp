@@ -0,0 +1,164 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Constantes de arquitectura (RFC 2328, apéndice B), en segundos
+constexpr uint16_t LSA_MAX_AGE = 3600;
+constexpr uint16_t LSA_REFRESH_TIME = 1800;
+constexpr uint16_t LSA_MAX_AGE_DIFF = 900;
+constexpr uint16_t LSA_MIN_LS_INTERVAL = 5;
+constexpr uint16_t LSA_INF_TRANS_DELAY = 1;
+constexpr int32_t LSA_SEQ_INICIAL = INT32_MIN + 1; // 0x80000001
+constexpr int32_t LSA_SEQ_MAXIMA = INT32_MAX;
+
+constexpr std::size_t LSA_CABECERA = 20;
+constexpr uint8_t LSA_ROUTER = 1;
+constexpr uint8_t LSA_SUMMARY_RED = 3;
+constexpr uint32_t LSA_INFINITO = 0xFFFFFF; // Métrica de 24 bits: inalcanzable
+
+// Tipos de enlace de un router-LSA
+constexpr uint8_t ENLACE_P2P = 1;
+constexpr uint8_t ENLACE_STUB = 3;
+
+// Bits del router-LSA
+constexpr uint8_t ROUTER_BIT_B = 0x01; // Router de borde de área (ABR)
+
+// Campos de los paquetes y LSAs, en orden de red
+inline void poner16(char *p, uint16_t v) {
+  v = htons(v);
+  std::memcpy(p, &v, 2);
+}
+
+inline void poner32(char *p, uint32_t v) {
+  v = htonl(v);
+  std::memcpy(p, &v, 4);
+}
+
+inline uint16_t leer16(const char *p) {
+  uint16_t v;
+  std::memcpy(&v, p, 2);
+  return ntohs(v);
+}
+
+inline uint32_t leer32(const char *p) {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return ntohl(v);
+}
+
+// Identidad de un LSA: distintas instancias comparten la clave
+struct ClaveLSA {
+  uint8_t tipo = 0;
+  uint32_t id = 0;
+  uint32_t anunciante = 0;
+
+  bool operator==(const ClaveLSA &) const = default;
+};
+
+struct HashClaveLSA {
+  std::size_t operator()(const ClaveLSA &c) const {
+    uint64_t h = (uint64_t(c.anunciante) << 32 | c.id) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h ^ (h >> 29) ^ c.tipo);
+  }
+};
+
+// Cabecera de LSA (RFC 2328, A.4.1) en orden del host
+struct CabeceraLSA {
+  uint16_t edad = 0;
+  uint8_t opciones = 0;
+  uint8_t tipo = 0;
+  uint32_t id = 0;
+  uint32_t anunciante = 0;
+  int32_t seq = 0;
+  uint16_t checksum = 0;
+  uint16_t largo = 0;
+
+  ClaveLSA clave() const { return {tipo, id, anunciante}; }
+  void leer(const char *p);
+  void escribir(char *p) const;
+};
+
+// >0 si 'a' es una instancia más nueva que 'b', <0 si es más vieja, 0 si
+// son la misma (RFC 2328, 13.1)
+int comparar_instancias(const CabeceraLSA &a, const CabeceraLSA &b);
+
+// Checksum de Fletcher del LSA completo salvo la edad (RFC 2328, 12.1.7).
+// poner_checksum lo calcula y lo escribe en la cabecera.
+uint16_t poner_checksum(char *lsa, std::size_t largo);
+bool checksum_valido(const char *lsa, std::size_t largo);
+
+struct EnlaceRouter {
+  uint32_t id = 0;    // Router vecino (P2P) o red (stub)
+  uint32_t datos = 0; // IP de la interfaz (P2P) o máscara (stub)
+  uint8_t tipo = 0;
+  uint16_t metrica = 0;
+
+  bool operator==(const EnlaceRouter &) const = default;
+};
+
+// Armar un router-LSA con su checksum. La cabecera aporta id, anunciante,
+// secuencia y opciones; el largo y el checksum se calculan.
+std::vector<char> armar_router_lsa(CabeceraLSA cabecera,
+                                   const std::vector<EnlaceRouter> &enlaces,
+                                   uint8_t bits = 0);
+bool leer_router_lsa(const char *lsa, std::size_t largo,
+                     std::vector<EnlaceRouter> &enlaces);
+
+// Summary-LSA de red (tipo 3): el id es la red y el cuerpo, la máscara y la
+// métrica hasta ella desde el ABR que lo origina
+std::vector<char> armar_summary_lsa(CabeceraLSA cabecera, uint32_t mascara,
+                                    uint32_t metrica);
+bool leer_summary_lsa(const char *lsa, std::size_t largo, uint32_t &mascara,
+                      uint32_t &metrica);
+
+// Una instancia instalada en la base de datos. La edad se guarda al
+// instalarla y avanza con el reloj, sin tocar el LSA.
+struct LSA {
+  CabeceraLSA cabecera;
+  std::vector<char> datos; // LSA completo, cabecera incluida
+  std::chrono::steady_clock::time_point instalado;
+
+  uint16_t edad(std::chrono::steady_clock::time_point ahora) const;
+  bool max_age(std::chrono::steady_clock::time_point ahora) const {
+    return edad(ahora) >= LSA_MAX_AGE;
+  }
+  // Cabecera con la edad actual, para DD, LSAck y reenvíos
+  CabeceraLSA cabecera_actual(std::chrono::steady_clock::time_point ahora) const;
+};
+
+/**
+ * Base de datos de estado de enlace de un área: una instancia por clave, la
+ * más nueva que se haya recibido u originado. Sólo guarda; la inundación y el
+ * cálculo de rutas viven en ProcesoOSPF y CalculoSPF.
+ */
+class LSDB {
+public:
+  using Visitor = std::function<void(const LSA &)>;
+
+  const LSA *buscar(const ClaveLSA &clave) const;
+
+  // Reemplazar la instancia de la clave; 'datos' trae la cabecera. Devuelve
+  // true si el contenido cambió respecto de la anterior (sin contar edad,
+  // secuencia ni checksum), que es lo que obliga a recalcular las rutas.
+  bool instalar(std::vector<char> datos,
+                std::chrono::steady_clock::time_point ahora);
+  void quitar(const ClaveLSA &clave);
+  // Dejar en MaxAge los LSAs cuya edad llegó al máximo desde que se
+  // instalaron y devolver sus claves (los que ya llegaron así no cuentan)
+  std::vector<ClaveLSA> vencer(std::chrono::steady_clock::time_point ahora);
+  void limpiar() { lsas_.clear(); }
+
+  void para_cada(const Visitor &visit) const;
+  std::size_t size() const { return lsas_.size(); }
+  uint32_t suma_checksums() const;
+
+private:
+  std::unordered_map<ClaveLSA, LSA, HashClaveLSA> lsas_;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "packet_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class NetworkEngine;
+struct InterfaceLink;
+
+/**
+ * Bandeja de entrada de un motor con enlaces en memoria (emulación de muchos
+ * routers en un solo proceso). Los emisores dejan aquí los descriptores de
+ * paquete, sin copiar los datos, y si el motor no estaba programado lo ponen
+ * en la fila del MemScheduler. Un motor programado no vuelve a entrar a la
+ * fila hasta que un worker vacía su bandeja, así que nunca lo atienden dos
+ * workers a la vez y los paquetes de cada enlace se procesan en orden.
+ */
+struct MemInbox {
+  static constexpr std::size_t CAPACITY = 4096; // Como la cola de una NIC
+
+  struct Entry {
+    InterfaceLink *link; // Enlace del motor receptor por el que llegó
+    PacketRef packet;
+  };
+
+  std::mutex mutex;
+  std::vector<Entry> entries;
+  bool scheduled = false; // En la fila del planificador o siendo atendido
+};
+
+/**
+ * Grupo de workers compartido por todos los motores con enlaces en memoria.
+ * Cada worker toma el siguiente motor con paquetes pendientes, entrega su
+ * bandeja al core en ráfagas y, si mientras tanto llegaron más, lo devuelve
+ * al final de la fila para que un router cargado no acapare al worker.
+ */
+class MemScheduler {
+public:
+  explicit MemScheduler(std::size_t workers);
+  ~MemScheduler();
+  MemScheduler(const MemScheduler &) = delete;
+  MemScheduler &operator=(const MemScheduler &) = delete;
+
+  void start();
+  void stop(); // Lo pendiente queda en las bandejas
+
+  // Poner un motor en la fila (lo llama el motor al pasar a programado)
+  void schedule(NetworkEngine *engine);
+
+  std::size_t workers() const { return workers_; }
+  uint64_t runs() const { return runs_.load(std::memory_order_relaxed); }
+  std::size_t ready() const;
+
+private:
+  void worker_loop();
+
+  std::size_t workers_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<NetworkEngine *> ready_;
+  bool running_ = false;
+  std::vector<std::thread> threads_;
+  std::atomic<uint64_t> runs_{0}; // Veces que un worker atendió un motor
+};
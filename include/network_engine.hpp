@@ -1,24 +1,102 @@
 #pragma once
 
+#include "mem_link.hpp"
 #include "packet.hpp"
+#include "packet_pool.hpp"
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include <memory>
 #include <netinet/in.h>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+class ShmLink;
+
 /**
  * Representa un enlace físico simulado unido a una interfaz
  */
 struct InterfaceLink {
   std::string interface_name;
+  int ifindex = -1;              // ifindex de la interfaz del router (-1: sin asociar)
   int local_port;
   std::string remote_ip;
   int remote_port;
-  int socket_fd;
+  int socket_fd;                 // Cola 0; también se usa para transmitir
   struct sockaddr_in remote_addr;
+  std::size_t rx_queues = 1;     // Sockets SO_REUSEPORT en el mismo puerto
+  std::vector<int> queue_fds;    // Colas 1..rx_queues-1
+  std::shared_ptr<ShmLink> shm;  // Enlace por memoria compartida (sin socket)
+  bool memory = false;           // Enlace en memoria dentro del proceso
+  NetworkEngine *peer = nullptr; // Motor del otro extremo (enlace en memoria)
+  InterfaceLink *peer_link = nullptr;
+};
+
+/**
+ * Contadores del motor de red. Se actualizan desde los hilos de recepción.
+ */
+struct EngineStats {
+  std::atomic<uint64_t> rx_packets{0};
+  std::atomic<uint64_t> rx_bursts{0};   // Ráfagas entregadas al core
+  std::atomic<uint64_t> rx_syscalls{0}; // Llamadas al sistema de recepción
+  std::atomic<uint64_t> rx_invalid{0};  // Datagramas descartados por formato
+  std::atomic<uint64_t> rx_no_buffer{0}; // Descartados por pool agotado
+  std::atomic<uint64_t> tx_packets{0};
+  std::atomic<uint64_t> tx_errors{0};
+  std::atomic<uint64_t> tx_syscalls{0}; // Llamadas al sistema de envío
+};
+
+/**
+ * Modelo de hilos para la recepción
+ */
+enum class RxMode {
+  THREAD_PER_LINK, // Un hilo bloqueado en recvmmsg por cada interfaz
+  REACTOR          // Pocos hilos multiplexan todos los sockets (epoll/poll)
+};
+
+/**
+ * Mecanismo de E/S de los sockets
+ */
+enum class IoBackend {
+  SOCKETS, // recvmmsg/sendmmsg (o recvmsg/sendmsg)
+  URING    // io_uring: recepción multishot con buffers provistos y envíos por lote
+};
+
+struct RxBatch;
+struct UringRx;
+class NetworkEngine;
+
+/**
+ * Lote de transmisión del hilo que lo crea. Mientras existe, los paquetes
+ * enviados con NetworkEngine::queue_packet() desde ese hilo se acumulan por
+ * interfaz y flush() los envía con una sola llamada por interfaz (sendmmsg en
+ * Linux). El destructor envía lo pendiente.
+ */
+class TxBatch {
+public:
+  explicit TxBatch(NetworkEngine &engine);
+  ~TxBatch();
+  TxBatch(const TxBatch &) = delete;
+  TxBatch &operator=(const TxBatch &) = delete;
+
+  // Enviar todo lo acumulado. Devuelve los paquetes enviados.
+  std::size_t flush();
+  std::size_t pending() const { return pending_; }
+
+private:
+  friend class NetworkEngine;
+  struct PerLink {
+    InterfaceLink *link;
+    std::vector<PacketRef> packets;
+  };
+
+  NetworkEngine &engine_;
+  TxBatch *previous_; // Lote que estaba activo en el hilo (se puede anidar)
+  std::vector<PerLink> links_;
+  std::size_t pending_ = 0;
 };
 
 /**
@@ -27,10 +105,23 @@ struct InterfaceLink {
  */
 class NetworkEngine {
 public:
-  using PacketCallback = std::function<void(const std::string &interface_name,
-                                            const SimulatedPacket &)>;
+  using PacketCallback =
+      std::function<void(int ifindex, const SimulatedPacket &)>;
+  // Entrega de una ráfaga completa de paquetes recibidos en una interfaz.
+  // El receptor puede conservar (copiar o mover) cualquier descriptor; los
+  // buffers que no conserve se reutilizan en la siguiente ráfaga.
+  using BurstCallback =
+      std::function<void(int ifindex, PacketRef *packets, std::size_t count)>;
+
+  static constexpr std::size_t DEFAULT_RX_BURST = 32;
+  static constexpr std::size_t MAX_RX_BURST = 1024;
+  static constexpr std::size_t MAX_RX_QUEUES = 64;
+  static constexpr std::size_t MAX_TX_BURST = 64;
+  static constexpr unsigned URING_BUFFERS = 1024; // Buffers de recepción
 
-  NetworkEngine(const std::string &router_name);
+  // Sin pool se crea uno propio de DEFAULT_CAPACITY buffers
+  explicit NetworkEngine(const std::string &router_name,
+                         std::shared_ptr<PacketPool> pool = nullptr);
   ~NetworkEngine();
 
   // Cargar topología desde un archivo de texto plano
@@ -39,23 +130,159 @@ public:
   // Iniciar hilos de recepción
   void start();
 
-  // Detener motor
+  // Detener los hilos de recepción (los sockets siguen abiertos y start()
+  // puede volver a llamarse)
   void stop();
 
+  // Asociar el enlace de una interfaz (por nombre, tal como aparece en la
+  // topología) al ifindex que le asignó el router. Los envíos y las ráfagas
+  // recibidas usan sólo el ifindex. Se llama antes de start().
+  bool bind_ifindex(const std::string &interface_name, int ifindex);
+
+  // Interfaces con enlace, en el orden de la topología
+  std::vector<std::string> interface_names() const;
+
+  // Enlaces en memoria (varios routers en un proceso, ver Emulador). Los
+  // paquetes pasan como descriptores a la bandeja del otro motor y los
+  // procesa un worker del planificador; no hay sockets ni hilos de recepción.
+  bool add_memory_link(const std::string &interface_name);
+  static bool connect_memory_links(NetworkEngine &a, const std::string &if_a,
+                                   NetworkEngine &b, const std::string &if_b);
+  void set_scheduler(MemScheduler *scheduler) { scheduler_ = scheduler; }
+  MemScheduler *scheduler() const { return scheduler_; }
+
+  // Worker del planificador: entregar lo que hay en la bandeja. Devuelve true
+  // si llegaron más paquetes mientras tanto (el motor sigue programado).
+  bool process_inbox();
+
   // Enviar paquete por una interfaz específica
-  bool send_packet(const std::string &interface_name,
-                   const SimulatedPacket &packet);
+  bool send_packet(int ifindex, const SimulatedPacket &packet);
+
+  // Enviar un paquete del pool. Si el hilo tiene un TxBatch de este motor se
+  // encola hasta el próximo flush(); si no, se envía de inmediato.
+  bool queue_packet(int ifindex, PacketRef packet);
 
   // Definir qué hacer cuando llega un paquete
   void set_on_receive(PacketCallback callback);
 
+  // Definir qué hacer con cada ráfaga (tiene prioridad sobre set_on_receive)
+  void set_on_receive_burst(BurstCallback callback);
+
+  // Máximo de datagramas por llamada de recepción (antes de start())
+  void set_rx_burst(std::size_t burst);
+  std::size_t rx_burst() const { return rx_burst_; }
+
+  // Seleccionar el modelo de recepción (antes de start())
+  void set_rx_mode(RxMode mode, std::size_t reactor_threads = 1);
+  RxMode rx_mode() const { return rx_mode_; }
+
+  // Seleccionar el backend de E/S (antes de start()). Si io_uring no está
+  // disponible start() vuelve a SOCKETS.
+  void set_backend(IoBackend backend) { backend_ = backend; }
+  IoBackend backend() const { return backend_; }
+
+  // Repartir la recepción de una interfaz entre K sockets SO_REUSEPORT, cada
+  // uno con su propio hilo fijado a un núcleo. Los paquetes de un mismo par
+  // origen/destino caen siempre en la misma cola, lo que conserva su orden.
+  // Si el motor está corriendo se reinicia la recepción.
+  bool set_rx_queues(const std::string &interface_name, std::size_t queues);
+  std::size_t rx_queues(const std::string &interface_name) const;
+  std::size_t reactor_threads() const { return reactor_threads_; }
+
+  const EngineStats &stats() const { return stats_; }
+
+  // Pool de buffers de donde salen los paquetes recibidos. Puede compartirse
+  // entre motores; sólo se cambia con el motor detenido.
+  PacketPool &pool() { return *pool_; }
+  void set_packet_pool(std::shared_ptr<PacketPool> pool);
+
 private:
+  friend class TxBatch;
+
+  // Estado de un hilo reactor: su descriptor de multiplexación, el descriptor
+  // para despertarlo y los enlaces que atiende
+  struct Reactor {
+    int poll_fd = -1; // epoll (Linux); sin uso con poll()
+    int wake_fd[2] = {-1, -1}; // eventfd en wake_fd[0] (Linux) o pipe
+    std::vector<InterfaceLink *> links;
+  };
+
   std::string router_name_;
-  std::map<std::string, InterfaceLink> links_;
+  std::vector<InterfaceLink> links_; // En el orden de la topología
+  std::vector<int> by_ifindex_;      // ifindex -> posición en links_ (-1: sin enlace)
+  std::unordered_map<std::string, std::size_t> by_name_; // Nombre -> posición en links_
   std::vector<std::thread> rx_threads_;
   std::atomic<bool> running_{false};
   PacketCallback on_receive_;
+  BurstCallback on_receive_burst_;
+  std::size_t rx_burst_ = DEFAULT_RX_BURST;
+  RxMode rx_mode_ = RxMode::THREAD_PER_LINK;
+  std::size_t reactor_threads_ = 1;
+  std::vector<Reactor> reactors_;
+  std::shared_ptr<PacketPool> pool_;
+  IoBackend backend_ = IoBackend::SOCKETS;
+  std::unique_ptr<UringRx> uring_rx_;
+  int queue_wake_[2] = {-1, -1}; // Pipe para detener los hilos de las colas
+  EngineStats stats_;
+  MemScheduler *scheduler_ = nullptr;
+  MemInbox inbox_; // Después de pool_: se destruye antes que el pool
+  std::vector<MemInbox::Entry> inbox_work_; // Sólo la usa el worker de turno
+  std::vector<PacketRef> inbox_burst_;
+
+  // links_ sólo crece en load_topology(), antes de que los hilos guarden
+  // punteros a sus elementos
+  void add_link(InterfaceLink link);
+  InterfaceLink *link(int ifindex);
+  InterfaceLink *find_link(const std::string &interface_name);
 
   // Bucle de recepción para cada interfaz
   void rx_loop(InterfaceLink &link);
+
+  // Bucle de recepción de un enlace por memoria compartida
+  void shm_loop(InterfaceLink &link);
+
+  // Bucle del hilo dedicado a una cola de una interfaz con varias colas
+  void queue_loop(InterfaceLink &link, int fd, unsigned cpu);
+
+  // Crear y enlazar un socket UDP al puerto local
+  static int open_socket(int local_port, bool reuse_port);
+  bool open_queues(InterfaceLink &link);
+  void close_queues(InterfaceLink &link);
+
+  // Bucle de un hilo reactor
+  void reactor_loop(Reactor &reactor);
+  bool setup_reactors();
+  void wake_reactors();
+  void close_reactors();
+
+  // Leer una ráfaga del socket y entregarla. Devuelve los datagramas leídos,
+  // 0 si no había nada (modo no bloqueante) o -1 si el socket falló.
+  int receive_burst(InterfaceLink &link, int fd, RxBatch &batch, bool wait);
+
+  // Backend io_uring: un hilo recibe de todos los sockets
+  bool setup_uring();
+  void uring_loop();
+
+  // Enviar con io_uring desde el anillo propio del hilo; cada paquete con su
+  // enlace. Devuelve false si el hilo no pudo crear su anillo.
+  bool uring_send(InterfaceLink *const *links, const PacketRef *const *packets,
+                  std::size_t count, std::size_t &sent);
+
+  // Enviar paquetes por un enlace con el mínimo de llamadas al sistema.
+  // Devuelve cuántos salieron.
+  std::size_t send_burst(InterfaceLink &link, const PacketRef *packets,
+                         std::size_t count);
+
+  // Pasar paquetes a la bandeja del otro extremo de un enlace en memoria. Los
+  // descriptores se mueven: el receptor suele quedar como único dueño y puede
+  // modificar el paquete sin copiarlo.
+  std::size_t send_memory(InterfaceLink &link, PacketRef *packets,
+                          std::size_t count);
+  std::size_t enqueue_inbox(InterfaceLink &link, PacketRef *packets,
+                            std::size_t count);
+
+  static thread_local TxBatch *tx_batch_; // Lote activo del hilo
+
+  // Entregar los paquetes válidos de una ráfaga al core
+  void deliver_burst(int ifindex, PacketRef *packets, std::size_t count);
 };
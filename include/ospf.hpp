@@ -0,0 +1,350 @@
+#pragma once
+
+#include "lsdb.hpp"
+#include "packet.hpp"
+#include "spf.hpp"
+#include "timer_wheel.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class RouterCore;
+
+// Direcciones de grupo de OSPF (orden del host)
+constexpr uint32_t OSPF_ALL_SPF_ROUTERS = 0xE0000005; // 224.0.0.5
+constexpr uint32_t OSPF_ALL_D_ROUTERS = 0xE0000006;   // 224.0.0.6
+
+constexpr uint16_t OSPF_HELLO_DEFAULT = 10; // Segundos
+constexpr uint16_t OSPF_RXMT_DEFAULT = 5;
+
+// Estados de un vecino (RFC 2328, 10.1)
+enum class EstadoVecino {
+  DOWN,
+  ATTEMPT,
+  INIT,
+  TWO_WAY,
+  EXSTART,
+  EXCHANGE,
+  LOADING,
+  FULL
+};
+const char *nombre_estado(EstadoVecino estado);
+
+// Interfaz habilitada por un 'network', tal como la calcula el core
+struct ConfigInterfazOSPF {
+  int ifindex = -1;
+  int enlace = -1; // ifindex del enlace por el que salen los paquetes
+  std::string nombre;
+  uint32_t ip = 0;
+  uint32_t mascara = 0;
+  uint32_t area = 0;
+  bool pasiva = false;   // Se anuncia pero no manda hellos
+  bool loopback = false; // Idem, y nunca tiene vecinos
+  uint16_t hello = OSPF_HELLO_DEFAULT;
+  uint32_t dead = 4 * OSPF_HELLO_DEFAULT;
+  uint16_t rxmt = OSPF_RXMT_DEFAULT;
+  uint16_t costo = 1;
+
+  bool operator==(const ConfigInterfazOSPF &) const = default;
+};
+
+// 'area X range': las redes del área dentro del rango se anuncian a las
+// demás como un solo summary-LSA
+struct RangoArea {
+  uint32_t area = 0;
+  uint32_t red = 0;
+  uint32_t mascara = 0;
+
+  bool operator==(const RangoArea &) const = default;
+};
+
+// Copias para la CLI
+struct InfoVecinoOSPF {
+  uint32_t router_id = 0;
+  uint32_t ip = 0;
+  EstadoVecino estado = EstadoVecino::DOWN;
+  uint8_t prioridad = 0;
+  int64_t muerto_en_ms = -1; // Lo que falta para el dead interval
+  std::string interfaz;
+};
+
+struct InfoInterfazOSPF {
+  ConfigInterfazOSPF config;
+  std::size_t vecinos = 0;
+  std::size_t adyacentes = 0;
+  int64_t hello_en_ms = -1; // Próximo hello (-1: no manda)
+};
+
+struct EstadisticasOSPF {
+  std::atomic<uint64_t> hello_tx{0};
+  std::atomic<uint64_t> hello_rx{0};
+  std::atomic<uint64_t> dd_tx{0};
+  std::atomic<uint64_t> dd_rx{0};
+  std::atomic<uint64_t> lsr_tx{0};
+  std::atomic<uint64_t> lsr_rx{0};
+  std::atomic<uint64_t> lsu_tx{0};
+  std::atomic<uint64_t> lsu_rx{0};
+  std::atomic<uint64_t> ack_tx{0};
+  std::atomic<uint64_t> ack_rx{0};
+  std::atomic<uint64_t> lsas_originados{0};
+  std::atomic<uint64_t> lsas_nuevos{0}; // Recibidos e instalados
+  std::atomic<uint64_t> retransmisiones{0};
+  std::atomic<uint64_t> duplicados{0}; // Instancias que ya teníamos
+  std::atomic<uint64_t> suprimidos{0}; // No se inundaron: el vecino ya las tenía
+  std::atomic<uint64_t> descartados{0}; // Mal formados o con parámetros que no coinciden
+  std::atomic<uint64_t> lsas_grandes{0}; // No caben en un LSU: ni se originan ni se envían
+  std::atomic<uint64_t> cambios_estado{0};
+};
+
+struct InfoLSA {
+  uint32_t area = 0;
+  CabeceraLSA cabecera; // Con la edad actual
+  std::size_t enlaces = 0; // Router-LSA
+  uint32_t mascara = 0;    // Summary-LSA
+  uint32_t metrica = 0;
+};
+
+// Contadores y últimas ejecuciones del SPF, para la CLI
+struct InfoSPF {
+  uint64_t completos = 0;
+  uint64_t incrementales = 0;
+  uint64_t parciales = 0;
+  uint64_t tiempo_total_us = 0;
+  uint64_t tiempo_maximo_us = 0;
+  std::size_t lsas = 0;       // En las bases de datos de todas las áreas
+  uint32_t suma_checksums = 0;
+  std::size_t alcanzados = 0; // Routers en los árboles
+  std::size_t rutas = 0;
+  std::size_t areas = 0;
+  bool abr = false;
+  std::vector<EjecucionSPF> ultimas; // La más reciente primero
+
+  ThrottleSPF throttle;
+  uint32_t espera_actual_ms = 0;
+  int64_t proximo_en_ms = -1; // SPF programado (-1: ninguno)
+  uint64_t disparos = 0;      // Cambios que pidieron un SPF
+  uint64_t ahorradas = 0;     // Los que se sumaron a uno ya programado
+};
+
+/**
+ * Proceso OSPF de un router: intercambio de hellos, máquina de estados de
+ * los vecinos, base de datos de estado de enlace con su inundación y cálculo
+ * de rutas (RFC 2328, secciones 9 a 16). Todos los enlaces del emulador son
+ * un par de extremos, así que las interfaces se tratan como punto a punto: no
+ * hay elección de DR, todo vecino en 2-WAY forma adyacencia y sólo existen
+ * router-LSAs y summary-LSAs de red.
+ *
+ * Cada área tiene su base de datos y su SPF; un cambio en un área sólo
+ * recalcula esa área. Con interfaces en más de un área el router es ABR: las
+ * rutas intra-área de cada una (agregadas según 'area range') y las
+ * inter-área aprendidas del backbone se anuncian a las demás como
+ * summary-LSAs (RFC 2328, 12.4.3). No hay virtual links.
+ *
+ * Los paquetes llegan desde los hilos de recepción (recibir) y los
+ * temporizadores corren en la TimerWheel compartida; la configuración la
+ * cambia la CLI. Todo eso se serializa con un mutex: el plano de control
+ * mueve pocos paquetes y así el estado de los vecinos no necesita más
+ * cuidado. Los callbacks de los temporizadores buscan al vecino por su clave
+ * y comparan el Id del temporizador, de modo que uno que venció justo cuando
+ * se lo reprogramaba no tiene efecto.
+ *
+ * La inundación no manda un LSU por LSA: los LSAs se encolan por interfaz y
+ * salen juntos, tantos por paquete como quepan, con un mínimo entre LSUs de
+ * la misma interfaz. Las retransmisiones siguen el mismo criterio.
+ *
+ * El SPF corre en el hilo de la rueda, con la espera de 'timers throttle
+ * spf': el primer cambio tras un período tranquilo espera 'inicial', y
+ * mientras sigan llegando cambios cada ejecución duplica la espera hasta
+ * 'maximo'. Todo lo que llega mientras hay un SPF programado se suma a él.
+ * Las áreas con cambios se calculan en paralelo en el WorkerPool del core.
+ * Las rutas se instalan en el core sin
+ * esperar a la CLI (RouterCore::instalar_rutas_ospf); si la CLI está en medio
+ * de un comando, se reintenta con un temporizador para no frenar la rueda,
+ * que en el emulador comparten todos los routers.
+ */
+class ProcesoOSPF {
+public:
+  ProcesoOSPF(RouterCore &core, TimerWheel &temporizadores);
+  ~ProcesoOSPF();
+  ProcesoOSPF(const ProcesoOSPF &) = delete;
+  ProcesoOSPF &operator=(const ProcesoOSPF &) = delete;
+
+  // Aplicar la configuración. Las interfaces que no cambiaron conservan sus
+  // vecinos; router_id 0 detiene el proceso.
+  void configurar(const std::string &proceso, uint32_t router_id,
+                  std::vector<ConfigInterfazOSPF> interfaces,
+                  const ThrottleSPF &throttle = {},
+                  std::vector<RangoArea> rangos = {});
+
+  // Hilo RX: paquete de protocolo 89 recibido por el enlace 'ifindex'
+  void recibir(int ifindex, const SimulatedPacket &pkt);
+
+  uint32_t router_id() const;
+  std::vector<InfoVecinoOSPF> vecinos() const;
+  std::vector<InfoInterfazOSPF> interfaces() const;
+  std::vector<InfoLSA> base_datos() const;
+  InfoSPF estadisticas_spf() const;
+  const EstadisticasOSPF &stats() const { return stats_; }
+
+private:
+  // LSA inundado al vecino y todavía sin confirmar
+  struct Retransmision {
+    CabeceraLSA cabecera;
+    std::chrono::steady_clock::time_point enviado;
+  };
+
+  struct Vecino {
+    uint32_t router_id = 0;
+    uint32_t ip = 0;
+    EstadoVecino estado = EstadoVecino::DOWN;
+    uint8_t prioridad = 0;
+    TimerWheel::Id inactividad = 0;
+    TimerWheel::Id retransmision = 0;
+
+    // Intercambio de la base de datos (Database Description)
+    bool maestro = false; // Este router es el maestro del intercambio
+    uint32_t dd_seq = 0;
+    bool mas_enviado = false; // Bit M del último DD enviado
+    bool hay_ultimo_dd = false;
+    uint8_t ultimo_flags = 0;   // Del último DD recibido, para duplicados
+    uint8_t ultimo_opciones = 0;
+    uint32_t ultimo_seq = 0;
+    std::vector<char> ultimo_dd; // Último DD enviado (para retransmitir)
+    std::vector<CabeceraLSA> resumen; // Lo que falta describir en los DD
+    std::size_t resumen_enviados = 0; // Cabeceras del último DD enviado
+
+    // Listas de pedidos y de retransmisión (RFC 2328, 10)
+    std::vector<CabeceraLSA> pedidos;
+    std::unordered_map<ClaveLSA, Retransmision, HashClaveLSA> retransmitir;
+    TimerWheel::Id retransmision_lsa = 0;
+    std::chrono::steady_clock::time_point lsr_enviado;
+  };
+
+  struct Interfaz {
+    ConfigInterfazOSPF config;
+    TimerWheel::Id hello = 0;
+    std::vector<Vecino> vecinos; // Punto a punto: normalmente uno
+
+    // LSAs por inundar; una instancia nueva reemplaza a la encolada
+    std::unordered_set<ClaveLSA, HashClaveLSA> por_inundar;
+    TimerWheel::Id inundacion = 0;
+    std::chrono::steady_clock::time_point ultima_lsu;
+  };
+
+  struct Area {
+    uint32_t id = 0;
+    LSDB lsdb;
+    CalculoSPF spf;
+  };
+
+  Interfaz *buscar_interfaz(int ifindex);
+  Interfaz *interfaz_de_paquete(int enlace, uint32_t origen);
+  static Vecino *buscar_vecino(Interfaz &intf, uint32_t router_id);
+  void reindexar();
+  Area &area_de(const Interfaz &intf) { return areas_.at(intf.config.area); }
+  bool es_abr() const { return areas_.size() > 1; }
+
+  // Interfaces
+  void levantar_interfaz(Interfaz &intf);
+  void bajar_interfaz(Interfaz &intf);
+  void programar_hello(Interfaz &intf, std::chrono::milliseconds espera);
+  void enviar(const Interfaz &intf, uint8_t tipo, const char *cuerpo,
+              std::size_t largo);
+  void enviar_hello(Interfaz &intf);
+  // Devuelve cuántos LSAs de 'lsas' salieron, como mucho en 'max_paquetes'
+  std::size_t enviar_lsu(const Interfaz &intf,
+                         const std::vector<const LSA *> &lsas,
+                         std::size_t max_paquetes = SIZE_MAX);
+  void enviar_ack(const Interfaz &intf,
+                  const std::vector<CabeceraLSA> &cabeceras);
+  void enviar_lsr(Interfaz &intf, Vecino &v);
+
+  // Máquina de estados del vecino
+  void recibir_hello(Interfaz &intf, uint32_t origen, uint32_t router_id,
+                     const char *cuerpo, std::size_t largo);
+  void recibir_dd(Interfaz &intf, Vecino &v, const char *cuerpo,
+                  std::size_t largo);
+  bool leer_resumen(Interfaz &intf, Vecino &v, const char *cabeceras,
+                    std::size_t largo);
+  void recibir_lsr(Interfaz &intf, Vecino &v, const char *cuerpo,
+                   std::size_t largo);
+  void recibir_lsu(Interfaz &intf, Vecino &v, const char *cuerpo,
+                   std::size_t largo);
+  void recibir_ack(Vecino &v, const char *cuerpo, std::size_t largo);
+  void comprobar_carga(Interfaz &intf, Vecino &v);
+  bool hay_intercambios() const;
+  void cambiar_estado(Interfaz &intf, Vecino &v, EstadoVecino nuevo,
+                      const char *motivo);
+  void iniciar_exstart(Interfaz &intf, Vecino &v);
+  void negociacion_hecha(Interfaz &intf, Vecino &v);
+  void intercambio_hecho(Interfaz &intf, Vecino &v);
+  void reiniciar_adyacencia(Interfaz &intf, Vecino &v, const char *motivo);
+  void quitar_vecino(Interfaz &intf, uint32_t router_id, const char *motivo);
+  void reiniciar_inactividad(Interfaz &intf, Vecino &v);
+  void enviar_dd(Interfaz &intf, Vecino &v, uint8_t flags);
+  void armar_retransmision(Interfaz &intf, Vecino &v);
+  void armar_retransmision_lsa(Interfaz &intf, Vecino &v,
+                               std::chrono::milliseconds espera);
+  void cancelar_temporizadores(Vecino &v);
+  static void vaciar_listas(Vecino &v);
+
+  // Base de datos e inundación (RFC 2328, 12 y 13)
+  bool instalar(Area &area, std::vector<char> datos);
+  void inundar(Area &area, const LSA &lsa, const Vecino *origen);
+  void encolar_inundacion(Interfaz &intf, const ClaveLSA &clave);
+  void vaciar_inundacion(Interfaz &intf);
+  void quitar_de_retransmision(const Area &area, const ClaveLSA &clave);
+  bool en_retransmision(const Area &area, const ClaveLSA &clave) const;
+  void programar_originacion();
+  bool originar(Area &area, std::vector<char> datos, bool forzar);
+  void retirar(Area &area, const ClaveLSA &clave);
+  void originar_router_lsa(Area &area, bool forzar);
+  void originar_resumenes();
+  void programar_refresco();
+  void refrescar();
+  void programar_envejecimiento();
+  void envejecer(Area &area);
+
+  // Cálculo de rutas
+  void programar_spf();
+  void ejecutar_spf();
+  std::vector<RutaOSPF> armar_tabla() const;
+  void instalar_rutas();
+  void programar_instalacion(std::chrono::milliseconds espera);
+  bool resolver_salto(uint32_t vecino, uint32_t datos, int &salida,
+                      uint32_t &via) const;
+
+  RouterCore &core_;
+  TimerWheel &temporizadores_;
+  mutable std::mutex mutex_;
+  bool detenido_ = false; // Destructor en curso: no programar más
+  std::string proceso_;   // Número de proceso, para los mensajes
+  uint32_t router_id_ = 0;
+  std::vector<Interfaz> interfaces_;
+  std::vector<int> por_ifindex_; // ifindex -> posición en interfaces_ (-1)
+  std::mt19937 aleatorio_;
+  EstadisticasOSPF stats_;
+
+  std::map<uint32_t, Area> areas_;
+  std::vector<RangoArea> rangos_;
+  std::vector<RutaOSPF> rutas_; // Tabla instalada en el core
+  bool rutas_pendientes_ = false; // Cambió algo que no ve el SPF de un área
+  InfoSPF info_spf_;
+  TimerWheel::Id originacion_ = 0;
+  TimerWheel::Id refresco_ = 0;
+  TimerWheel::Id envejecimiento_ = 0;
+  TimerWheel::Id spf_pendiente_ = 0;
+  TimerWheel::Id instalacion_ = 0;
+  std::chrono::steady_clock::time_point ultima_originacion_;
+  ThrottleSPF throttle_;
+  uint32_t espera_actual_ms_ = 0;
+  std::chrono::steady_clock::time_point ultimo_spf_;
+};
@@ -1,26 +1,138 @@
 #pragma once
 
+#include <arpa/inet.h>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <string>
+
+// Versión actual del formato binario en el cable
+constexpr uint8_t PACKET_VERSION = 2;
+constexpr std::size_t PACKET_MAX_PAYLOAD = 1024;
+
+// Protocolos transportados en el campo 'protocol'
+constexpr uint8_t PROTO_DATOS = 0;
+constexpr uint8_t PROTO_ICMP = 1;
+constexpr uint8_t PROTO_OSPF = 89;
+
+/**
+ * Cabecera tal como viaja por el enlace. Todos los campos multibyte van en
+ * orden de red (big endian) y las direcciones IPv4 como uint32_t.
+ * En el cable sólo se transmite la cabecera seguida de 'payload_len' bytes.
+ */
+struct WireHeader {
+  char magic[4];        // Identificador de protocolo "ROUT"
+  uint8_t version;      // PACKET_VERSION
+  uint8_t header_len;   // Bytes de cabecera (permite extenderla en el futuro)
+  uint8_t ttl;          // Time to Live
+  uint8_t protocol;     // 1 = ICMP (Ping), 89 = OSPF, 0 = Datos
+  uint16_t flags;       // Banderas reservadas
+  uint16_t payload_len; // Longitud de los datos que siguen a la cabecera
+  uint32_t src_ip;      // IP origen
+  uint32_t dst_ip;      // IP destino
+};
+static_assert(sizeof(WireHeader) == 20, "WireHeader debe medir 20 bytes");
 
 /**
  * Estructura que emula un paquete de Capa 3 (IP) simplificado.
  * Se usará para enviar datos entre procesos de router y hosts.
+ * En memoria los campos están en orden del host; la conversión al formato
+ * del cable se hace con codificar_cabecera() / decodificar_cabecera().
  */
 struct SimulatedPacket {
-  char header_id[4];    // Identificador de protocolo "ROUT"
   uint8_t version;      // Versión del protocolo simulado
   uint8_t ttl;          // Time to Live
   uint8_t protocol;     // 1 = ICMP (Ping), 89 = OSPF, 0 = Datos
-  char src_ip[16];      // IP origen en formato string "A.B.C.D"
-  char dst_ip[16];      // IP destino en formato string "A.B.C.D"
+  uint16_t flags;       // Banderas reservadas
   uint16_t payload_len; // Longitud de los datos
-  char payload[1024];   // Datos del paquete
+  uint32_t src_ip;      // IP origen (orden del host)
+  uint32_t dst_ip;      // IP destino (orden del host)
+  char payload[PACKET_MAX_PAYLOAD]; // Datos del paquete
 
   SimulatedPacket() {
     std::memset(this, 0, sizeof(SimulatedPacket));
-    std::memcpy(header_id, "ROUT", 4);
-    version = 1;
+    version = PACKET_VERSION;
     ttl = 64;
   }
+
+  // Bytes que ocupa el paquete en el cable
+  std::size_t wire_size() const { return sizeof(WireHeader) + payload_len; }
+};
+
+/**
+ * Payload de un ICMP Echo. Empieza con la marca en texto ("ECHO_REQUEST" o
+ * "ECHO_REPLY" rellenada con ceros), que es lo único que miraban las versiones
+ * anteriores, y sigue con identificador y secuencia en orden de red y la marca
+ * de tiempo del emisor, que sólo interpreta quien la envió. El resto del
+ * payload es relleno y la respuesta lo devuelve tal cual.
+ */
+constexpr std::size_t ICMP_MARCA = 12;
+struct CabeceraEcho {
+  char marca[ICMP_MARCA];
+  uint16_t id;
+  uint16_t seq;
+  uint64_t enviado_ns;
 };
+static_assert(sizeof(CabeceraEcho) == 24, "CabeceraEcho debe medir 24 bytes");
+
+inline bool icmp_es(const SimulatedPacket &pkt, const char *marca) {
+  std::size_t largo = std::strlen(marca);
+  return pkt.protocol == PROTO_ICMP && pkt.payload_len >= largo &&
+         std::memcmp(pkt.payload, marca, largo) == 0;
+}
+
+// Llenar la cabecera del cable a partir del paquete en memoria
+inline void codificar_cabecera(const SimulatedPacket &pkt, WireHeader &hdr) {
+  std::memcpy(hdr.magic, "ROUT", 4);
+  hdr.version = PACKET_VERSION;
+  hdr.header_len = sizeof(WireHeader);
+  hdr.ttl = pkt.ttl;
+  hdr.protocol = pkt.protocol;
+  hdr.flags = htons(pkt.flags);
+  hdr.payload_len = htons(pkt.payload_len);
+  hdr.src_ip = htonl(pkt.src_ip);
+  hdr.dst_ip = htonl(pkt.dst_ip);
+}
+
+// Validar la cabecera contra el tamaño real del datagrama y copiar sus campos
+// al paquete. El payload ya debe estar en pkt.payload (recepción con iovec).
+inline bool decodificar_cabecera(const WireHeader &hdr, std::size_t datagrama,
+                                 SimulatedPacket &pkt) {
+  if (datagrama < sizeof(WireHeader))
+    return false;
+  if (std::memcmp(hdr.magic, "ROUT", 4) != 0)
+    return false;
+  if (hdr.version != PACKET_VERSION || hdr.header_len != sizeof(WireHeader))
+    return false;
+
+  uint16_t len = ntohs(hdr.payload_len);
+  if (len > PACKET_MAX_PAYLOAD || sizeof(WireHeader) + len != datagrama)
+    return false;
+
+  pkt.version = hdr.version;
+  pkt.ttl = hdr.ttl;
+  pkt.protocol = hdr.protocol;
+  pkt.flags = ntohs(hdr.flags);
+  pkt.payload_len = len;
+  pkt.src_ip = ntohl(hdr.src_ip);
+  pkt.dst_ip = ntohl(hdr.dst_ip);
+  return true;
+}
+
+// Convertir "A.B.C.D" a uint32_t en orden del host
+inline bool ip_desde_texto(const std::string &texto, uint32_t &ip) {
+  in_addr addr;
+  if (inet_pton(AF_INET, texto.c_str(), &addr) != 1)
+    return false;
+  ip = ntohl(addr.s_addr);
+  return true;
+}
+
+// Convertir uint32_t (orden del host) a "A.B.C.D"
+inline std::string ip_a_texto(uint32_t ip) {
+  in_addr addr;
+  addr.s_addr = htonl(ip);
+  char buf[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+  return buf;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "packet.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+class PacketPool;
+
+/**
+ * Buffer de paquete dentro del pool. Alineado a línea de caché para que dos
+ * hilos que manejan paquetes distintos nunca compartan una línea.
+ */
+struct alignas(64) PacketBuffer {
+  std::atomic<uint32_t> refs{0};
+  uint32_t index = 0;
+  PacketPool *pool = nullptr;
+  SimulatedPacket pkt;
+};
+
+/**
+ * Descriptor ligero con conteo de referencias hacia un PacketBuffer.
+ * Copiarlo no copia el paquete: sólo incrementa el contador. Cuando la última
+ * referencia desaparece el buffer vuelve al pool.
+ */
+class PacketRef {
+public:
+  PacketRef() = default;
+  explicit PacketRef(PacketBuffer *buf) : buf_(buf) {} // Adopta una referencia
+  PacketRef(const PacketRef &otro) : buf_(otro.buf_) {
+    if (buf_)
+      buf_->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  PacketRef(PacketRef &&otro) noexcept : buf_(otro.buf_) { otro.buf_ = nullptr; }
+  PacketRef &operator=(PacketRef otro) noexcept {
+    std::swap(buf_, otro.buf_);
+    return *this;
+  }
+  ~PacketRef() { reset(); }
+
+  void reset();
+
+  SimulatedPacket *operator->() const { return &buf_->pkt; }
+  SimulatedPacket &operator*() const { return buf_->pkt; }
+  explicit operator bool() const { return buf_ != nullptr; }
+
+  // Sólo el único dueño puede modificar el paquete sin afectar a otros
+  bool unique() const {
+    return buf_ && buf_->refs.load(std::memory_order_acquire) == 1;
+  }
+
+private:
+  PacketBuffer *buf_ = nullptr;
+};
+
+/**
+ * Contadores del pool
+ */
+struct PoolStats {
+  std::atomic<uint64_t> allocs{0};
+  std::atomic<uint64_t> frees{0};
+  std::atomic<uint64_t> exhausted{0}; // Pedidos que no encontraron buffer
+  std::atomic<uint64_t> high_water{0}; // Máximo de buffers en uso a la vez
+};
+
+/**
+ * Pool de tamaño fijo de buffers de paquete reservados al inicio.
+ * La lista libre es una pila sin locks con etiqueta contra ABA, así que
+ * cualquier hilo puede pedir o devolver buffers.
+ */
+class PacketPool {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+  // Con huge_pages se intenta respaldar el pool con páginas grandes
+  // (MAP_HUGETLB o THP en Linux); si no se puede se usan páginas normales.
+  explicit PacketPool(std::size_t capacity = DEFAULT_CAPACITY,
+                      bool huge_pages = false);
+  ~PacketPool();
+  PacketPool(const PacketPool &) = delete;
+  PacketPool &operator=(const PacketPool &) = delete;
+
+  // Buffer nuevo con la cabecera inicializada (el payload no se limpia);
+  // vacío si el pool se agotó
+  PacketRef alloc();
+
+  // Buffer nuevo con una copia de 'pkt' (cabecera + payload_len bytes)
+  PacketRef clone(const SimulatedPacket &pkt);
+
+  std::size_t capacity() const { return capacity_; }
+  std::size_t in_use() const { return in_use_.load(std::memory_order_relaxed); }
+  bool huge_pages() const { return huge_pages_; }
+  const PoolStats &stats() const { return stats_; }
+
+private:
+  friend class PacketRef;
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+  void release(PacketBuffer *buf);
+
+  PacketBuffer *buffers_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t mapped_bytes_ = 0;
+  bool huge_pages_ = false;
+
+  std::atomic<uint32_t> *next_ = nullptr; // Siguiente libre de cada buffer
+  std::atomic<uint64_t> head_{0};          // (etiqueta << 32) | índice
+  std::atomic<std::size_t> in_use_{0};
+  PoolStats stats_;
+};
+
+inline void PacketRef::reset() {
+  if (buf_ && buf_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    buf_->pool->release(buf_);
+  buf_ = nullptr;
+}
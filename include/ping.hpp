@@ -0,0 +1,69 @@
+#pragma once
+
+#include "packet.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class RouterCore;
+
+struct OpcionesPing {
+  uint32_t destino = 0;
+  std::size_t repeat = 5;
+  std::size_t size = 100; // Bytes de payload (al menos sizeof(CabeceraEcho))
+  std::chrono::milliseconds timeout{2000};
+  std::chrono::milliseconds interval{0}; // Entre envíos (sin flood)
+  bool flood = false;      // Mantener 'ventana' solicitudes en vuelo
+  std::size_t ventana = 64;
+};
+
+struct ResultadoPing {
+  std::string error; // Vacío si se pudo enviar
+  uint32_t origen = 0;
+  std::size_t enviados = 0;
+  std::size_t recibidos = 0;
+  std::size_t duplicados = 0;
+  double min_ms = 0, avg_ms = 0, max_ms = 0, stddev_ms = 0;
+};
+
+/**
+ * Solicitudes en vuelo de un ping. El hilo que recibe la respuesta anota su
+ * RTT (calculado con la marca de tiempo que viene en el propio paquete) y el
+ * hilo de la CLI la consulta. Las secuencias son de 16 bits, así que las
+ * ranuras se reutilizan cada 65536 envíos.
+ */
+class SesionPing {
+public:
+  static constexpr std::size_t MAX_RANURAS = 65536;
+
+  SesionPing(uint16_t id, std::size_t total);
+
+  uint16_t id() const { return id_; }
+
+  // Hilo RX: anotar una respuesta con esta sesión
+  void registrar_respuesta(const CabeceraEcho &eco, uint64_t ahora_ns);
+
+  // Hilo de la CLI
+  void preparar(uint32_t n); // Antes de enviar la solicitud n
+  uint64_t rtt_ns(uint32_t n) const; // 0 si aún no llega
+  uint64_t duplicados() const { return duplicados_.load(); }
+
+private:
+  uint16_t id_;
+  std::vector<std::atomic<uint64_t>> rtt_;
+  std::atomic<uint64_t> duplicados_{0};
+};
+
+// Reloj de las marcas de tiempo de los Echo
+uint64_t ahora_ns();
+
+// Enviar las solicitudes siguiendo la tabla de ruteo del router y esperar las
+// respuestas. 'progreso' recibe '!' por cada respuesta y '.' por cada
+// solicitud vencida, en orden (sin flood).
+ResultadoPing ejecutar_ping(RouterCore &core, const OpcionesPing &opciones,
+                            const std::function<void(char)> &progreso);
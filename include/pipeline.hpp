@@ -0,0 +1,89 @@
+#pragma once
+
+#include "packet_pool.hpp"
+#include "spsc_ring.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class NetworkEngine;
+class RouterCore;
+
+// Paquete en tránsito entre la etapa de recepción y la de forwarding
+struct DescriptorPipeline {
+  int ifindex = -1; // Interfaz de entrada
+  PacketRef pkt;
+};
+
+// Contadores de un worker de forwarding
+struct EstadisticasWorker {
+  std::atomic<uint64_t> procesados{0};
+  std::atomic<uint64_t> rondas{0};     // Vueltas con al menos un paquete
+  std::atomic<uint64_t> drop_lleno{0}; // Descartados porque su cola estaba llena
+  std::atomic<uint64_t> despertares{0};
+};
+
+// Pipeline de tres etapas:
+//   RX: los hilos de recepción del motor de red encolan descriptores
+//   Forwarding: un pool de workers vacía las colas en ráfagas y llama al core
+//   TX: cada worker acumula sus envíos por interfaz y los envía juntos
+// Cada hilo RX tiene su propia cola SPSC hacia cada worker, así que ninguna
+// cola tiene más de un productor. Un mismo par origen/destino siempre va al
+// mismo worker, lo que conserva el orden del flujo.
+class ForwardingPipeline {
+public:
+  static constexpr std::size_t DEFAULT_RING = 1024;
+  static constexpr std::size_t MAX_PRODUCTORES = 32;
+  static constexpr std::size_t MAX_WORKERS = 64;
+  static constexpr std::size_t RAFAGA = 64;
+
+  ForwardingPipeline(RouterCore &core, NetworkEngine &net, std::size_t workers,
+                     std::size_t tam_ring = DEFAULT_RING);
+  ~ForwardingPipeline();
+  ForwardingPipeline(const ForwardingPipeline &) = delete;
+  ForwardingPipeline &operator=(const ForwardingPipeline &) = delete;
+
+  void start();
+  void stop();
+
+  // Etapa RX: se llama desde los hilos de recepción con cada ráfaga
+  void encolar(int ifindex, PacketRef *pkts, std::size_t n);
+
+  std::size_t workers() const { return workers_.size(); }
+  std::size_t tam_ring() const { return tam_ring_; }
+  std::size_t productores() const {
+    return productores_activos_.load(std::memory_order_acquire);
+  }
+  // Paquetes esperando en las colas de un worker
+  std::size_t profundidad(std::size_t worker) const;
+  const EstadisticasWorker &stats(std::size_t worker) const {
+    return workers_[worker]->stats;
+  }
+  // Ráfagas procesadas en el propio hilo RX porque no quedaban colas libres
+  uint64_t sin_cola() const { return sin_cola_.load(); }
+
+private:
+  struct Worker {
+    std::vector<std::unique_ptr<SpscRing<DescriptorPipeline>>> colas; // Una por productor
+    std::atomic<uint32_t> senal{0};
+    std::atomic<bool> dormido{false};
+    EstadisticasWorker stats;
+    std::thread hilo;
+  };
+
+  void worker_loop(Worker &worker);
+  int registrar_productor();
+  void procesar(DescriptorPipeline *desc, std::size_t n);
+
+  RouterCore &core_;
+  NetworkEngine &net_;
+  std::size_t tam_ring_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<bool> ocupado_[MAX_PRODUCTORES] = {};
+  std::atomic<std::size_t> productores_activos_{0}; // Mayor índice usado + 1
+  std::atomic<uint64_t> sin_cola_{0};
+  std::atomic<bool> running_{false};
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Read-Copy-Update por épocas para compartir estructuras inmutables entre el
+ * plano de control (CLI) y los hilos del plano de datos.
+ *
+ * - Los lectores abren una SeccionLectura (no bloquea, sin locks) y leen el
+ *   puntero publicado con una carga atómica.
+ * - Los escritores construyen una copia nueva, la publican con un intercambio
+ *   atómico y retiran la versión anterior. Lo retirado se libera cuando ningún
+ *   lector que pudo haberlo visto sigue dentro de su sección.
+ */
+namespace rcu {
+
+// Sección de lectura del hilo actual. Se puede anidar.
+class SeccionLectura {
+public:
+  SeccionLectura();
+  ~SeccionLectura();
+  SeccionLectura(const SeccionLectura &) = delete;
+  SeccionLectura &operator=(const SeccionLectura &) = delete;
+};
+
+// Diferir la liberación de 'objeto' hasta que sea seguro
+void retirar(void *objeto, void (*liberar)(void *));
+
+// Liberar todo lo retirado que ya no puede estar en uso. Devuelve cuántos
+// objetos se liberaron.
+std::size_t reclamar();
+
+// Objetos retirados que aún esperan a algún lector
+std::size_t pendientes();
+
+} // namespace rcu
+
+// Puntero publicado bajo RCU. T se trata como inmutable una vez publicado.
+template <typename T> class RcuPtr {
+public:
+  RcuPtr() = default;
+  ~RcuPtr() {
+    const T *actual = actual_.exchange(nullptr);
+    if (actual)
+      rcu::retirar(const_cast<T *>(actual), &borrar);
+  }
+  RcuPtr(const RcuPtr &) = delete;
+  RcuPtr &operator=(const RcuPtr &) = delete;
+
+  // Sólo válido dentro de una rcu::SeccionLectura
+  const T *leer() const { return actual_.load(std::memory_order_seq_cst); }
+
+  // Publicar una versión nueva y retirar la anterior
+  void publicar(std::unique_ptr<T> nuevo) {
+    const T *anterior = actual_.exchange(nuevo.release());
+    if (anterior)
+      rcu::retirar(const_cast<T *>(anterior), &borrar);
+  }
+
+private:
+  static void borrar(void *p) { delete static_cast<T *>(p); }
+
+  std::atomic<const T *> actual_{nullptr};
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "router_core.hpp"
+#include "traffic_gen.hpp"
 #include <functional> //Funciones lambda
 #include <memory>     //Manejar problemas de memoria
 #include <string>
@@ -52,11 +53,6 @@ public:
   bool ejecutar_linea(CommandContexto &contexto, const std::string &linea,
                       std::string &error) const;
 
-private:
-  // El nodo raíz se mantiene privado porque sólo la clase tiene acceso a él
-  // No es un comando. Todos los comandos son sus hijos
-  std::unique_ptr<CommandNodo> raiz = std::make_unique<CommandNodo>();
-
   // Dividir el comando en palabras individualez
   static std::vector<std::string> tokenize(const std::string &linea);
 
@@ -66,6 +62,11 @@ private:
   const CommandNodo *detectar_comando(const std::vector<std::string> &tokens,
                                       std::vector<const CommandNodo *> &path,
                                       std::string &error) const;
+
+private:
+  // El nodo raíz se mantiene privado porque sólo la clase tiene acceso a él
+  // No es un comando. Todos los comandos son sus hijos
+  std::unique_ptr<CommandNodo> raiz = std::make_unique<CommandNodo>();
 };
 
 class RouterCLI {
@@ -75,14 +76,27 @@ public:
   // Bucle
   void run();
 
+  // Ejecutar una línea en el modo actual. Devuelve false si la línea cerró la
+  // sesión ('exit' en user exec).
+  bool ejecutar(const std::string &linea);
+  std::string prompt() const;
+  // Volver a user exec con la sesión abierta (otra consola se conecta)
+  void reiniciar_sesion();
+
+  // Árbol de comandos de cada modo (también lo usan los benchmarks)
+  const ArbolComandos &obtener_arbol_de_modo(CliMode modo) const;
+
 private:
   // El CLI comienza en user exec
   CliMode modo_actual = CliMode::USER_EXEC;
 
   RouterCore &core_; // Referencia al core (configuración) del router
+  bool sesion_activa_ = true;
 
   std::string interfaz, ospf_process_id;
 
+  std::unique_ptr<GeneradorTrafico> generador_; // Se crea con el primer start
+
   // Comandos de cada tipo de CLI
   ArbolComandos arbol_user_exec;
   ArbolComandos arbol_priv_exec;
@@ -93,8 +107,6 @@ private:
 
   // Funciones helpers
   CommandContexto crear_contexto() const;
-  const ArbolComandos &obtener_arbol_de_modo(CliMode modo) const;
-  std::string prompt() const;
 
   // Registrar comandos por modo
   void registrar_comandos_user_exec();
@@ -127,12 +139,30 @@ private:
                                     const std::vector<std::string> &);
   void handle_show_ip_ospf_interface(const CommandContexto &,
                                      const std::vector<std::string> &);
+  void handle_show_ip_ospf_database(const CommandContexto &,
+                                    const std::vector<std::string> &);
+  void handle_show_ip_ospf_statistics(const CommandContexto &,
+                                      const std::vector<std::string> &);
   void handle_show_ip_route(const CommandContexto &,
                             const std::vector<std::string> &);
+  void handle_show_ip_traffic(const CommandContexto &,
+                              const std::vector<std::string> &);
+  void handle_show_engine_statistics(const CommandContexto &,
+                                     const std::vector<std::string> &);
   void
   handle_copy_running_config_startup_config(const CommandContexto &,
                                             const std::vector<std::string> &);
   void handle_reload(const CommandContexto &, const std::vector<std::string> &);
+  void handle_traffic_generator_start(const CommandContexto &,
+                                      const std::vector<std::string> &);
+  void handle_traffic_generator_stop(const CommandContexto &,
+                                     const std::vector<std::string> &);
+  void handle_show_traffic_generator(const CommandContexto &,
+                                     const std::vector<std::string> &);
+  void handle_clear_traffic_generator(const CommandContexto &,
+                                      const std::vector<std::string> &);
+  void handle_clear_ip_ospf_process(const CommandContexto &,
+                                    const std::vector<std::string> &);
 
   // Handlers global config
   void handle_hostname(const CommandContexto &,
@@ -145,6 +175,12 @@ private:
                         const std::vector<std::string> &);
   void handle_router_ospf(const CommandContexto &,
                           const std::vector<std::string> &);
+  void handle_no_router_ospf(const CommandContexto &,
+                             const std::vector<std::string> &);
+  void handle_ip_route(const CommandContexto &,
+                       const std::vector<std::string> &);
+  void handle_no_ip_route(const CommandContexto &,
+                          const std::vector<std::string> &);
   void handle_exit_global(const CommandContexto &,
                           const std::vector<std::string> &);
   void handle_end(const CommandContexto &, const std::vector<std::string> &);
@@ -161,12 +197,22 @@ private:
   // Handlers Config interface
   void handle_ip_address(const CommandContexto &,
                          const std::vector<std::string> &);
+  void handle_no_ip_address(const CommandContexto &,
+                            const std::vector<std::string> &);
   void handle_no_shutdown(const CommandContexto &,
                           const std::vector<std::string> &);
   void handle_description(const CommandContexto &,
                           const std::vector<std::string> &);
   void handle_shutdown(const CommandContexto &,
                        const std::vector<std::string> &);
+  void handle_rx_queues(const CommandContexto &,
+                        const std::vector<std::string> &);
+  void handle_ip_ospf_hello_interval(const CommandContexto &,
+                                     const std::vector<std::string> &);
+  void handle_ip_ospf_dead_interval(const CommandContexto &,
+                                    const std::vector<std::string> &);
+  void handle_ip_ospf_cost(const CommandContexto &,
+                           const std::vector<std::string> &);
 
   // Handlers OSPF
   void handle_network(const CommandContexto &,
@@ -177,4 +223,12 @@ private:
                                 const std::vector<std::string> &);
   void handle_no_passive_interface(const CommandContexto &,
                                    const std::vector<std::string> &);
+  void handle_timers_throttle_spf(const CommandContexto &,
+                                  const std::vector<std::string> &);
+  void handle_no_timers_throttle_spf(const CommandContexto &,
+                                     const std::vector<std::string> &);
+  void handle_area_range(const CommandContexto &,
+                         const std::vector<std::string> &);
+  void handle_no_area_range(const CommandContexto &,
+                            const std::vector<std::string> &);
 };
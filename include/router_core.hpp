@@ -1,25 +1,48 @@
 #pragma once
 
+#include "fib.hpp"
+#include "local_addr.hpp"
+#include "rcu.hpp"
+#include "spf.hpp"
+#include "traffic_gen.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class NetworkEngine;
+class ForwardingPipeline;
+class ProcesoOSPF;
+class TimerWheel;
+class WorkerPool;
 struct SimulatedPacket;
+class PacketRef;
+class SesionPing;
+
+struct DireccionSecundaria {
+  std::string ip;
+  std::string netmask;
+};
 
 struct InfoInterfaz {
+  int ifindex = -1; // Posición en RouterCore::interfaces; no cambia
   std::string nombre;
   std::string ip;
   std::string netmask;
+  std::vector<DireccionSecundaria> secundarias;
   std::string description;
   bool up = false;
-};
-
-struct InfoOSPF {
-  std::string router_id;
-  std::string neighbor_ip;
-  std::string state;
-  std::string interfaz;
+  std::size_t colas_rx = 1; // Sockets de recepción en el motor de red
+  bool logica = false; // Loopback o subinterfaz creada desde la CLI
+  int padre = -1;      // Subinterfaz: ifindex de la interfaz física
+  uint16_t ospf_hello = 0; // 'ip ospf hello-interval' (0: por defecto)
+  uint32_t ospf_dead = 0;  // 'ip ospf dead-interval' (0: 4 hellos)
+  uint16_t ospf_cost = 0;  // 'ip ospf cost' (0: por defecto)
 };
 
 struct NetworkEntry {
@@ -28,11 +51,20 @@ struct NetworkEntry {
   int area;
 };
 
+// 'area X range': se anuncia a las demás áreas como un solo summary
+struct AreaRange {
+  int area;
+  std::string network;
+  std::string netmask;
+};
+
 struct ConfigOSPF {
   std::string router_id;
   std::string process_id;
   std::vector<NetworkEntry> networks;
   std::vector<std::string> passive_interfaces;
+  std::vector<AreaRange> ranges;
+  ThrottleSPF throttle_spf;
   bool active = false;
 };
 
@@ -40,8 +72,57 @@ struct InfoRoute {
   std::string destino;
   std::string netmask;
   std::string via;
-  std::string interfaz;
+  int ifindex = -1; // Interfaz de salida
   std::string protocolo;
+  uint32_t metrica = 0; // Costo OSPF
+  bool inter_area = false; // OSPF aprendida de un summary ("O IA")
+};
+
+// Ruta estática tal como se escribió en 'ip route'
+struct ConfigRutaEstatica {
+  std::string destino;
+  std::string netmask;
+  std::string siguiente_salto; // IP del siguiente salto o nombre de interfaz
+};
+
+// Contadores del plano de datos (se actualizan desde los hilos de recepción)
+struct EstadisticasForwarding {
+  std::atomic<uint64_t> recibidos{0};
+  std::atomic<uint64_t> locales{0};
+  std::atomic<uint64_t> reenviados{0};
+  std::atomic<uint64_t> drop_ttl{0};
+  std::atomic<uint64_t> drop_sin_ruta{0};
+  std::atomic<uint64_t> drop_interfaz_caida{0};
+  std::atomic<uint64_t> drop_tx{0};
+  std::atomic<uint64_t> drop_sin_buffer{0};
+};
+
+// Interfaz vista por el plano de datos (el índice en el vector es el ifindex)
+struct InterfazForwarding {
+  int enlace = -1; // ifindex del enlace por el que sale (el padre en subinterfaces)
+  uint32_t ip = 0;
+  bool up = false;
+};
+
+// Ruta vista por el plano de datos
+struct RutaForwarding {
+  int salida = -1; // ifindex de la interfaz de salida
+  uint32_t via = 0; // Siguiente salto (0 si es directamente conectada)
+};
+
+// Estado inmutable que leen los hilos de recepción. Cada cambio de
+// configuración publica una versión nueva (ver RouterCore::publicar_estado)
+struct EstadoForwarding {
+  uint64_t version = 0;
+  std::vector<InterfazForwarding> interfaces;
+  std::vector<RutaForwarding> rutas;
+  FibTrie fib; // Los valores son índices de 'rutas'
+  TablaLocal locales; // Direcciones de las interfaces activas
+};
+
+// Sesiones de ping en curso, publicadas para los hilos de recepción
+struct RegistroEcos {
+  std::vector<std::shared_ptr<SesionPing>> sesiones;
 };
 
 struct ConfigSnapshot { // Para mostrar las configuraciones
@@ -54,22 +135,44 @@ public:
   std::string version = "Router Sistemas Operativos 2.0";
 
   std::vector<InfoInterfaz> interfaces;
-  std::vector<InfoOSPF> ospf_neighbors;
   std::vector<InfoRoute> rutas;
+  std::vector<ConfigRutaEstatica> rutas_estaticas;
   ConfigOSPF ospf_config;
+  EstadisticasForwarding stats_fwd;
+  ReceptorTrafico receptor_trafico; // Paquetes del generador que llegan aquí
+  FibTrie fib; // Índices de 'rutas' organizados para Longest Prefix Match
+  RcuPtr<EstadoForwarding> estado_fwd; // Copia publicada para el plano de datos
 
   ConfigSnapshot running_config;
   std::optional<ConfigSnapshot>
       startup_config; // No es obligatorio tener una startup-conflict
 
   NetworkEngine *net_engine = nullptr;
+  ForwardingPipeline *pipeline = nullptr; // nullptr: forwarding en los hilos RX
+  TimerWheel *temporizadores = nullptr;   // Compartida por los protocolos
+  WorkerPool *calculo = nullptr; // SPF por área en paralelo (nullptr: en línea)
+
+  // Lo toma la CLI durante cada comando. Los protocolos que cambian rutas
+  // desde otro hilo lo intentan tomar sin bloquearse (ver instalar_rutas_ospf)
+  std::mutex mutex_config;
+
+  RouterCore();
+  ~RouterCore();
 
   static std::string expandir_nombre_interfaz(const std::string &nombre);
+  // Los nombres se traducen a ifindex una sola vez, en la CLI o al cargar la
+  // topología; rutas, enlaces y el plano de datos sólo usan el ifindex
   InfoInterfaz *get_interfaz(const std::string &nombre);
+  InfoInterfaz *get_interfaz(int ifindex);
+  int ifindex(const std::string &nombre);
+  InfoInterfaz &agregar_interfaz(const std::string &nombre);
+  InfoInterfaz *crear_interfaz_logica(const std::string &nombre);
   InfoRoute *set_route(std::string destino, std::string netmask,
-                       std::string via, std::string interfaz,
-                       std::string protocolo);
+                       std::string via, int ifindex, std::string protocolo);
   InfoRoute *find_route(const std::string &dest_ip);
+  InfoRoute *find_route(uint32_t dest_ip);
+  void reconstruir_fib();
+  static int distancia_administrativa(const std::string &protocolo);
 
   std::string password = "";
   bool login_local = false;
@@ -80,11 +183,47 @@ public:
   void generar_running_config();
   void actualizar_running_config();
   void recalcular_rutas_connected();
+  void recalcular_rutas_estaticas();
+  void publicar_estado();
+  std::string calcular_red(const std::string &ip, const std::string &mask);
+
+  // Aplicar 'router ospf' y las interfaces al proceso OSPF (lo crea la
+  // primera vez). Se llama en cada cambio de configuración que lo afecte.
+  void actualizar_ospf();
+  // Reiniciar el proceso con la configuración actual
+  void reiniciar_ospf();
+  ProcesoOSPF *ospf() const { return ospf_activo_.load(std::memory_order_acquire); }
+  // Hilo de la rueda: reemplazar las rutas "O" por las del último SPF y
+  // publicar. Devuelve false sin tocar nada si la configuración está tomada.
+  bool instalar_rutas_ospf(const std::vector<RutaOSPF> &nuevas);
 
   void process_password(const std::string &pwd, bool hashear);
-  void handle_incoming_packet(const std::string &iface,
-                              const SimulatedPacket &pkt);
+  // Tráfico originado por el router (ping): sale según el estado publicado
+  bool originar_paquete(const SimulatedPacket &pkt);
+  bool direccion_origen(uint32_t destino, uint32_t &origen);
+  void agregar_sesion_ping(std::shared_ptr<SesionPing> sesion);
+  void quitar_sesion_ping(const SesionPing *sesion);
+  uint16_t nuevo_id_ping() { return siguiente_id_ping_++; }
+
+  void handle_incoming_packet(int ifindex, PacketRef &pkt);
+  void handle_incoming_burst(int ifindex, PacketRef *pkts, std::size_t n);
 
 private:
-  std::string calcular_red(const std::string &ip, const std::string &mask);
+  void instalar_en_fib(uint32_t indice);
+  void procesar_paquete(const EstadoForwarding &estado, int ifindex,
+                        PacketRef &pkt);
+  bool tomar_exclusivo(PacketRef &pkt);
+  void reenviar_paquete(const EstadoForwarding &estado, PacketRef &pkt);
+  bool enviar_por_ruta(const EstadoForwarding &estado,
+                       const SimulatedPacket &pkt);
+  bool entregar_eco(const SimulatedPacket &pkt);
+
+  uint64_t version_estado_ = 0;
+  std::unordered_map<std::string, int> ifindex_por_nombre_;
+  RcuPtr<RegistroEcos> ecos_;
+  std::mutex mutex_ecos_; // Serializa los cambios al registro de ecos
+  std::atomic<uint16_t> siguiente_id_ping_{1};
+  std::unique_ptr<ProcesoOSPF> ospf_;
+  std::atomic<ProcesoOSPF *> ospf_activo_{nullptr}; // Lo leen los hilos RX
+  uint32_t router_id_auto_ = 0; // Elegido sin 'router-id' (0: sin elegir)
 };
\ No newline at end of file
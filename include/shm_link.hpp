@@ -0,0 +1,64 @@
+#pragma once
+
+#include "packet.hpp"
+#include "packet_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+struct ShmSegmento;
+struct ShmAnillo;
+
+/**
+ * Enlace entre dos routers del mismo host sobre memoria compartida.
+ * El segmento (/dev/shm/router-<nombre>) tiene dos colas circulares, una por
+ * sentido, con los datagramas en el mismo formato que en UDP. Cada lado es el
+ * único productor de una cola y el único consumidor de la otra. Cuando el
+ * consumidor no tiene nada que leer se duerme en un futex del segmento y el
+ * productor lo despierta sólo si está dormido.
+ *
+ * No es sin copias: send() copia cada paquete a su ranura y receive() lo copia
+ * a un buffer del pool local, porque el pool es privado de cada proceso y el
+ * router puede retener un paquete recibido más de lo que la ranura puede
+ * esperar.
+ */
+class ShmLink {
+public:
+  static constexpr uint32_t SLOTS = 1024; // Por sentido, potencia de dos
+
+  ShmLink() = default;
+  ~ShmLink();
+  ShmLink(const ShmLink &) = delete;
+  ShmLink &operator=(const ShmLink &) = delete;
+
+  // Crear el segmento o unirse al que creó el otro extremo
+  bool open(const std::string &name);
+  const std::string &name() const { return name_; }
+  int side() const { return side_; }
+
+  // Escribir paquetes en la cola de salida. Devuelve cuántos entraron; el
+  // resto se pierde igual que un datagrama sin receptor.
+  std::size_t send(const SimulatedPacket *const *packets, std::size_t count);
+
+  // Esperar a que haya datos en la cola de entrada o a wake(). No se duerme
+  // si 'running' ya es false.
+  void wait(const std::atomic<bool> &running);
+  void wake();
+
+  // Leer hasta 'max' datagramas a buffers del pool
+  std::size_t receive(PacketPool &pool, PacketRef *out, std::size_t max,
+                      std::size_t &invalid, std::size_t &no_buffer);
+
+private:
+  std::string name_;
+  std::string path_;
+  ShmSegmento *seg_ = nullptr;
+  std::size_t len_ = 0;
+  int side_ = -1;
+  std::mutex tx_mutex_; // Varios hilos locales pueden transmitir por el enlace
+
+  ShmAnillo &tx_ring();
+  ShmAnillo &rx_ring();
+};
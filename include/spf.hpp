@@ -0,0 +1,198 @@
+#pragma once
+
+#include "lsdb.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Heap binario de mínimos sobre índices de vértice, con la posición de cada
+ * vértice guardada aparte para que bajar su clave sea O(log n) en lugar de
+ * insertarlo otra vez. Así el heap nunca tiene más entradas que vértices y
+ * no hay que descartar entradas viejas al extraer.
+ */
+class HeapIndexado {
+public:
+  static constexpr uint32_t NINGUNO = UINT32_MAX;
+
+  void redimensionar(std::size_t vertices) {
+    posicion_.resize(vertices, NINGUNO);
+  }
+  bool vacio() const { return datos_.empty(); }
+  std::size_t size() const { return datos_.size(); }
+  bool contiene(uint32_t v) const { return posicion_[v] != NINGUNO; }
+
+  // Insertar 'v' o, si ya está, bajar su clave (nunca la sube)
+  void insertar_o_bajar(uint32_t v, uint32_t clave);
+  uint32_t extraer(); // Vértice de menor clave
+  void limpiar();
+
+private:
+  struct Entrada {
+    uint32_t clave;
+    uint32_t vertice;
+  };
+  void subir(std::size_t i);
+  void hundir(std::size_t i);
+  void colocar(std::size_t i, Entrada e) {
+    datos_[i] = e;
+    posicion_[e.vertice] = static_cast<uint32_t>(i);
+  }
+
+  std::vector<Entrada> datos_;
+  std::vector<uint32_t> posicion_; // Vértice -> posición en datos_
+};
+
+// Ruta calculada por el SPF: intra-área, o inter-área a partir de los
+// summary-LSAs de un ABR (anunciante)
+struct RutaOSPF {
+  uint32_t red = 0;
+  uint32_t mascara = 0;
+  uint32_t costo = 0;
+  int salida = -1;    // ifindex de la interfaz de salida
+  uint32_t via = 0;   // Siguiente salto
+  uint32_t anunciante = 0;
+  bool inter_area = false;
+
+  bool operator==(const RutaOSPF &) const = default;
+};
+
+// 'timers throttle spf', en milisegundos (valores por defecto de IOS)
+struct ThrottleSPF {
+  uint32_t inicial = 50;  // Del primer cambio tras un período tranquilo al SPF
+  uint32_t espera = 200;  // Mínimo entre dos SPF; se duplica si siguen cambios
+  uint32_t maximo = 5000; // Tope de la espera
+
+  bool operator==(const ThrottleSPF &) const = default;
+};
+
+// Resultado de una ejecución, para 'show ip ospf statistics'
+struct EjecucionSPF {
+  enum class Tipo { COMPLETO, INCREMENTAL, PARCIAL };
+  Tipo tipo = Tipo::COMPLETO;
+  std::chrono::steady_clock::time_point momento;
+  uint64_t duracion_us = 0;
+  std::size_t lsas = 0;     // LSAs cambiados que la dispararon
+  std::size_t vertices = 0; // Vértices que se volvieron a calcular
+  std::size_t rutas = 0;    // Prefijos cuya ruta cambió
+  uint32_t disparador = 0;  // Anunciante del primer LSA cambiado
+  uint32_t area = 0;
+};
+
+/**
+ * Árbol de caminos más cortos de un área sobre los router-LSAs, mantenido de
+ * forma incremental. Los vértices son routers (con enlaces punto a punto no
+ * hay redes de tránsito) y las redes stub son hojas que no forman parte del
+ * árbol.
+ *
+ * Cuando cambia el LSA de un router sólo se recalcula lo afectado:
+ *  - Si cambiaron únicamente sus redes stub, no se corre Dijkstra: se
+ *    vuelven a elegir las rutas de esos prefijos (cálculo parcial).
+ *  - Si una arista del árbol empeoró o desapareció, el subárbol que colgaba
+ *    de ella se invalida y sus vértices se vuelven a sembrar desde los
+ *    vecinos que siguen en el árbol.
+ *  - Si una arista mejoró o apareció, se relaja desde su origen.
+ * En los dos últimos casos Dijkstra corre sólo sobre los vértices que entran
+ * al heap, así que un cambio en un extremo de la red toca unos pocos nodos.
+ * Con muchos LSAs cambiados a la vez se recalcula todo.
+ */
+class CalculoSPF {
+public:
+  // Interfaz de salida y siguiente salto hacia un vecino directo de la raíz,
+  // dado el enlace P2P de la raíz ('datos' es la IP de la interfaz propia)
+  using ResolverSalto =
+      std::function<bool(uint32_t vecino, uint32_t datos, int &salida,
+                         uint32_t &via)>;
+
+  // Empezar de cero con otra raíz: el próximo cálculo es completo
+  void reiniciar(uint32_t raiz);
+
+  // El router-LSA de 'anunciante' cambió, apareció o dejó de valer
+  void cambio(uint32_t anunciante) { pendientes_.insert(anunciante); }
+  bool hay_pendientes() const { return completo_ || !pendientes_.empty(); }
+
+  // Aplicar lo pendiente. Devuelve true si cambió alguna ruta.
+  bool calcular(const LSDB &lsdb, const ResolverSalto &resolver,
+                EjecucionSPF &ejecucion);
+
+  // Rutas vigentes, ordenadas por prefijo
+  std::vector<RutaOSPF> rutas() const;
+  std::size_t alcanzados() const;
+  // Distancia y primer salto hacia un router del área (false si no está en
+  // el árbol), para las rutas inter-área a través de un ABR
+  bool camino(uint32_t router_id, uint32_t &distancia, int &salida,
+              uint32_t &via) const;
+
+private:
+  static constexpr uint32_t INFINITO = UINT32_MAX;
+  static constexpr uint32_t NINGUNO = UINT32_MAX;
+
+  struct Arista {
+    uint32_t vecino = 0; // Índice del vértice
+    uint32_t datos = 0;
+    uint16_t metrica = 0;
+    bool operator==(const Arista &) const = default;
+  };
+
+  struct Stub {
+    uint32_t red = 0;
+    uint32_t mascara = 0;
+    uint16_t metrica = 0;
+    bool operator==(const Stub &) const = default;
+  };
+
+  struct Vertice {
+    uint32_t router_id = 0;
+    bool presente = false; // Tiene un router-LSA válido
+    std::vector<Arista> aristas;
+    std::vector<Stub> stubs;
+
+    uint32_t distancia = INFINITO;
+    uint32_t padre = NINGUNO;
+    int salida = -1;
+    uint32_t via = 0;
+    std::vector<uint32_t> hijos;
+    uint64_t marca = 0;       // Igual a 'marca_' si se tocó en este cálculo
+    uint64_t invalidado = 0;  // Igual a 'marca_' si se invalidó
+  };
+
+  struct Prefijo {
+    std::vector<uint32_t> anunciantes; // Vértices con el stub
+    bool tiene_ruta = false;
+    RutaOSPF ruta;
+  };
+
+  uint32_t vertice(uint32_t router_id);
+  void cargar(uint32_t v, const LSDB &lsdb);
+  uint32_t costo(uint32_t desde, uint32_t hasta, uint32_t *datos) const;
+  void desenganchar(uint32_t v);
+  void relajar(uint32_t desde, uint32_t hasta, const ResolverSalto &resolver);
+  void dijkstra(const ResolverSalto &resolver);
+  void completo(const LSDB &lsdb, const ResolverSalto &resolver);
+  void incremental(const LSDB &lsdb, const ResolverSalto &resolver);
+  void tocar(uint32_t v);
+  void registrar_stubs(uint32_t v, const std::vector<Stub> &anteriores);
+  bool elegir_ruta(uint64_t clave, Prefijo &prefijo);
+
+  static uint64_t clave_prefijo(uint32_t red, uint32_t mascara) {
+    return uint64_t(red) << 32 | mascara;
+  }
+
+  uint32_t raiz_ = NINGUNO;
+  bool completo_ = true;
+  std::vector<Vertice> vertices_;
+  std::unordered_map<uint32_t, uint32_t> por_router_id_;
+  std::unordered_set<uint32_t> pendientes_; // Router-ids
+  std::unordered_map<uint64_t, Prefijo> prefijos_;
+  HeapIndexado heap_;
+
+  // Estado de un cálculo
+  std::chrono::steady_clock::time_point ahora_;
+  uint64_t marca_ = 0;
+  std::vector<uint32_t> tocados_;
+  std::unordered_set<uint64_t> prefijos_sucios_;
+};
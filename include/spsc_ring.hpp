@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * Cola circular sin locks de un productor y un consumidor.
+ * La capacidad se redondea a potencia de dos. Cada lado guarda una copia del
+ * índice del otro y sólo relee el atómico cuando esa copia no alcanza, así que
+ * en régimen normal productor y consumidor no comparten líneas de caché.
+ */
+template <typename T> class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacidad)
+      : capacidad_(std::bit_ceil(capacidad < 2 ? std::size_t(2) : capacidad)),
+        mascara_(capacidad_ - 1), slots_(new T[capacidad_]) {}
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Productor: encolar hasta 'n' elementos (se mueven). Devuelve cuántos
+  // entraron; el resto queda en 'items'.
+  std::size_t push_burst(T *items, std::size_t n) {
+    std::size_t cola = cola_.load(std::memory_order_relaxed);
+    if (capacidad_ - (cola - cabeza_vista_) < n)
+      cabeza_vista_ = cabeza_.load(std::memory_order_acquire);
+    std::size_t libres = capacidad_ - (cola - cabeza_vista_);
+    if (n > libres)
+      n = libres;
+    for (std::size_t i = 0; i < n; ++i)
+      slots_[(cola + i) & mascara_] = std::move(items[i]);
+    if (n > 0)
+      cola_.store(cola + n, std::memory_order_release);
+    return n;
+  }
+
+  bool push(T &&item) { return push_burst(&item, 1) == 1; }
+
+  // Consumidor: sacar hasta 'max' elementos en 'salida'
+  std::size_t pop_burst(T *salida, std::size_t max) {
+    std::size_t cabeza = cabeza_.load(std::memory_order_relaxed);
+    if (cola_vista_ - cabeza < max)
+      cola_vista_ = cola_.load(std::memory_order_acquire);
+    std::size_t n = cola_vista_ - cabeza;
+    if (n > max)
+      n = max;
+    for (std::size_t i = 0; i < n; ++i)
+      salida[i] = std::move(slots_[(cabeza + i) & mascara_]);
+    if (n > 0)
+      cabeza_.store(cabeza + n, std::memory_order_release);
+    return n;
+  }
+
+  // Aproximado si se consulta desde un tercer hilo
+  std::size_t size() const {
+    return cola_.load(std::memory_order_acquire) -
+           cabeza_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return capacidad_; }
+
+private:
+  const std::size_t capacidad_;
+  const std::size_t mascara_;
+  std::unique_ptr<T[]> slots_;
+
+  // Lado del consumidor
+  alignas(64) std::atomic<std::size_t> cabeza_{0};
+  std::size_t cola_vista_ = 0;
+
+  // Lado del productor
+  alignas(64) std::atomic<std::size_t> cola_{0};
+  std::size_t cabeza_vista_ = 0;
+};
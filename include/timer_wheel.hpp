@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Rueda de temporizadores jerárquica compartida por todos los protocolos del
+ * proceso (y por todos los routers en el emulador). Un solo hilo avanza la
+ * rueda cada 'tick'; programar, reprogramar y cancelar son O(1) y avanzar un
+ * tick sólo toca una ranura del primer nivel, así que miles de vecinos con sus
+ * temporizadores de hello y de inactividad no cuestan un hilo ni un sleep
+ * cada uno.
+ *
+ * Hay NIVELES ruedas de RANURAS ranuras: el nivel n cubre RANURAS^(n+1) ticks.
+ * Un temporizador lejano espera en un nivel alto y baja de nivel (cascada)
+ * cuando la rueda de abajo da la vuelta, hasta vencer en el primer nivel.
+ *
+ * Los callbacks corren en el hilo de la rueda, de a uno y sin el lock de la
+ * rueda tomado: pueden programar, reprogramar y cancelar temporizadores.
+ */
+class TimerWheel {
+public:
+  using Id = uint64_t;                       // 0 no es un temporizador válido
+  using Callback = std::function<void(Id)>;  // Recibe su propio Id
+  static constexpr std::size_t NIVELES = 4;
+  static constexpr std::size_t BITS_RANURA = 6;
+  static constexpr std::size_t RANURAS = std::size_t(1) << BITS_RANURA;
+  static constexpr uint64_t MAX_TICKS =
+      (uint64_t(1) << (BITS_RANURA * NIVELES)) - 1;
+
+  explicit TimerWheel(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+  ~TimerWheel();
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  void start();
+  void stop(); // Lo pendiente queda sin ejecutar
+
+  // Ejecutar 'cb' dentro de 'espera' (redondeado a ticks, al menos uno).
+  // 'dueno' agrupa temporizadores para cancelar_todos().
+  Id programar(std::chrono::milliseconds espera, Callback cb,
+               const void *dueno = nullptr);
+
+  // Mover un temporizador pendiente sin reservar memoria. Devuelve false si
+  // ya venció (o está corriendo): hay que programar uno nuevo.
+  bool reprogramar(Id id, std::chrono::milliseconds espera);
+
+  // Quitar un temporizador pendiente. Devuelve false si ya venció; su
+  // callback puede estar corriendo en este momento.
+  bool cancelar(Id id);
+
+  // Cancelar todos los temporizadores de 'dueno' y esperar al callback suyo
+  // que esté corriendo (salvo que lo llame ese mismo callback). Para
+  // destructores; el dueno no debe programar más mientras tanto.
+  void cancelar_todos(const void *dueno);
+
+  // Milisegundos que faltan para que venza (-1 si no está pendiente)
+  int64_t restante_ms(Id id) const;
+
+  // Avanzar a mano (sin hilo), para pruebas y benchmarks
+  void avanzar(uint64_t ticks);
+
+  std::chrono::milliseconds tick() const { return tick_; }
+  std::size_t pendientes() const;
+  uint64_t vencidos() const { return vencidos_.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr uint32_t NINGUNO = UINT32_MAX;
+
+  // Nodo de la lista doblemente enlazada de una ranura. Los nodos se reciclan
+  // por índice; la generación invalida los Id de usos anteriores.
+  struct Nodo {
+    uint64_t vence = 0; // Tick absoluto
+    uint32_t generacion = 0;
+    uint32_t anterior = NINGUNO;
+    uint32_t siguiente = NINGUNO;
+    uint32_t *lista = nullptr; // Cabeza de la ranura donde está (nullptr: libre)
+    const void *dueno = nullptr;
+    Callback cb;
+  };
+
+  static Id armar_id(uint32_t indice, uint32_t generacion) {
+    return (uint64_t(generacion) << 32) | (uint64_t(indice) + 1);
+  }
+  Nodo *buscar(Id id);
+  const Nodo *buscar(Id id) const;
+  uint64_t ticks_de(std::chrono::milliseconds espera) const;
+  void insertar(uint32_t indice);
+  void desenlazar(uint32_t indice);
+  void liberar(uint32_t indice);
+  void cascada(std::size_t nivel);
+  void avanzar_un_tick(std::unique_lock<std::mutex> &lock);
+  void bucle();
+
+  std::chrono::milliseconds tick_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Nodo> nodos_;
+  std::vector<uint32_t> libres_;
+  uint32_t ranuras_[NIVELES][RANURAS];
+  uint32_t vencidos_lista_ = NINGUNO; // Vencidos del tick en curso
+  uint64_t ahora_ = 0;                // Ticks transcurridos
+  std::size_t pendientes_ = 0;
+  Id en_curso_ = 0; // Callback corriendo
+  const void *dueno_en_curso_ = nullptr;
+  std::thread::id hilo_callbacks_;
+  std::atomic<uint64_t> vencidos_{0};
+  bool running_ = false;
+  std::thread hilo_;
+};
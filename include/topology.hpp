@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * Una línea del archivo de topología. Las vistas apuntan al archivo mapeado
+ * y sólo valen mientras el TopologyFile siga abierto.
+ */
+struct TopologyEntry {
+  enum class Kind : uint32_t { UDP = 0, SHM = 1, MEM = 2 };
+
+  std::string_view router;
+  std::string_view interface_name; // Tal como está escrito (sin expandir)
+  Kind kind = Kind::UDP;
+  int local_port = 0;
+  std::string_view remote; // IP remota (UDP) o nombre del enlace (shm/mem)
+  int remote_port = 0;
+  std::size_t rx_queues = 1; // Columna opcional de colas (sólo UDP)
+};
+
+/**
+ * Archivo de topología mapeado en memoria. Acepta el formato de texto de
+ * siempre o un índice binario generado con compile() (router --compile-topology),
+ * y lo detecta por el número mágico del comienzo.
+ *
+ * En texto, find() recorre el archivo sin copiar líneas: descarta cada línea
+ * comparando su primer campo y sólo separa los campos de las del router
+ * buscado. El índice tiene los routers ordenados por nombre y sus líneas ya
+ * separadas en campos, así que find() es una búsqueda binaria y el arranque de
+ * un router no depende del tamaño total de la topología (las páginas del
+ * archivo que no se tocan ni se leen del disco).
+ */
+class TopologyFile {
+public:
+  enum class Format { TEXT, INDEX };
+  using Visitor = std::function<void(const TopologyEntry &)>;
+
+  TopologyFile() = default;
+  ~TopologyFile();
+  TopologyFile(const TopologyFile &) = delete;
+  TopologyFile &operator=(const TopologyFile &) = delete;
+
+  bool open(const std::string &path);
+  void close();
+
+  Format format() const { return format_; }
+  std::size_t size() const { return len_; }
+
+  // Todas las entradas. En texto siguen el orden del archivo; en el índice
+  // van agrupadas por router, con los routers en orden de aparición.
+  std::size_t for_each(const Visitor &visit) const;
+
+  // Sólo las entradas de un router, en el orden del archivo
+  std::size_t find(std::string_view router, const Visitor &visit) const;
+
+  // Generar el índice binario de una topología de texto
+  static bool compile(const std::string &source, const std::string &target);
+
+private:
+  bool open_index();
+  std::size_t scan_text(std::string_view router, const Visitor &visit) const;
+  void visit_router(uint32_t router, const Visitor &visit) const;
+  std::string_view index_string(uint32_t offset, uint32_t length) const;
+
+  const char *data_ = nullptr;
+  std::size_t len_ = 0;
+  Format format_ = Format::TEXT;
+
+  // Secciones del índice (desplazamientos dentro del archivo)
+  uint32_t routers_ = 0;
+  uint32_t entries_ = 0;
+  std::size_t router_table_ = 0;
+  std::size_t sorted_table_ = 0;
+  std::size_t entry_table_ = 0;
+  std::size_t strings_ = 0;
+  std::size_t strings_size_ = 0;
+};
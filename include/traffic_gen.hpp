@@ -0,0 +1,145 @@
+#pragma once
+
+#include "packet.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class NetworkEngine;
+
+/**
+ * Payload de los paquetes del generador. 'seq' cuenta los paquetes enviados a
+ * ese destino, así el receptor detecta pérdidas por huecos aunque el rango de
+ * destinos termine en routers distintos. La marca de tiempo es del reloj
+ * monotónico del emisor: la latencia sólo tiene sentido con emisor y receptor
+ * en el mismo host, que es el caso del emulador.
+ */
+constexpr char TRAFICO_MARCA[8] = {'T', 'R', 'A', 'F', 'G', 'E', 'N', 0};
+struct CabeceraTrafico {
+  char marca[8];
+  uint32_t flujo; // Identificador del generador (orden de red)
+  uint32_t seq;   // Orden de red
+  uint64_t enviado_ns;
+};
+static_assert(sizeof(CabeceraTrafico) == 24,
+              "CabeceraTrafico debe medir 24 bytes");
+
+// Cómo son los paquetes generados
+struct PlantillaTrafico {
+  uint32_t origen = 0;
+  uint32_t destino_inicio = 0;
+  uint32_t destino_fin = 0; // Inclusivo; los destinos se recorren en ronda
+  std::size_t size_min = 64; // Bytes de payload, uniforme entre min y max
+  std::size_t size_max = 64;
+  uint8_t protocol = PROTO_DATOS;
+  uint8_t ttl = 64;
+};
+
+struct OpcionesGenerador {
+  int ifindex = -1; // Enlace del motor por el que sale todo
+  PlantillaTrafico plantilla;
+  uint64_t pps = 0;   // 0: lo más rápido posible
+  uint64_t total = 0; // 0: sin límite
+  std::chrono::milliseconds duracion{0}; // 0: sin límite
+};
+
+struct EstadisticasGenerador {
+  std::atomic<uint64_t> enviados{0}; // Entregados al motor de red
+  std::atomic<uint64_t> bytes{0};    // En el cable (cabecera incluida)
+  std::atomic<uint64_t> errores{0};
+  std::atomic<uint64_t> sin_buffer{0}; // Pool agotado
+};
+
+/**
+ * Genera un flujo de paquetes a partir de una plantilla desde un hilo propio
+ * y lo envía por un enlace del motor, en lotes (TxBatch) y al ritmo pedido.
+ */
+class GeneradorTrafico {
+public:
+  static constexpr std::size_t RAFAGA = 32;
+
+  explicit GeneradorTrafico(NetworkEngine &net) : net_(net) {}
+  ~GeneradorTrafico() { stop(); }
+  GeneradorTrafico(const GeneradorTrafico &) = delete;
+  GeneradorTrafico &operator=(const GeneradorTrafico &) = delete;
+
+  // Devuelve false si ya está corriendo o las opciones no son válidas
+  bool start(const OpcionesGenerador &opciones);
+  void stop();
+  bool activo() const { return activo_.load(); }
+
+  uint32_t flujo() const { return flujo_; }
+  const OpcionesGenerador &opciones() const { return opciones_; }
+  const EstadisticasGenerador &stats() const { return stats_; }
+  double segundos() const; // Desde start() hasta ahora o hasta que terminó
+
+private:
+  void bucle();
+
+  NetworkEngine &net_;
+  OpcionesGenerador opciones_;
+  EstadisticasGenerador stats_;
+  uint32_t flujo_ = 0;
+  std::atomic<bool> running_{false};
+  std::atomic<bool> activo_{false};
+  std::atomic<uint64_t> inicio_ns_{0};
+  std::atomic<uint64_t> fin_ns_{0};
+  std::thread hilo_;
+};
+
+/**
+ * Contadores del lado receptor, por flujo y destino. Los hilos RX los
+ * actualizan sin locks: la tabla es de direccionamiento abierto y cada
+ * entrada se reclama con un CAS sobre su clave.
+ */
+class ReceptorTrafico {
+public:
+  static constexpr std::size_t MAX_ENTRADAS = 4096; // Potencia de dos
+  static constexpr std::size_t BUCKETS = 40; // Latencia en potencias de 2 ns
+
+  struct Resumen {
+    uint32_t flujo = 0;
+    std::size_t destinos = 0;
+    uint64_t paquetes = 0;
+    uint64_t bytes = 0;
+    uint64_t perdidos = 0; // Huecos de secuencia
+    double segundos = 0;   // Entre el primer y el último paquete
+    double lat_avg_us = 0, lat_p50_us = 0, lat_p99_us = 0, lat_max_us = 0;
+  };
+
+  ReceptorTrafico() = default;
+  ~ReceptorTrafico() { delete[] entradas_.load(); }
+  ReceptorTrafico(const ReceptorTrafico &) = delete;
+  ReceptorTrafico &operator=(const ReceptorTrafico &) = delete;
+
+  // Hilos RX: contar el paquete si es del generador
+  bool registrar(const SimulatedPacket &pkt);
+
+  // Flujos vistos, agregando sus destinos
+  std::vector<Resumen> resumen() const;
+  std::size_t sin_lugar() const { return sin_lugar_.load(); }
+  void limpiar();
+
+private:
+  struct Entrada {
+    std::atomic<uint64_t> clave{0}; // flujo << 32 | destino; 0 = libre
+    std::atomic<uint64_t> paquetes{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> esperados{0}; // Mayor secuencia vista + 1
+    std::atomic<uint64_t> primero_ns{0};
+    std::atomic<uint64_t> ultimo_ns{0};
+    std::atomic<uint64_t> latencia_ns{0}; // Suma
+    std::atomic<uint64_t> latencia_max_ns{0};
+    std::atomic<uint64_t> histograma[BUCKETS] = {};
+  };
+
+  Entrada *entrada(uint64_t clave);
+
+  // La tabla (~1.5 MB) se reserva con el primer paquete del generador: en una
+  // emulación con miles de routers casi ninguno la necesita
+  std::atomic<Entrada *> entradas_{nullptr};
+  std::atomic<uint64_t> sin_lugar_{0};
+};
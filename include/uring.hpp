@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct msghdr;
+
+/**
+ * Envoltorio mínimo sobre io_uring usando las llamadas al sistema directas
+ * (sin liburing). Sólo expone lo que usa el motor de red: recepción multishot
+ * con buffers provistos, poll, sendmsg y archivos registrados.
+ * En plataformas sin io_uring init() devuelve false.
+ */
+class Uring {
+public:
+  // Resultado de una operación completada
+  struct Completion {
+    uint64_t user_data;
+    int32_t res;
+    uint32_t flags;
+
+    bool more() const;             // La operación multishot sigue activa
+    bool has_buffer() const;       // Se usó un buffer provisto
+    uint16_t buffer_id() const;
+  };
+
+  Uring() = default;
+  ~Uring();
+  Uring(const Uring &) = delete;
+  Uring &operator=(const Uring &) = delete;
+
+  // Crear el anillo con 'entries' SQEs y 'cq_entries' CQEs (0 = por defecto)
+  bool init(unsigned entries, unsigned cq_entries = 0);
+  bool valid() const { return fd_ >= 0; }
+  unsigned sq_space() const; // SQEs libres
+
+  // Registrar sockets; las operaciones los referencian por índice
+  bool register_files(const int *fds, unsigned count);
+  void unregister_files();
+
+  // Anillo de 'count' buffers de 'size' bytes (count potencia de dos) del
+  // que el kernel elige al completar una recepción
+  bool setup_buffers(uint16_t group, unsigned count, unsigned size);
+  char *buffer(uint16_t id) const;
+  unsigned buffer_size() const { return buf_size_; }
+  void recycle_buffer(uint16_t id);  // Devolver un buffer (pendiente)
+  void commit_buffers();             // Publicar los devueltos al kernel
+
+  // Preparar operaciones. Devuelven false si la cola de envío está llena.
+  bool prep_recv_multishot(unsigned fixed_file, uint16_t group,
+                           uint64_t user_data);
+  bool prep_poll(int fd, uint64_t user_data);
+  bool prep_sendmsg(int fd, const struct msghdr *msg, uint64_t user_data);
+  bool prep_cancel_all(uint64_t user_data); // Cancelar toda operación en curso
+
+  // Enviar lo preparado (y lo publicado que el kernel no llegó a tomar) y
+  // esperar al menos 'wait' completaciones. Devuelve el resultado de
+  // io_uring_enter (-1 con errno si falla).
+  int submit(unsigned wait = 0);
+
+  // Copiar hasta 'max' completaciones y liberarlas del anillo
+  unsigned reap(Completion *out, unsigned max);
+
+private:
+  void *sqe_slot();
+
+  int fd_ = -1;
+  void *sq_ptr_ = nullptr;
+  void *cq_ptr_ = nullptr;
+  void *sqes_ = nullptr;
+  std::size_t sq_len_ = 0;
+  std::size_t cq_len_ = 0;
+  std::size_t sqes_len_ = 0;
+
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned sqe_tail_ = 0;    // SQEs preparadas (locales)
+  unsigned sqe_head_ = 0;    // SQEs ya publicadas al kernel
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  void *cqes_ = nullptr;
+
+  void *buf_ring_ = nullptr;  // struct io_uring_buf_ring
+  std::size_t buf_ring_len_ = 0;
+  char *buf_mem_ = nullptr;
+  std::size_t buf_mem_len_ = 0;
+  unsigned buf_count_ = 0;
+  unsigned buf_size_ = 0;
+  uint16_t buf_tail_ = 0;
+  uint16_t buf_group_ = 0;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Pool de hilos para cálculos del plano de control que se pueden repartir
+ * (el SPF de cada área). Lo comparten todos los routers del proceso, igual
+ * que la TimerWheel.
+ *
+ * ejecutar() reparte un lote de tareas y vuelve cuando terminaron todas. El
+ * hilo que llama también toma tareas del lote, así que nunca espera ocioso y
+ * un lote llamado desde dentro de una tarea no puede trabar el pool. Con una
+ * sola tarea, o sin hilos, todo corre en el llamador.
+ */
+class WorkerPool {
+public:
+  // 0: uno menos que los núcleos disponibles (el llamador es el otro)
+  explicit WorkerPool(std::size_t hilos = 0);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  void ejecutar(const std::vector<std::function<void()>> &tareas);
+
+  std::size_t hilos() const { return hilos_.size(); }
+  uint64_t lotes() const { return lotes_.load(std::memory_order_relaxed); }
+
+private:
+  struct Lote {
+    const std::vector<std::function<void()>> *tareas = nullptr;
+    std::size_t total = 0; // Sin mirar 'tareas', que vive en el llamador
+    std::atomic<std::size_t> siguiente{0};  // Próxima tarea sin tomar
+    std::atomic<std::size_t> pendientes{0}; // Sin terminar
+  };
+
+  void bucle();
+  // Correr tareas del lote hasta que no quede ninguna sin tomar
+  void trabajar(Lote &lote);
+
+  std::vector<std::thread> hilos_;
+  std::mutex mutex_;
+  std::condition_variable hay_trabajo_;
+  std::condition_variable terminado_;
+  std::deque<std::shared_ptr<Lote>> lotes_pendientes_;
+  bool detener_ = false;
+  std::atomic<uint64_t> lotes_{0};
+};
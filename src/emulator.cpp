@@ -0,0 +1,278 @@
+#include "../include/emulator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// Un extremo de enlace tal como aparece en la topología
+struct Extremo {
+  std::size_t nodo;
+  std::string interfaz;
+  std::string clave; // Los dos extremos de un enlace tienen la misma clave
+};
+
+} // namespace
+
+Emulador::Emulador(const OpcionesEmulador &opciones) : opciones_(opciones) {}
+
+Emulador::~Emulador() {
+  temporizadores_.stop();
+  if (planificador_)
+    planificador_->stop();
+  // Las CLIs primero: detienen los generadores de tráfico que usan los motores
+  for (auto &nodo : nodos_)
+    nodo->cli.reset();
+  nodos_.clear();
+}
+
+bool Emulador::cargar() {
+  auto inicio = std::chrono::steady_clock::now();
+  TopologyFile topologia;
+  if (!topologia.open(opciones_.topologia))
+    return false;
+
+  // 1. Routers y extremos, con los formatos de línea del modo normal (o del
+  //    índice compilado)
+  std::vector<std::string> nombres;
+  std::vector<Extremo> extremos;
+  topologia.for_each([&](const TopologyEntry &e) {
+    std::string clave;
+    if (e.kind == TopologyEntry::Kind::UDP) {
+      // Enlace UDP: los extremos tienen los puertos cruzados
+      clave = "p:" + std::to_string(std::min(e.local_port, e.remote_port)) +
+              "-" + std::to_string(std::max(e.local_port, e.remote_port));
+    } else {
+      clave = "n:" + std::string(e.remote);
+    }
+
+    std::string router(e.router);
+    auto it = por_nombre_.find(router);
+    if (it == por_nombre_.end()) {
+      it = por_nombre_.emplace(router, nombres.size()).first;
+      nombres.push_back(router);
+    }
+    extremos.push_back(
+        {it->second, std::string(e.interface_name), std::move(clave)});
+  });
+  if (nombres.empty()) {
+    std::cerr << "Error: la topología no tiene routers" << std::endl;
+    return false;
+  }
+
+  std::size_t buffers =
+      opciones_.pool_size
+          ? opciones_.pool_size
+          : std::max(PacketPool::DEFAULT_CAPACITY,
+                     nombres.size() * BUFFERS_POR_ROUTER);
+  pool_ = std::make_shared<PacketPool>(buffers, opciones_.huge_pages);
+  std::size_t workers = opciones_.workers
+                            ? opciones_.workers
+                            : std::max(1u, std::thread::hardware_concurrency());
+  planificador_ = std::make_unique<MemScheduler>(workers);
+
+  // 2. Motores con sus enlaces. Todos los enlaces de un motor se agregan
+  // antes de conectar ninguno (los extremos se guardan como punteros).
+  for (const auto &nombre : nombres) {
+    auto nodo = std::make_unique<Nodo>();
+    nodo->net = std::make_unique<NetworkEngine>(nombre, pool_);
+    nodo->net->set_scheduler(planificador_.get());
+    nodos_.push_back(std::move(nodo));
+  }
+  for (const auto &e : extremos)
+    nodos_[e.nodo]->net->add_memory_link(e.interfaz);
+
+  // 3. Conectar los pares
+  std::unordered_map<std::string, const Extremo *> pendientes;
+  std::size_t sueltos = 0;
+  for (const auto &e : extremos) {
+    auto [it, nuevo] = pendientes.emplace(e.clave, &e);
+    if (nuevo)
+      continue;
+    const Extremo *otro = it->second;
+    if (!otro) {
+      std::cerr << "Aviso: enlace con más de dos extremos ("
+                << nombres[e.nodo] << " " << e.interfaz << ")" << std::endl;
+      continue;
+    }
+    if (NetworkEngine::connect_memory_links(*nodos_[otro->nodo]->net,
+                                            otro->interfaz,
+                                            *nodos_[e.nodo]->net, e.interfaz))
+      enlaces_++;
+    it->second = nullptr; // Completo
+  }
+  for (const auto &[clave, e] : pendientes)
+    if (e)
+      sueltos++;
+
+  // 4. Un core por router, igual que en main(): sus interfaces físicas son
+  // las de la topología
+  for (std::size_t i = 0; i < nodos_.size(); ++i) {
+    Nodo &nodo = *nodos_[i];
+    nodo.core = std::make_unique<RouterCore>();
+    RouterCore &core = *nodo.core;
+    core.hostname = nombres[i];
+    for (const auto &nombre : nodo.net->interface_names())
+      core.agregar_interfaz(nombre);
+    core.init_default_state();
+    core.net_engine = nodo.net.get();
+    core.temporizadores = &temporizadores_;
+    core.calculo = &calculo_;
+    for (auto &intf : core.interfaces)
+      nodo.net->bind_ifindex(intf.nombre, intf.ifindex);
+    core.generar_running_config();
+    nodo.net->set_on_receive_burst(
+        [&core](int ifindex, PacketRef *pkts, std::size_t n) {
+          core.handle_incoming_burst(ifindex, pkts, n);
+        });
+  }
+
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - inicio)
+                .count();
+  std::cout << "[Emulador] " << nodos_.size() << " routers, " << enlaces_
+            << " enlaces en memoria";
+  if (sueltos)
+    std::cout << ", " << sueltos << " interfaces sin otro extremo";
+  std::cout << " (" << ms << " ms), " << workers << " workers, "
+            << pool_->capacity() << " buffers" << std::endl;
+  return true;
+}
+
+Emulador::Nodo *Emulador::buscar(const std::string &nombre) {
+  auto it = por_nombre_.find(nombre);
+  return it == por_nombre_.end() ? nullptr : nodos_[it->second].get();
+}
+
+RouterCLI &Emulador::consola(Nodo &nodo) {
+  if (!nodo.cli)
+    nodo.cli = std::make_unique<RouterCLI>(*nodo.core);
+  return *nodo.cli;
+}
+
+std::string Emulador::prompt() const {
+  return conectado_ ? conectado_->cli->prompt() : "emulador>";
+}
+
+void Emulador::run() {
+  planificador_->start();
+  temporizadores_.start();
+  std::cout << "\n=== Emulador: " << nodos_.size() << " routers ===\n"
+            << "Comandos: list [filtro], attach <router>, exec <router> "
+               "<comando>, stats, quit\n"
+            << std::endl;
+
+  std::string linea;
+  while (true) {
+    std::cout << prompt() << " ";
+    if (!std::getline(std::cin, linea))
+      break;
+    if (!ejecutar(linea))
+      break;
+  }
+  temporizadores_.stop();
+  planificador_->stop();
+}
+
+bool Emulador::ejecutar(const std::string &linea) {
+  std::vector<std::string> tokens = ArbolComandos::tokenize(linea);
+
+  // Conectado a un router: todo va a su CLI salvo 'detach'
+  if (conectado_) {
+    if (tokens.size() == 1 && tokens[0] == "detach") {
+      conectado_ = nullptr;
+      return true;
+    }
+    if (!conectado_->cli->ejecutar(linea)) {
+      conectado_->cli->reiniciar_sesion(); // 'exit' sólo desconecta
+      conectado_ = nullptr;
+    }
+    return true;
+  }
+
+  if (tokens.empty())
+    return true;
+  const std::string &comando = tokens[0];
+  if (comando == "quit" || comando == "exit")
+    return false;
+
+  if (comando == "list") {
+    listar(tokens.size() > 1 ? tokens[1] : "");
+  } else if (comando == "stats") {
+    estadisticas();
+  } else if (comando == "attach" || comando == "exec") {
+    if (tokens.size() < 2 || (comando == "exec" && tokens.size() < 3)) {
+      std::cout << "ERROR: Formato: attach <router> | exec <router> <comando>"
+                << std::endl;
+      return true;
+    }
+    Nodo *nodo = buscar(tokens[1]);
+    if (!nodo) {
+      std::cout << "ERROR: Router '" << tokens[1] << "' no encontrado."
+                << std::endl;
+      return true;
+    }
+    RouterCLI &cli = consola(*nodo);
+    if (comando == "attach") {
+      conectado_ = nodo;
+      std::cout << "Conectado a " << tokens[1]
+                << " ('detach' vuelve al emulador)" << std::endl;
+    } else {
+      // El resto de la línea tal cual, en el modo en que esté esa CLI
+      std::size_t pos = linea.find(tokens[1], linea.find("exec") + 4);
+      if (!cli.ejecutar(linea.substr(pos + tokens[1].size())))
+        cli.reiniciar_sesion();
+    }
+  } else {
+    std::cout << "ERROR: Comando no reconocido: " << comando << std::endl;
+  }
+  return true;
+}
+
+void Emulador::listar(const std::string &filtro) {
+  std::printf("%-20s %-6s %-14s %-14s %-14s %-10s\n", "Router", "Intf",
+              "RX", "TX", "Forwarded", "Drops");
+  for (const auto &nodo : nodos_) {
+    const std::string &nombre = nodo->core->hostname;
+    if (!filtro.empty() && nombre.find(filtro) == std::string::npos)
+      continue;
+    const EngineStats &net = nodo->net->stats();
+    const EstadisticasForwarding &fwd = nodo->core->stats_fwd;
+    uint64_t drops = fwd.drop_ttl + fwd.drop_sin_ruta +
+                     fwd.drop_interfaz_caida + fwd.drop_tx +
+                     fwd.drop_sin_buffer + net.rx_no_buffer;
+    std::printf("%-20s %-6zu %-14llu %-14llu %-14llu %-10llu\n",
+                nombre.c_str(), nodo->core->interfaces.size(),
+                static_cast<unsigned long long>(net.rx_packets.load()),
+                static_cast<unsigned long long>(net.tx_packets.load()),
+                static_cast<unsigned long long>(fwd.reenviados.load()),
+                static_cast<unsigned long long>(drops));
+  }
+}
+
+void Emulador::estadisticas() {
+  uint64_t rx = 0, tx = 0, reenviados = 0, sin_lugar = 0;
+  for (const auto &nodo : nodos_) {
+    rx += nodo->net->stats().rx_packets;
+    tx += nodo->net->stats().tx_packets;
+    sin_lugar += nodo->net->stats().rx_no_buffer;
+    reenviados += nodo->core->stats_fwd.reenviados;
+  }
+  std::cout << "Routers: " << nodos_.size() << ", enlaces en memoria: "
+            << enlaces_ << std::endl;
+  std::cout << "Workers: " << planificador_->workers() << ", "
+            << planificador_->runs() << " turnos, "
+            << planificador_->ready() << " routers en espera" << std::endl;
+  std::cout << "Paquetes: " << rx << " recibidos, " << tx << " enviados, "
+            << reenviados << " reenviados, " << sin_lugar
+            << " descartados por bandeja llena" << std::endl;
+  std::cout << "Temporizadores: " << temporizadores_.pendientes()
+            << " pendientes, " << temporizadores_.vencidos() << " vencidos"
+            << std::endl;
+  std::cout << "Packet pool: " << pool_->capacity() << " buffers, "
+            << pool_->in_use() << " in use, " << pool_->stats().high_water
+            << " peak, " << pool_->stats().exhausted << " exhausted"
+            << std::endl;
+}
@@ -0,0 +1,118 @@
+#include "../include/fib.hpp"
+#include <algorithm>
+#include <bit>
+
+uint8_t prefijo_de_mascara(uint32_t mascara) {
+  return static_cast<uint8_t>(std::countl_one(mascara));
+}
+
+// Bit del prefijo que decide la rama después de 'largo' bits
+static inline unsigned bit_en(uint32_t valor, uint8_t largo) {
+  return (valor >> (31 - largo)) & 1u;
+}
+
+FibTrie::FibTrie() { limpiar(); }
+
+void FibTrie::limpiar() {
+  nodos_.clear();
+  nuevo_nodo(0, 0, SIN_VALOR);
+}
+
+uint32_t FibTrie::nuevo_nodo(uint32_t prefijo, uint8_t largo, uint32_t valor) {
+  Nodo nodo;
+  nodo.prefijo = prefijo;
+  nodo.largo = largo;
+  nodo.hijo[0] = NULO;
+  nodo.hijo[1] = NULO;
+  nodo.valor = valor;
+  nodos_.push_back(nodo);
+  return static_cast<uint32_t>(nodos_.size() - 1);
+}
+
+void FibTrie::insertar(uint32_t red, uint8_t largo, uint32_t valor) {
+  if (largo > 32)
+    largo = 32;
+  red &= mascara_de_prefijo(largo);
+
+  // Se trabaja con índices: nuevo_nodo() puede reubicar el vector
+  uint32_t actual = 0;
+  while (true) {
+    if (nodos_[actual].largo == largo) {
+      nodos_[actual].valor = valor;
+      return;
+    }
+
+    unsigned rama = bit_en(red, nodos_[actual].largo);
+    uint32_t hijo = nodos_[actual].hijo[rama];
+
+    // Rama vacía: el prefijo cuelga directamente aquí
+    if (hijo == NULO) {
+      uint32_t hoja = nuevo_nodo(red, largo, valor);
+      nodos_[actual].hijo[rama] = hoja;
+      return;
+    }
+
+    // Bits en común entre el prefijo nuevo y el del hijo
+    const Nodo &h = nodos_[hijo];
+    uint8_t comun = static_cast<uint8_t>(
+        std::min<int>({largo, h.largo, std::countl_zero(red ^ h.prefijo)}));
+
+    // El hijo contiene al prefijo nuevo: descender
+    if (comun == h.largo) {
+      actual = hijo;
+      continue;
+    }
+
+    uint32_t prefijo_hijo = h.prefijo;
+
+    // El prefijo nuevo contiene al hijo: se intercala entre ambos
+    if (comun == largo) {
+      uint32_t medio = nuevo_nodo(red, largo, valor);
+      nodos_[medio].hijo[bit_en(prefijo_hijo, largo)] = hijo;
+      nodos_[actual].hijo[rama] = medio;
+      return;
+    }
+
+    // Divergen: un nodo interno sin valor separa las dos ramas
+    uint32_t interno =
+        nuevo_nodo(red & mascara_de_prefijo(comun), comun, SIN_VALOR);
+    uint32_t hoja = nuevo_nodo(red, largo, valor);
+    nodos_[interno].hijo[bit_en(prefijo_hijo, comun)] = hijo;
+    nodos_[interno].hijo[bit_en(red, comun)] = hoja;
+    nodos_[actual].hijo[rama] = interno;
+    return;
+  }
+}
+
+uint32_t FibTrie::buscar(uint32_t ip) const {
+  uint32_t mejor = SIN_VALOR;
+  uint32_t actual = 0;
+
+  while (actual != NULO) {
+    const Nodo &nodo = nodos_[actual];
+    if ((ip ^ nodo.prefijo) & mascara_de_prefijo(nodo.largo))
+      break; // El prefijo comprimido ya no coincide
+    if (nodo.valor != SIN_VALOR)
+      mejor = nodo.valor;
+    if (nodo.largo == 32)
+      break;
+    actual = nodo.hijo[bit_en(ip, nodo.largo)];
+  }
+  return mejor;
+}
+
+uint32_t FibTrie::buscar_exacto(uint32_t red, uint8_t largo) const {
+  red &= mascara_de_prefijo(largo);
+  uint32_t actual = 0;
+
+  while (actual != NULO) {
+    const Nodo &nodo = nodos_[actual];
+    if (nodo.largo > largo ||
+        ((red ^ nodo.prefijo) & mascara_de_prefijo(nodo.largo)))
+      return SIN_VALOR;
+    if (nodo.largo == largo)
+      return nodo.valor;
+    actual = nodo.hijo[bit_en(red, nodo.largo)];
+  }
+  return SIN_VALOR;
+}
@@ -0,0 +1,217 @@
+#include "../include/lsdb.hpp"
+#include <algorithm>
+
+void CabeceraLSA::leer(const char *p) {
+  edad = leer16(p);
+  opciones = static_cast<uint8_t>(p[2]);
+  tipo = static_cast<uint8_t>(p[3]);
+  id = leer32(p + 4);
+  anunciante = leer32(p + 8);
+  seq = static_cast<int32_t>(leer32(p + 12));
+  checksum = leer16(p + 16);
+  largo = leer16(p + 18);
+}
+
+void CabeceraLSA::escribir(char *p) const {
+  poner16(p, edad);
+  p[2] = static_cast<char>(opciones);
+  p[3] = static_cast<char>(tipo);
+  poner32(p + 4, id);
+  poner32(p + 8, anunciante);
+  poner32(p + 12, static_cast<uint32_t>(seq));
+  poner16(p + 16, checksum);
+  poner16(p + 18, largo);
+}
+
+int comparar_instancias(const CabeceraLSA &a, const CabeceraLSA &b) {
+  if (a.seq != b.seq)
+    return a.seq > b.seq ? 1 : -1;
+  if (a.checksum != b.checksum)
+    return a.checksum > b.checksum ? 1 : -1;
+  bool a_max = a.edad >= LSA_MAX_AGE, b_max = b.edad >= LSA_MAX_AGE;
+  if (a_max != b_max)
+    return a_max ? 1 : -1;
+  int diferencia = int(a.edad) - int(b.edad);
+  if (diferencia > LSA_MAX_AGE_DIFF || -diferencia > LSA_MAX_AGE_DIFF)
+    return diferencia < 0 ? 1 : -1; // La más joven es la más nueva
+  return 0;
+}
+
+namespace {
+
+// Sumas C0 y C1 de Fletcher (módulo 255) desde el byte 2 del LSA
+void sumas_fletcher(const char *lsa, std::size_t largo, int32_t &c0,
+                    int32_t &c1) {
+  c0 = c1 = 0;
+  for (std::size_t i = 2; i < largo; ++i) {
+    c0 = (c0 + static_cast<uint8_t>(lsa[i])) % 255;
+    c1 = (c1 + c0) % 255;
+  }
+}
+
+} // namespace
+
+// ISO 8473, anexo C: los dos bytes se eligen para que C0 y C1 den 0 sobre el
+// LSA con el checksum puesto
+uint16_t poner_checksum(char *lsa, std::size_t largo) {
+  lsa[16] = lsa[17] = 0;
+  int32_t c0, c1;
+  sumas_fletcher(lsa, largo, c0, c1);
+  // Posición (desde 1) del primer byte del checksum dentro de lo sumado
+  int64_t resto = int64_t(largo - 2) - 15;
+  int32_t x = static_cast<int32_t>((resto * c0 - c1) % 255);
+  int32_t y = static_cast<int32_t>((c1 - (resto + 1) * c0) % 255);
+  if (x <= 0)
+    x += 255;
+  if (y <= 0)
+    y += 255;
+  lsa[16] = static_cast<char>(x);
+  lsa[17] = static_cast<char>(y);
+  return static_cast<uint16_t>(x << 8 | y);
+}
+
+bool checksum_valido(const char *lsa, std::size_t largo) {
+  if (largo < LSA_CABECERA || (lsa[16] == 0 && lsa[17] == 0))
+    return false;
+  int32_t c0, c1;
+  sumas_fletcher(lsa, largo, c0, c1);
+  return c0 == 0 && c1 == 0;
+}
+
+// Cuerpo (RFC 2328, A.4.2): flags, cantidad de enlaces y 12 bytes por enlace
+// sin métricas por TOS
+std::vector<char> armar_router_lsa(CabeceraLSA cabecera,
+                                   const std::vector<EnlaceRouter> &enlaces,
+                                   uint8_t bits) {
+  std::vector<char> lsa(LSA_CABECERA + 4 + 12 * enlaces.size());
+  cabecera.tipo = LSA_ROUTER;
+  cabecera.largo = static_cast<uint16_t>(lsa.size());
+  cabecera.checksum = 0;
+  cabecera.escribir(lsa.data());
+
+  char *p = lsa.data() + LSA_CABECERA;
+  p[0] = static_cast<char>(bits);
+  poner16(p + 2, static_cast<uint16_t>(enlaces.size()));
+  p += 4;
+  for (const auto &e : enlaces) {
+    poner32(p, e.id);
+    poner32(p + 4, e.datos);
+    p[8] = static_cast<char>(e.tipo);
+    p[9] = 0;
+    poner16(p + 10, e.metrica);
+    p += 12;
+  }
+  poner_checksum(lsa.data(), lsa.size());
+  return lsa;
+}
+
+bool leer_router_lsa(const char *lsa, std::size_t largo,
+                     std::vector<EnlaceRouter> &enlaces) {
+  enlaces.clear();
+  if (largo < LSA_CABECERA + 4)
+    return false;
+  std::size_t cantidad = leer16(lsa + LSA_CABECERA + 2);
+  const char *p = lsa + LSA_CABECERA + 4;
+  const char *fin = lsa + largo;
+  for (std::size_t i = 0; i < cantidad; ++i) {
+    if (fin - p < 12)
+      return false;
+    EnlaceRouter e;
+    e.id = leer32(p);
+    e.datos = leer32(p + 4);
+    e.tipo = static_cast<uint8_t>(p[8]);
+    e.metrica = leer16(p + 10);
+    p += 12 + 4 * static_cast<uint8_t>(p[9]); // Se saltan las métricas TOS
+    enlaces.push_back(e);
+  }
+  return true;
+}
+
+// Cuerpo (RFC 2328, A.4.4): máscara y una métrica de 24 bits para TOS 0
+std::vector<char> armar_summary_lsa(CabeceraLSA cabecera, uint32_t mascara,
+                                    uint32_t metrica) {
+  std::vector<char> lsa(LSA_CABECERA + 8);
+  cabecera.tipo = LSA_SUMMARY_RED;
+  cabecera.largo = static_cast<uint16_t>(lsa.size());
+  cabecera.checksum = 0;
+  cabecera.escribir(lsa.data());
+
+  char *p = lsa.data() + LSA_CABECERA;
+  poner32(p, mascara);
+  poner32(p + 4, std::min(metrica, LSA_INFINITO)); // El primer byte es el TOS
+  poner_checksum(lsa.data(), lsa.size());
+  return lsa;
+}
+
+bool leer_summary_lsa(const char *lsa, std::size_t largo, uint32_t &mascara,
+                      uint32_t &metrica) {
+  if (largo < LSA_CABECERA + 8)
+    return false;
+  mascara = leer32(lsa + LSA_CABECERA);
+  metrica = leer32(lsa + LSA_CABECERA + 4) & LSA_INFINITO;
+  return true;
+}
+
+uint16_t LSA::edad(std::chrono::steady_clock::time_point ahora) const {
+  auto transcurrido =
+      std::chrono::duration_cast<std::chrono::seconds>(ahora - instalado);
+  int64_t total = int64_t(cabecera.edad) + transcurrido.count();
+  return static_cast<uint16_t>(std::min<int64_t>(total, LSA_MAX_AGE));
+}
+
+CabeceraLSA
+LSA::cabecera_actual(std::chrono::steady_clock::time_point ahora) const {
+  CabeceraLSA c = cabecera;
+  c.edad = edad(ahora);
+  return c;
+}
+
+const LSA *LSDB::buscar(const ClaveLSA &clave) const {
+  auto it = lsas_.find(clave);
+  return it == lsas_.end() ? nullptr : &it->second;
+}
+
+bool LSDB::instalar(std::vector<char> datos,
+                    std::chrono::steady_clock::time_point ahora) {
+  LSA nuevo;
+  nuevo.cabecera.leer(datos.data());
+  nuevo.datos = std::move(datos);
+  nuevo.instalado = ahora;
+
+  auto [it, insertado] = lsas_.try_emplace(nuevo.cabecera.clave());
+  LSA &actual = it->second;
+  bool cambio =
+      insertado || actual.max_age(ahora) != nuevo.max_age(ahora) ||
+      actual.datos.size() != nuevo.datos.size() ||
+      !std::equal(actual.datos.begin() + LSA_CABECERA, actual.datos.end(),
+                  nuevo.datos.begin() + LSA_CABECERA);
+  actual = std::move(nuevo);
+  return cambio;
+}
+
+void LSDB::quitar(const ClaveLSA &clave) { lsas_.erase(clave); }
+
+std::vector<ClaveLSA> LSDB::vencer(std::chrono::steady_clock::time_point ahora) {
+  std::vector<ClaveLSA> vencidos;
+  for (auto &[clave, lsa] : lsas_) {
+    if (lsa.cabecera.edad >= LSA_MAX_AGE || !lsa.max_age(ahora))
+      continue;
+    lsa.cabecera.edad = LSA_MAX_AGE;
+    lsa.instalado = ahora;
+    poner16(lsa.datos.data(), LSA_MAX_AGE);
+    vencidos.push_back(clave);
+  }
+  return vencidos;
+}
+
+void LSDB::para_cada(const Visitor &visit) const {
+  for (const auto &[clave, lsa] : lsas_)
+    visit(lsa);
+}
+
+uint32_t LSDB::suma_checksums() const {
+  uint32_t suma = 0;
+  for (const auto &[clave, lsa] : lsas_)
+    suma += lsa.cabecera.checksum;
+  return suma;
+}
@@ -1,42 +1,174 @@
+#include "../include/emulator.hpp"
 #include "../include/network_engine.hpp"
+#include "../include/pipeline.hpp"
 #include "../include/router_cli.hpp"
 #include "../include/router_core.hpp"
+#include "../include/timer_wheel.hpp"
+#include "../include/topology.hpp"
+#include "../include/worker_pool.hpp"
+#include <cstdlib>
 #include <iostream>
 
+// Toda la topología en este proceso, con enlaces en memoria
+int emular(int argc, char *argv[]) {
+  OpcionesEmulador opciones;
+  opciones.topologia = argv[2];
+  for (int i = 3; i < argc; ++i) {
+    std::string opcion = argv[i];
+    if (opcion == "--workers" && i + 1 < argc) {
+      opciones.workers = std::strtoul(argv[++i], nullptr, 10);
+    } else if (opcion == "--pool-size" && i + 1 < argc) {
+      opciones.pool_size = std::strtoul(argv[++i], nullptr, 10);
+    } else if (opcion == "--hugepages") {
+      opciones.huge_pages = true;
+    } else {
+      std::cerr << "Opción desconocida: " << opcion << std::endl;
+      return 1;
+    }
+  }
+
+  Emulador emulador(opciones);
+  if (!emulador.cargar())
+    return 1;
+  emulador.run();
+  return 0;
+}
+
+// Índice binario de una topología de texto, para que cada router encuentre
+// sus líneas sin recorrer el archivo entero
+int compilar_topologia(const std::string &origen, const std::string &destino) {
+  if (!TopologyFile::compile(origen, destino))
+    return 1;
+  TopologyFile indice;
+  if (!indice.open(destino))
+    return 1;
+  std::size_t entradas = indice.for_each([](const TopologyEntry &) {});
+  std::cout << "Índice de topología escrito en " << destino << ": "
+            << entradas << " interfaces, " << indice.size() << " bytes"
+            << std::endl;
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
   if (argc < 3) {
-    std::cout << "Uso: " << argv[0] << " <NOMBRE_ROUTER> <ARCHIVO_TOPOLOGIA>"
+    std::cout << "Uso: " << argv[0]
+              << " <NOMBRE_ROUTER> <ARCHIVO_TOPOLOGIA> [--rx-burst N] [--reactor N] [--pool-size N] [--hugepages] [--workers N] [--backend sockets|uring]"
+              << std::endl;
+    std::cout << "     " << argv[0]
+              << " --emulate <ARCHIVO_TOPOLOGIA> [--workers N] [--pool-size N] [--hugepages]"
               << std::endl;
+    std::cout << "     " << argv[0]
+              << " --compile-topology <ARCHIVO_TOPOLOGIA> <INDICE>" << std::endl;
     std::cout << "Ejemplo: ./router Router1 topology.txt" << std::endl;
     return 1;
   }
+  if (std::string(argv[1]) == "--emulate")
+    return emular(argc, argv);
+  if (std::string(argv[1]) == "--compile-topology") {
+    if (argc < 4) {
+      std::cerr << "Uso: " << argv[0]
+                << " --compile-topology <ARCHIVO_TOPOLOGIA> <INDICE>"
+                << std::endl;
+      return 1;
+    }
+    return compilar_topologia(argv[2], argv[3]);
+  }
 
   std::string router_name = argv[1];
   std::string topology_file = argv[2];
 
-  // Crear el core del router
-  RouterCore core;
-  core.hostname = router_name; // Sincronizar nombre
-  core.init_default_state();
-  core.generar_running_config();
+  // Opciones del motor de red
+  std::size_t rx_burst = NetworkEngine::DEFAULT_RX_BURST;
+  std::size_t reactor_threads = 0; // 0 = un hilo por interfaz
+  std::size_t pool_size = PacketPool::DEFAULT_CAPACITY;
+  bool huge_pages = false;
+  std::size_t workers = 0; // 0 = forwarding en los hilos de recepción
+  IoBackend backend = IoBackend::SOCKETS;
+  for (int i = 3; i < argc; ++i) {
+    std::string opcion = argv[i];
+    if (opcion == "--rx-burst" && i + 1 < argc) {
+      rx_burst = std::strtoul(argv[++i], nullptr, 10);
+    } else if (opcion == "--reactor" && i + 1 < argc) {
+      reactor_threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (opcion == "--pool-size" && i + 1 < argc) {
+      pool_size = std::strtoul(argv[++i], nullptr, 10);
+    } else if (opcion == "--hugepages") {
+      huge_pages = true;
+    } else if (opcion == "--workers" && i + 1 < argc) {
+      workers = std::strtoul(argv[++i], nullptr, 10);
+    } else if (opcion == "--backend" && i + 1 < argc) {
+      std::string valor = argv[++i];
+      if (valor == "uring") {
+        backend = IoBackend::URING;
+      } else if (valor != "sockets") {
+        std::cerr << "Backend desconocido: " << valor << std::endl;
+        return 1;
+      }
+    } else {
+      std::cerr << "Opción desconocida: " << opcion << std::endl;
+      return 1;
+    }
+  }
 
   // Inicializar Motor de Red
   NetworkEngine net(router_name);
+  net.set_rx_burst(rx_burst);
+  net.set_backend(backend);
+  if (pool_size != PacketPool::DEFAULT_CAPACITY || huge_pages)
+    net.set_packet_pool(std::make_shared<PacketPool>(pool_size, huge_pages));
+  if (reactor_threads > 0)
+    net.set_rx_mode(RxMode::REACTOR, reactor_threads);
   if (!net.load_topology(topology_file)) {
     std::cerr << "Advertencia: No se cargó ninguna interfaz de red para este "
                  "router desde "
               << topology_file << std::endl;
   }
 
+  // Temporizadores de los protocolos y pool para el SPF por área (antes que
+  // el core, que los usa hasta destruirse)
+  TimerWheel temporizadores;
+  WorkerPool calculo;
+
+  // Crear el core del router. Sus interfaces físicas son las de la topología,
+  // en el mismo orden; sin topología queda el chasis por defecto.
+  RouterCore core;
+  core.hostname = router_name; // Sincronizar nombre
+  for (const auto &nombre : net.interface_names())
+    core.agregar_interfaz(nombre);
+  core.init_default_state();
+
   // Vincular Core con Red
   core.net_engine = &net;
-  net.set_on_receive(
-      [&core](const std::string &iface, const SimulatedPacket &pkt) {
-        core.handle_incoming_packet(iface, pkt);
-      });
+  core.temporizadores = &temporizadores;
+  core.calculo = &calculo;
+  for (auto &intf : core.interfaces) {
+    net.bind_ifindex(intf.nombre, intf.ifindex);
+    std::size_t colas = net.rx_queues(intf.nombre);
+    if (colas > 1)
+      intf.colas_rx = colas;
+  }
+  core.generar_running_config();
+
+  // Con workers los hilos RX sólo encolan; el forwarding corre en el pipeline
+  std::unique_ptr<ForwardingPipeline> pipeline;
+  if (workers > 0) {
+    pipeline = std::make_unique<ForwardingPipeline>(core, net, workers);
+    core.pipeline = pipeline.get();
+    net.set_on_receive_burst(
+        [&pipeline](int ifindex, PacketRef *pkts, std::size_t n) {
+          pipeline->encolar(ifindex, pkts, n);
+        });
+    pipeline->start();
+  } else {
+    net.set_on_receive_burst([&core](int ifindex, PacketRef *pkts,
+                                     std::size_t n) {
+      core.handle_incoming_burst(ifindex, pkts, n);
+    });
+  }
 
   // Iniciar recepción
   net.start();
+  temporizadores.start();
 
   // Crear la CLI asociada al core
   RouterCLI cli(core);
@@ -45,7 +177,10 @@ int main(int argc, char *argv[]) {
   cli.run();
 
   // Detener red antes de salir
+  temporizadores.stop();
   net.stop();
+  if (pipeline)
+    pipeline->stop();
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "../include/mem_link.hpp"
+#include "../include/network_engine.hpp"
+#include <algorithm>
+
+MemScheduler::MemScheduler(std::size_t workers)
+    : workers_(std::max<std::size_t>(1, workers)) {}
+
+MemScheduler::~MemScheduler() { stop(); }
+
+void MemScheduler::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_)
+    return;
+  running_ = true;
+  for (std::size_t i = 0; i < workers_; ++i)
+    threads_.emplace_back(&MemScheduler::worker_loop, this);
+}
+
+void MemScheduler::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_)
+    if (thread.joinable())
+      thread.join();
+  threads_.clear();
+}
+
+void MemScheduler::schedule(NetworkEngine *engine) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.push_back(engine);
+  }
+  cv_.notify_one();
+}
+
+std::size_t MemScheduler::ready() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ready_.size();
+}
+
+void MemScheduler::worker_loop() {
+  for (;;) {
+    NetworkEngine *engine;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return !running_ || !ready_.empty(); });
+      if (!running_)
+        return;
+      engine = ready_.front();
+      ready_.pop_front();
+    }
+    runs_.fetch_add(1, std::memory_order_relaxed);
+
+    // Sigue programado: vuelve al final de la fila
+    if (engine->process_inbox())
+      schedule(engine);
+  }
+}
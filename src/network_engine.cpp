@@ -1,130 +1,1194 @@
 #include "../include/network_engine.hpp"
 #include "../include/router_core.hpp"
+#include "../include/shm_link.hpp"
+#include "../include/topology.hpp"
+#include "../include/uring.hpp"
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <cstring>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <fcntl.h>
+#include <poll.h>
+#ifdef __linux__
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
-NetworkEngine::NetworkEngine(const std::string& router_name) : router_name_(router_name) {}
+/**
+ * Buffers de una ráfaga de recepción. Cabecera y payload de cada datagrama se
+ * reciben directamente en su destino final (iovec de dos entradas): el payload
+ * va a un buffer del pool que luego se entrega al core sin copiarse.
+ */
+struct RxBatch {
+    std::size_t burst;
+    PacketPool& pool;
+    std::vector<PacketRef> refs;
+    std::vector<WireHeader> headers;
+    std::vector<struct iovec> iov;
+    std::vector<struct sockaddr_in> senders;
+    std::vector<std::size_t> lengths;
+#ifdef __linux__
+    std::vector<struct mmsghdr> msgs;
+#else
+    std::vector<struct msghdr> msgs;
+#endif
+    char scratch[PACKET_MAX_PAYLOAD]; // Destino de descarte si el pool se agota
+
+    RxBatch(std::size_t n, PacketPool& p)
+        : burst(n), pool(p), refs(n), headers(n), iov(2 * n), senders(n), lengths(n), msgs(n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            iov[2 * i].iov_base = &headers[i];
+            iov[2 * i].iov_len = sizeof(WireHeader);
+            iov[2 * i + 1].iov_len = PACKET_MAX_PAYLOAD;
+        }
+    }
+
+    // Asegurar un buffer en cada posición. Los que el core se quedó (refs > 1)
+    // se sueltan y se reemplazan; los demás se reutilizan. Devuelve cuántas
+    // posiciones consecutivas tienen buffer.
+    std::size_t refill() {
+        std::size_t ready = 0;
+        for (; ready < burst; ++ready) {
+            if (refs[ready] && !refs[ready].unique()) refs[ready].reset();
+            if (!refs[ready]) {
+                refs[ready] = pool.alloc();
+                if (!refs[ready]) break;
+            }
+            iov[2 * ready + 1].iov_base = refs[ready]->payload;
+        }
+        return ready;
+    }
+};
+
+/**
+ * Estado de recepción con io_uring: un anillo con los sockets registrados y
+ * una recepción multishot por socket que toma buffers del anillo provisto.
+ */
+struct UringRx {
+    static constexpr uint64_t WAKE_TAG = UINT64_MAX; // Completación de parada
+    static constexpr uint64_t CANCEL_TAG = UINT64_MAX - 1;
+
+    Uring ring;
+    std::vector<InterfaceLink*> links; // Índice de archivo registrado -> enlace
+    int wake_fd = -1;                  // eventfd para detener el hilo
+
+    // El kernel libera el anillo en segundo plano; cancelar las recepciones y
+    // soltar los sockets registrados aquí evita que el puerto siga ocupado un
+    // momento después de cerrar (un start() inmediato fallaría en bind)
+    ~UringRx() {
+        if (ring.valid() && ring.prep_cancel_all(CANCEL_TAG)) {
+            Uring::Completion c[64];
+            bool cancelled = false;
+            for (int tries = 0; !cancelled && tries < 64; ++tries) {
+                if (ring.submit(1) < 0 && errno != EINTR) break;
+                unsigned n;
+                while ((n = ring.reap(c, 64)) > 0) {
+                    for (unsigned i = 0; i < n; ++i) cancelled |= c[i].user_data == CANCEL_TAG;
+                }
+            }
+        }
+        ring.unregister_files();
+        if (wake_fd >= 0) close(wake_fd);
+    }
+};
+
+namespace {
+
+// Anillo de envío propio de cada hilo que transmite con io_uring. La
+// generación va en los 32 bits altos de user_data: una completación de otro
+// lote nunca se toma por una de este.
+struct UringTx {
+    std::unique_ptr<Uring> ring;
+    bool tried = false;
+    uint32_t generacion = 0;
+
+    // Anillo nuevo; el anterior se cierra con lo que tuviera en curso
+    void reiniciar() {
+        ring = std::make_unique<Uring>();
+        if (!ring->init(NetworkEngine::MAX_TX_BURST, 2 * NetworkEngine::MAX_TX_BURST)) ring.reset();
+    }
+};
+
+thread_local UringTx uring_tx;
+
+} // namespace
+
+NetworkEngine::NetworkEngine(const std::string& router_name, std::shared_ptr<PacketPool> pool)
+    : router_name_(router_name), pool_(pool ? std::move(pool) : std::make_shared<PacketPool>()) {}
 
 NetworkEngine::~NetworkEngine() {
     stop();
+    for (auto& link : links_) {
+        close_queues(link);
+        if (link.socket_fd >= 0) {
+            close(link.socket_fd);
+            link.socket_fd = -1;
+        }
+    }
 }
 
-bool NetworkEngine::load_topology(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir el archivo de topología: " << filename << std::endl;
-        return false;
+int NetworkEngine::open_socket(int local_port, bool reuse_port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("Error creando socket");
+        return -1;
+    }
+
+    if (reuse_port) {
+        int one = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+            perror("Error en SO_REUSEPORT");
+            close(fd);
+            return -1;
+        }
+    }
+
+    // Configurar puerto local (Bind)
+    struct sockaddr_in loc_addr;
+    std::memset(&loc_addr, 0, sizeof(loc_addr));
+    loc_addr.sin_family = AF_INET;
+    loc_addr.sin_addr.s_addr = INADDR_ANY;
+    loc_addr.sin_port = htons(local_port);
+
+    if (bind(fd, (struct sockaddr*)&loc_addr, sizeof(loc_addr)) < 0) {
+        perror("Error en bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Una interfaz repetida en la topología reemplaza a la anterior
+void NetworkEngine::add_link(InterfaceLink link) {
+    InterfaceLink* previous = find_link(link.interface_name);
+    if (!previous) {
+        by_name_[link.interface_name] = links_.size();
+        links_.push_back(std::move(link));
+        return;
     }
+    close_queues(*previous);
+    if (previous->socket_fd >= 0) close(previous->socket_fd);
+    link.ifindex = previous->ifindex;
+    *previous = std::move(link);
+}
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
+bool NetworkEngine::add_memory_link(const std::string& interface_name) {
+    InterfaceLink link;
+    link.interface_name = RouterCore::expandir_nombre_interfaz(interface_name);
+    link.local_port = 0;
+    link.remote_port = 0;
+    link.socket_fd = -1;
+    std::memset(&link.remote_addr, 0, sizeof(link.remote_addr));
+    link.memory = true;
+    add_link(std::move(link));
+    return true;
+}
 
-        std::stringstream ss(line);
-        std::string r_name, if_name, rem_ip;
-        int loc_port, rem_port;
+bool NetworkEngine::connect_memory_links(NetworkEngine& a, const std::string& if_a,
+                                         NetworkEngine& b, const std::string& if_b) {
+    InterfaceLink* la = a.find_link(RouterCore::expandir_nombre_interfaz(if_a));
+    InterfaceLink* lb = b.find_link(RouterCore::expandir_nombre_interfaz(if_b));
+    if (!la || !lb || !la->memory || !lb->memory || la == lb) return false;
+    la->peer = &b;
+    la->peer_link = lb;
+    lb->peer = &a;
+    lb->peer_link = la;
+    return true;
+}
 
-        // Formato: [Router] [Interface] [LocalPort] [RemoteIP] [RemotePort]
-        if (!(ss >> r_name >> if_name >> loc_port >> rem_ip >> rem_port)) continue;
+bool NetworkEngine::load_topology(const std::string& filename) {
+    // Archivo mapeado: de las líneas de otros routers sólo se mira el primer
+    // campo, y con un índice compilado ni siquiera se recorren
+    TopologyFile topology;
+    if (!topology.open(filename)) return false;
+
+    topology.find(router_name_, [this](const TopologyEntry& entry) {
+        std::string expanded_name = RouterCore::expandir_nombre_interfaz(std::string(entry.interface_name));
+
+        if (entry.kind == TopologyEntry::Kind::SHM) {
+            std::string shm_name(entry.remote);
+            auto shm = std::make_shared<ShmLink>();
+            if (!shm->open(shm_name)) return;
+
+            InterfaceLink link;
+            link.interface_name = expanded_name;
+            link.local_port = 0;
+            link.remote_port = 0;
+            link.socket_fd = -1;
+            std::memset(&link.remote_addr, 0, sizeof(link.remote_addr));
+            link.shm = shm;
+            add_link(std::move(link));
+            std::cout << "[NetworkEngine] Interfaz " << expanded_name << " lista en memoria compartida "
+                      << shm_name << " (extremo " << shm->side() << ")" << std::endl;
+            return;
+        }
+        // Los enlaces 'mem' sólo existen dentro del emulador
+        if (entry.kind != TopologyEntry::Kind::UDP) return;
 
-        // Solo cargar si la línea corresponde a este router
-        if (r_name != router_name_) continue;
+        int loc_port = entry.local_port;
+        int rem_port = entry.remote_port;
+        std::size_t queues = std::clamp<std::size_t>(entry.rx_queues, 1, MAX_RX_QUEUES);
 
-        std::string expanded_name = RouterCore::expandir_nombre_interfaz(if_name);
         InterfaceLink link;
         link.interface_name = expanded_name;
         link.local_port = loc_port;
-        link.remote_ip = rem_ip;
+        link.remote_ip = std::string(entry.remote);
         link.remote_port = rem_port;
+        link.rx_queues = queues;
 
-        // Crear socket UDP
-        link.socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
-        if (link.socket_fd < 0) {
-            perror("Error creando socket");
-            continue;
-        }
-
-        // Configurar puerto local (Bind)
-        struct sockaddr_in loc_addr;
-        std::memset(&loc_addr, 0, sizeof(loc_addr));
-        loc_addr.sin_family = AF_INET;
-        loc_addr.sin_addr.s_addr = INADDR_ANY;
-        loc_addr.sin_port = htons(loc_port);
-
-        if (bind(link.socket_fd, (struct sockaddr*)&loc_addr, sizeof(loc_addr)) < 0) {
-            perror("Error en bind");
-            close(link.socket_fd);
-            continue;
-        }
+        // Crear socket UDP (con SO_REUSEPORT si la interfaz tiene varias colas)
+        link.socket_fd = open_socket(loc_port, queues > 1);
+        if (link.socket_fd < 0) return;
 
         // Configurar dirección remota para envíos rápidos
         std::memset(&link.remote_addr, 0, sizeof(link.remote_addr));
         link.remote_addr.sin_family = AF_INET;
         link.remote_addr.sin_port = htons(rem_port);
-        inet_pton(AF_INET, rem_ip.c_str(), &link.remote_addr.sin_addr);
+        inet_pton(AF_INET, link.remote_ip.c_str(), &link.remote_addr.sin_addr);
 
-        links_[expanded_name] = link;
-        std::cout << "[NetworkEngine] Interfaz " << expanded_name << " lista en puerto " << loc_port << " -> " << rem_ip << ":" << rem_port << std::endl;
-    }
+        if (queues > 1 && !open_queues(link)) link.rx_queues = 1;
+
+        std::size_t rx_queues = link.rx_queues;
+        std::string rem_ip = link.remote_ip;
+        add_link(std::move(link));
+        std::cout << "[NetworkEngine] Interfaz " << expanded_name << " lista en puerto " << loc_port << " -> " << rem_ip << ":" << rem_port;
+        if (rx_queues > 1) std::cout << " (" << rx_queues << " colas)";
+        std::cout << std::endl;
+    });
 
     return !links_.empty();
 }
 
 void NetworkEngine::start() {
+    if (running_) return;
     running_ = true;
-    for (auto& pair : links_) {
-        rx_threads_.emplace_back(&NetworkEngine::rx_loop, this, std::ref(pair.second));
+
+    // Los enlaces por memoria compartida siempre tienen su propio hilo
+    for (auto& link : links_) {
+        if (link.shm) rx_threads_.emplace_back(&NetworkEngine::shm_loop, this, std::ref(link));
+    }
+
+    // Con io_uring un solo hilo atiende todos los sockets, incluidas las colas
+    if (backend_ == IoBackend::URING) {
+        if (setup_uring()) {
+            rx_threads_.emplace_back(&NetworkEngine::uring_loop, this);
+            return;
+        }
+        std::cerr << "[NetworkEngine] io_uring no disponible; se usan sockets" << std::endl;
+        backend_ = IoBackend::SOCKETS;
+    }
+
+    // Las interfaces con varias colas tienen un hilo fijado por socket
+    if (pipe(queue_wake_) < 0) {
+        perror("Error creando pipe de colas");
+        queue_wake_[0] = queue_wake_[1] = -1;
+    }
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    unsigned next_cpu = 0;
+    for (auto& link : links_) {
+        if (link.shm || link.memory || link.rx_queues <= 1 || queue_wake_[0] < 0) continue;
+        rx_threads_.emplace_back(&NetworkEngine::queue_loop, this, std::ref(link), link.socket_fd, next_cpu++ % cpus);
+        for (int fd : link.queue_fds) {
+            rx_threads_.emplace_back(&NetworkEngine::queue_loop, this, std::ref(link), fd, next_cpu++ % cpus);
+        }
+    }
+
+    if (rx_mode_ == RxMode::REACTOR && setup_reactors()) {
+        for (auto& reactor : reactors_) {
+            rx_threads_.emplace_back(&NetworkEngine::reactor_loop, this, std::ref(reactor));
+        }
+        return;
+    }
+
+    rx_mode_ = RxMode::THREAD_PER_LINK;
+    for (auto& link : links_) {
+        if (link.shm || link.memory || link.rx_queues > 1) continue;
+        rx_threads_.emplace_back(&NetworkEngine::rx_loop, this, std::ref(link));
     }
 }
 
 void NetworkEngine::stop() {
+    if (!running_ && rx_threads_.empty()) return;
     running_ = false;
-    for (auto& pair : links_) {
-        if (pair.second.socket_fd >= 0) {
-            close(pair.second.socket_fd);
+
+    if (queue_wake_[1] >= 0) {
+        char one = 1;
+        (void)!write(queue_wake_[1], &one, 1);
+    }
+    for (auto& link : links_) {
+        if (link.shm) link.shm->wake();
+    }
+    if (uring_rx_) {
+        uint64_t one = 1;
+        (void)!write(uring_rx_->wake_fd, &one, sizeof(one));
+    } else if (rx_mode_ == RxMode::REACTOR) {
+        wake_reactors();
+    } else {
+        // Despertar a los hilos bloqueados en recvmmsg con un datagrama vacío
+        // dirigido a su propio puerto (close() no interrumpe la llamada en Linux)
+        for (auto& link : links_) {
+            if (link.socket_fd >= 0 && link.rx_queues <= 1) {
+                struct sockaddr_in self;
+                std::memset(&self, 0, sizeof(self));
+                self.sin_family = AF_INET;
+                self.sin_port = htons(link.local_port);
+                self.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                sendto(link.socket_fd, "", 0, 0, (struct sockaddr*)&self, sizeof(self));
+            }
         }
     }
     for (auto& thread : rx_threads_) {
         if (thread.joinable()) thread.join();
     }
     rx_threads_.clear();
+    uring_rx_.reset();
+    close_reactors();
+    for (int& fd : queue_wake_) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+}
+
+bool NetworkEngine::open_queues(InterfaceLink& link) {
+    for (std::size_t q = 1; q < link.rx_queues; ++q) {
+        int fd = open_socket(link.local_port, true);
+        if (fd < 0) {
+            close_queues(link);
+            return false;
+        }
+        link.queue_fds.push_back(fd);
+    }
+
+#ifdef __linux__
+    // Repartir por el par (src_ip, dst_ip) de la cabecera ROUT, como haría RSS
+    // en una NIC. El programa ve el datagrama desde el inicio del payload UDP.
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(WireHeader, src_ip)),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(WireHeader, dst_ip)),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(link.rx_queues)),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    if (setsockopt(link.socket_fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+        // Sin el filtro el kernel reparte por 4-tupla, que también conserva el orden
+        perror("Aviso: SO_ATTACH_REUSEPORT_CBPF");
+    }
+#endif
+    return true;
+}
+
+void NetworkEngine::close_queues(InterfaceLink& link) {
+    for (int fd : link.queue_fds) close(fd);
+    link.queue_fds.clear();
+}
+
+bool NetworkEngine::set_rx_queues(const std::string& interface_name, std::size_t queues) {
+    InterfaceLink* found = find_link(interface_name);
+    if (!found) return false;
+    queues = std::clamp<std::size_t>(queues, 1, MAX_RX_QUEUES);
+
+    InterfaceLink& link = *found;
+    if (link.shm) return queues == 1; // Un enlace shm tiene una sola cola
+    if (link.memory) return queues == 1; // Ni uno en memoria: una sola bandeja
+    if (link.rx_queues == queues) return true;
+
+    bool was_running = running_;
+    stop();
+
+    // Todos los sockets del grupo deben tener SO_REUSEPORT antes del bind, así
+    // que la cola 0 se vuelve a crear
+    close_queues(link);
+    close(link.socket_fd);
+    link.socket_fd = open_socket(link.local_port, queues > 1);
+    link.rx_queues = queues;
+    bool ok = link.socket_fd >= 0;
+    if (ok && queues > 1 && !open_queues(link)) {
+        link.rx_queues = 1;
+        ok = false;
+    }
+
+    if (was_running) start();
+    return ok;
+}
+
+std::size_t NetworkEngine::rx_queues(const std::string& interface_name) const {
+    auto it = by_name_.find(interface_name);
+    return it == by_name_.end() ? 0 : links_[it->second].rx_queues;
+}
+
+InterfaceLink* NetworkEngine::find_link(const std::string& interface_name) {
+    auto it = by_name_.find(interface_name);
+    return it == by_name_.end() ? nullptr : &links_[it->second];
+}
+
+std::vector<std::string> NetworkEngine::interface_names() const {
+    std::vector<std::string> names;
+    names.reserve(links_.size());
+    for (const auto& link : links_) names.push_back(link.interface_name);
+    return names;
+}
+
+InterfaceLink* NetworkEngine::link(int ifindex) {
+    if (ifindex < 0 || static_cast<std::size_t>(ifindex) >= by_ifindex_.size()) return nullptr;
+    int pos = by_ifindex_[ifindex];
+    return pos < 0 ? nullptr : &links_[pos];
+}
+
+bool NetworkEngine::bind_ifindex(const std::string& interface_name, int ifindex) {
+    InterfaceLink* found = find_link(interface_name);
+    if (!found || ifindex < 0) return false;
+    if (static_cast<std::size_t>(ifindex) >= by_ifindex_.size()) by_ifindex_.resize(ifindex + 1, -1);
+    found->ifindex = ifindex;
+    by_ifindex_[ifindex] = static_cast<int>(found - links_.data());
+    return true;
+}
+
+void NetworkEngine::queue_loop(InterfaceLink& link, int fd, unsigned cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu; // Sin afinidad de hilos en esta plataforma
+#endif
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    RxBatch batch(rx_burst_, *pool_);
+    struct pollfd fds[2];
+    fds[0].fd = queue_wake_[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = fd;
+    fds[1].events = POLLIN;
+
+    while (running_) {
+        int n = poll(fds, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break; // Parada solicitada
+        if (fds[1].revents & POLLIN) {
+            while (running_ && receive_burst(link, fd, batch, false) == static_cast<int>(batch.burst)) {}
+        }
+    }
 }
 
-bool NetworkEngine::send_packet(const std::string& interface_name, const SimulatedPacket& packet) {
-    if (links_.find(interface_name) == links_.end()) return false;
+bool NetworkEngine::send_packet(int ifindex, const SimulatedPacket& packet) {
+    InterfaceLink* found = link(ifindex);
+    if (!found) return false;
+    if (packet.payload_len > PACKET_MAX_PAYLOAD) return false;
+
+    InterfaceLink& link = *found;
+    if (link.memory) {
+        PacketRef ref = pool_->clone(packet);
+        if (!ref) {
+            stats_.tx_errors++;
+            return false;
+        }
+        return send_memory(link, &ref, 1) == 1;
+    }
+    if (link.shm) {
+        const SimulatedPacket* ptr = &packet;
+        bool ok = link.shm->send(&ptr, 1) == 1;
+        if (ok) stats_.tx_packets++;
+        else stats_.tx_errors++;
+        return ok;
+    }
 
-    InterfaceLink& link = links_[interface_name];
-    ssize_t sent = sendto(link.socket_fd, &packet, sizeof(packet), 0,
-                          (struct sockaddr*)&link.remote_addr, sizeof(link.remote_addr));
-    
-    return sent == sizeof(packet);
+    // Sólo cabecera + payload_len bytes van al cable (sin copiar el payload)
+    WireHeader hdr;
+    codificar_cabecera(packet, hdr);
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = const_cast<char*>(packet.payload);
+    iov[1].iov_len = packet.payload_len;
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &link.remote_addr;
+    msg.msg_namelen = sizeof(link.remote_addr);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    ssize_t sent = sendmsg(link.socket_fd, &msg, 0);
+    stats_.tx_syscalls++;
+    if (sent != static_cast<ssize_t>(packet.wire_size())) {
+        stats_.tx_errors++;
+        return false;
+    }
+    stats_.tx_packets++;
+    return true;
+}
+
+thread_local TxBatch* NetworkEngine::tx_batch_ = nullptr;
+
+bool NetworkEngine::queue_packet(int ifindex, PacketRef packet) {
+    InterfaceLink* link = this->link(ifindex);
+    if (!link || !packet) return false;
+    if (packet->payload_len > PACKET_MAX_PAYLOAD) return false;
+
+    TxBatch* batch = tx_batch_;
+    if (!batch || &batch->engine_ != this) {
+        if (link->memory) return send_memory(*link, &packet, 1) == 1;
+        return send_burst(*link, &packet, 1) == 1;
+    }
+
+    auto per = std::find_if(batch->links_.begin(), batch->links_.end(),
+                            [link](const TxBatch::PerLink& p) { return p.link == link; });
+    if (per == batch->links_.end()) {
+        batch->links_.push_back({link, {}});
+        per = batch->links_.end() - 1;
+        per->packets.reserve(MAX_TX_BURST);
+    }
+    per->packets.push_back(std::move(packet));
+    batch->pending_++;
+
+    // Un lote lleno sale sin esperar al flush()
+    if (per->packets.size() >= MAX_TX_BURST) {
+        if (link->memory) send_memory(*link, per->packets.data(), per->packets.size());
+        else send_burst(*link, per->packets.data(), per->packets.size());
+        batch->pending_ -= per->packets.size();
+        per->packets.clear();
+    }
+    return true;
+}
+
+std::size_t NetworkEngine::send_burst(InterfaceLink& link, const PacketRef* packets, std::size_t count) {
+    std::size_t sent = 0;
+    if (link.memory) {
+        // Quien llama conserva sus descriptores: el otro extremo recibe copias
+        std::vector<PacketRef> copies(packets, packets + count);
+        return send_memory(link, copies.data(), count);
+    }
+    if (link.shm) {
+        // Los paquetes se escriben directo en el segmento, sin llamadas al sistema
+        const SimulatedPacket* ptrs[MAX_TX_BURST];
+        for (std::size_t pos = 0; pos < count; pos += MAX_TX_BURST) {
+            std::size_t n = std::min(count - pos, MAX_TX_BURST);
+            for (std::size_t i = 0; i < n; ++i) ptrs[i] = &*packets[pos + i];
+            std::size_t done = link.shm->send(ptrs, n);
+            sent += done;
+            stats_.tx_errors += n - done;
+        }
+        stats_.tx_packets += sent;
+        return sent;
+    }
+    if (backend_ == IoBackend::URING) {
+        InterfaceLink* links[MAX_TX_BURST];
+        const PacketRef* ptrs[MAX_TX_BURST];
+        bool ok = true;
+        for (std::size_t pos = 0; ok && pos < count; pos += MAX_TX_BURST) {
+            std::size_t n = std::min(count - pos, MAX_TX_BURST);
+            for (std::size_t i = 0; i < n; ++i) {
+                links[i] = &link;
+                ptrs[i] = &packets[pos + i];
+            }
+            std::size_t done = 0;
+            ok = uring_send(links, ptrs, n, done);
+            sent += done;
+        }
+        if (ok) return sent;
+        sent = 0; // Sin anillo en este hilo: se usa sendmmsg
+    }
+
+    std::size_t pos = 0;
+    while (pos < count) {
+        std::size_t n = std::min(count - pos, MAX_TX_BURST);
+        WireHeader headers[MAX_TX_BURST];
+        struct iovec iov[2 * MAX_TX_BURST];
+        for (std::size_t i = 0; i < n; ++i) {
+            const SimulatedPacket& packet = *packets[pos + i];
+            codificar_cabecera(packet, headers[i]);
+            iov[2 * i].iov_base = &headers[i];
+            iov[2 * i].iov_len = sizeof(WireHeader);
+            iov[2 * i + 1].iov_base = const_cast<char*>(packet.payload);
+            iov[2 * i + 1].iov_len = packet.payload_len;
+        }
+
+        std::size_t done = 0;
+#ifdef __linux__
+        struct mmsghdr msgs[MAX_TX_BURST];
+        std::memset(msgs, 0, n * sizeof(msgs[0]));
+        for (std::size_t i = 0; i < n; ++i) {
+            msgs[i].msg_hdr.msg_name = &link.remote_addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(link.remote_addr);
+            msgs[i].msg_hdr.msg_iov = &iov[2 * i];
+            msgs[i].msg_hdr.msg_iovlen = 2;
+        }
+        int rc = sendmmsg(link.socket_fd, msgs, n, 0);
+        stats_.tx_syscalls++;
+        done = rc < 0 ? 0 : static_cast<std::size_t>(rc);
+#else
+        for (; done < n; ++done) {
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_name = &link.remote_addr;
+            msg.msg_namelen = sizeof(link.remote_addr);
+            msg.msg_iov = &iov[2 * done];
+            msg.msg_iovlen = 2;
+            stats_.tx_syscalls++;
+            if (sendmsg(link.socket_fd, &msg, 0) < 0) break;
+        }
+#endif
+        stats_.tx_packets += done;
+        sent += done;
+        pos += done;
+        if (done < n) {
+            // El mensaje que falló se descarta y se sigue con el resto
+            stats_.tx_errors++;
+            pos++;
+        }
+    }
+    return sent;
+}
+
+bool NetworkEngine::uring_send(InterfaceLink* const* links, const PacketRef* const* packets,
+                               std::size_t count, std::size_t& sent) {
+    sent = 0;
+    if (!uring_tx.tried) {
+        uring_tx.tried = true;
+        uring_tx.reiniciar();
+    }
+    if (!uring_tx.ring) return false;
+    Uring& ring = *uring_tx.ring;
+    uint64_t generacion = uint64_t(++uring_tx.generacion) << 32;
+    if (count > MAX_TX_BURST) count = MAX_TX_BURST;
+
+    WireHeader headers[MAX_TX_BURST];
+    struct iovec iov[2 * MAX_TX_BURST];
+    struct msghdr msgs[MAX_TX_BURST];
+    std::size_t queued = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const SimulatedPacket& packet = **packets[i];
+        codificar_cabecera(packet, headers[i]);
+        iov[2 * i].iov_base = &headers[i];
+        iov[2 * i].iov_len = sizeof(WireHeader);
+        iov[2 * i + 1].iov_base = const_cast<char*>(packet.payload);
+        iov[2 * i + 1].iov_len = packet.payload_len;
+        std::memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_name = &links[i]->remote_addr;
+        msgs[i].msg_namelen = sizeof(links[i]->remote_addr);
+        msgs[i].msg_iov = &iov[2 * i];
+        msgs[i].msg_iovlen = 2;
+        if (!ring.prep_sendmsg(links[i]->socket_fd, &msgs[i], generacion | i)) break;
+        queued++;
+    }
+
+    // Una sola entrada al kernel envía todo el lote y espera sus resultados.
+    // Los msghdr y las cabeceras viven en la pila: no se sale con SQEs del
+    // lote en la cola o en curso. Si el kernel no las acepta, el anillo se
+    // descarta con ellas y el próximo envío usa uno nuevo.
+    std::size_t completed = 0;
+    Uring::Completion done[MAX_TX_BURST];
+    while (completed < queued) {
+        int rc = ring.submit(static_cast<unsigned>(queued - completed));
+        stats_.tx_syscalls++;
+        if (rc < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            uring_tx.reiniciar();
+            break;
+        }
+        unsigned n = ring.reap(done, MAX_TX_BURST);
+        for (unsigned i = 0; i < n; ++i) {
+            if ((done[i].user_data & ~uint64_t(UINT32_MAX)) != generacion) continue; // De otro lote
+            std::size_t idx = done[i].user_data & UINT32_MAX;
+            if (done[i].res == static_cast<int32_t>((*packets[idx])->wire_size())) sent++;
+            else stats_.tx_errors++;
+            completed++;
+        }
+    }
+    stats_.tx_packets += sent;
+    stats_.tx_errors += count - completed; // Sin completar o sin lugar en la cola
+    return true;
+}
+
+bool NetworkEngine::setup_uring() {
+    auto rx = std::make_unique<UringRx>();
+    std::vector<int> fds;
+    for (auto& link : links_) {
+        if (link.shm || link.memory) continue; // Tienen su propio hilo o no reciben de un socket
+        fds.push_back(link.socket_fd);
+        rx->links.push_back(&link);
+        for (int fd : link.queue_fds) {
+            fds.push_back(fd);
+            rx->links.push_back(&link);
+        }
+    }
+    if (fds.empty()) return false;
+
+    // La cola de completaciones es amplia para absorber ráfagas multishot
+    if (!rx->ring.init(256, 4096)) return false;
+    if (!rx->ring.register_files(fds.data(), static_cast<unsigned>(fds.size()))) return false;
+    if (!rx->ring.setup_buffers(0, URING_BUFFERS, sizeof(WireHeader) + PACKET_MAX_PAYLOAD)) return false;
+
+#ifdef __linux__
+    rx->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+    if (rx->wake_fd < 0) return false;
+
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        if (!rx->ring.prep_recv_multishot(static_cast<unsigned>(i), 0, i)) return false;
+    }
+    if (!rx->ring.prep_poll(rx->wake_fd, UringRx::WAKE_TAG)) return false;
+    if (rx->ring.submit() < 0) return false;
+
+    uring_rx_ = std::move(rx);
+    return true;
+}
+
+void NetworkEngine::uring_loop() {
+    constexpr unsigned MAX_CQES = 256;
+    UringRx& rx = *uring_rx_;
+    Uring::Completion cqes[MAX_CQES];
+    std::vector<std::vector<PacketRef>> pending(rx.links.size());
+    for (auto& p : pending) p.reserve(rx_burst_);
+
+    auto flush = [&](std::size_t idx) {
+        if (pending[idx].empty()) return;
+        deliver_burst(rx.links[idx]->ifindex, pending[idx].data(), pending[idx].size());
+        pending[idx].clear(); // Lo que el core no conservó vuelve al pool
+    };
+
+    while (running_) {
+        // Publicar re-armados y buffers devueltos y esperar al menos un evento
+        int rc = rx.ring.submit(1);
+        stats_.rx_syscalls++;
+        if (rc < 0 && errno != EINTR) {
+            perror("io_uring_enter");
+            break;
+        }
+
+        unsigned n;
+        while ((n = rx.ring.reap(cqes, MAX_CQES)) > 0) {
+            for (unsigned i = 0; i < n; ++i) {
+                const Uring::Completion& c = cqes[i];
+                if (c.user_data == UringRx::WAKE_TAG) return; // Parada solicitada
+                std::size_t idx = static_cast<std::size_t>(c.user_data);
+
+                if (c.has_buffer()) {
+                    uint16_t id = c.buffer_id();
+                    const char* data = rx.ring.buffer(id);
+                    std::size_t len = c.res > 0 ? static_cast<std::size_t>(c.res) : 0;
+                    WireHeader hdr;
+                    std::memcpy(&hdr, data, std::min(len, sizeof(hdr)));
+
+                    PacketRef ref = pool_->alloc();
+                    if (!ref) {
+                        stats_.rx_no_buffer++;
+                    } else if (len < sizeof(hdr) || len > rx.ring.buffer_size() || !decodificar_cabecera(hdr, len, *ref)) {
+                        stats_.rx_invalid++;
+                    } else {
+                        // Única copia: del buffer del anillo al buffer del pool
+                        std::memcpy(ref->payload, data + sizeof(hdr), ref->payload_len);
+                        pending[idx].push_back(std::move(ref));
+                        if (pending[idx].size() >= rx_burst_) flush(idx);
+                    }
+                    rx.ring.recycle_buffer(id);
+                }
+
+                // La recepción multishot terminó (p. ej. sin buffers): re-armar
+                if (!c.more()) {
+                    if (c.res == -EINVAL || c.res == -EOPNOTSUPP) {
+                        std::cerr << "[NetworkEngine] io_uring: recepción multishot no soportada en "
+                                  << rx.links[idx]->interface_name << std::endl;
+                        continue;
+                    }
+                    rx.ring.prep_recv_multishot(static_cast<unsigned>(idx), 0, idx);
+                }
+            }
+            rx.ring.commit_buffers();
+        }
+
+        for (std::size_t idx = 0; idx < pending.size(); ++idx) flush(idx);
+    }
+}
+
+TxBatch::TxBatch(NetworkEngine& engine) : engine_(engine), previous_(NetworkEngine::tx_batch_) {
+    NetworkEngine::tx_batch_ = this;
+}
+
+TxBatch::~TxBatch() {
+    flush();
+    NetworkEngine::tx_batch_ = previous_;
+}
+
+std::size_t TxBatch::flush() {
+    std::size_t sent = 0;
+
+    // Con io_uring todas las interfaces salen juntas en una sola llamada
+    if (engine_.backend_ == IoBackend::URING && pending_ > 0) {
+        std::vector<InterfaceLink*> links;
+        std::vector<const PacketRef*> packets;
+        for (auto& per : links_) {
+            if (per.link->shm || per.link->memory) continue; // Salen más abajo
+            for (const auto& packet : per.packets) {
+                links.push_back(per.link);
+                packets.push_back(&packet);
+            }
+        }
+        bool ok = true;
+        for (std::size_t pos = 0; ok && pos < packets.size(); pos += NetworkEngine::MAX_TX_BURST) {
+            std::size_t n = std::min(packets.size() - pos, NetworkEngine::MAX_TX_BURST);
+            std::size_t done = 0;
+            ok = engine_.uring_send(&links[pos], &packets[pos], n, done);
+            sent += done;
+        }
+        if (ok) {
+            for (auto& per : links_) {
+                if (per.link->memory) sent += engine_.send_memory(*per.link, per.packets.data(), per.packets.size());
+                else if (per.link->shm) sent += engine_.send_burst(*per.link, per.packets.data(), per.packets.size());
+                per.packets.clear();
+            }
+            pending_ = 0;
+            return sent;
+        }
+        sent = 0;
+    }
+
+    for (auto& per : links_) {
+        if (per.packets.empty()) continue;
+        if (per.link->memory) sent += engine_.send_memory(*per.link, per.packets.data(), per.packets.size());
+        else sent += engine_.send_burst(*per.link, per.packets.data(), per.packets.size());
+        per.packets.clear(); // Los buffers vuelven al pool
+    }
+    pending_ = 0;
+    return sent;
+}
+
+std::size_t NetworkEngine::send_memory(InterfaceLink& link, PacketRef* packets, std::size_t count) {
+    if (!link.peer || !link.peer_link) {
+        stats_.tx_errors += count; // Extremo sin conectar
+        return 0;
+    }
+    // Como en UDP, lo que no entra en la bandeja del receptor se pierde allá
+    link.peer->enqueue_inbox(*link.peer_link, packets, count);
+    stats_.tx_packets += count;
+    return count;
+}
+
+std::size_t NetworkEngine::enqueue_inbox(InterfaceLink& link, PacketRef* packets, std::size_t count) {
+    std::size_t accepted;
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(inbox_.mutex);
+        accepted = std::min(count, MemInbox::CAPACITY - std::min(MemInbox::CAPACITY, inbox_.entries.size()));
+        for (std::size_t i = 0; i < accepted; ++i) inbox_.entries.push_back({&link, std::move(packets[i])});
+        if (accepted > 0 && !inbox_.scheduled && scheduler_) {
+            inbox_.scheduled = true;
+            schedule = true;
+        }
+    }
+    if (accepted < count) stats_.rx_no_buffer += count - accepted;
+    if (schedule) scheduler_->schedule(this);
+    return accepted;
+}
+
+bool NetworkEngine::process_inbox() {
+    {
+        std::lock_guard<std::mutex> lock(inbox_.mutex);
+        inbox_work_.swap(inbox_.entries);
+    }
+
+    // Los paquetes reenviados salen agrupados por enlace al final
+    {
+        TxBatch tx(*this);
+        std::size_t pos = 0;
+        while (pos < inbox_work_.size()) {
+            InterfaceLink* link = inbox_work_[pos].link;
+            inbox_burst_.clear();
+            while (pos < inbox_work_.size() && inbox_work_[pos].link == link && inbox_burst_.size() < rx_burst_) {
+                inbox_burst_.push_back(std::move(inbox_work_[pos].packet));
+                pos++;
+            }
+            if (link->ifindex >= 0) deliver_burst(link->ifindex, inbox_burst_.data(), inbox_burst_.size());
+            else stats_.rx_invalid += inbox_burst_.size(); // Interfaz sin asociar al router
+        }
+        inbox_burst_.clear(); // Lo que el core no conservó vuelve al pool
+        inbox_work_.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(inbox_.mutex);
+    if (!inbox_.entries.empty()) return true;
+    inbox_.scheduled = false;
+    return false;
 }
 
 void NetworkEngine::set_on_receive(PacketCallback callback) {
     on_receive_ = callback;
 }
 
+void NetworkEngine::set_on_receive_burst(BurstCallback callback) {
+    on_receive_burst_ = callback;
+}
+
+void NetworkEngine::set_rx_burst(std::size_t burst) {
+    if (burst < 1) burst = 1;
+    if (burst > MAX_RX_BURST) burst = MAX_RX_BURST;
+    rx_burst_ = burst;
+}
+
+void NetworkEngine::deliver_burst(int ifindex, PacketRef* packets, std::size_t count) {
+    if (count == 0) return;
+    stats_.rx_packets += count;
+    stats_.rx_bursts++;
+
+    if (on_receive_burst_) {
+        on_receive_burst_(ifindex, packets, count);
+    } else if (on_receive_) {
+        for (std::size_t i = 0; i < count; ++i) on_receive_(ifindex, *packets[i]);
+    }
+}
+
+void NetworkEngine::set_packet_pool(std::shared_ptr<PacketPool> pool) {
+    if (running_ || !pool) return;
+    pool_ = std::move(pool);
+}
+
+void NetworkEngine::set_rx_mode(RxMode mode, std::size_t reactor_threads) {
+    rx_mode_ = mode;
+    reactor_threads_ = reactor_threads < 1 ? 1 : reactor_threads;
+}
+
+void NetworkEngine::shm_loop(InterfaceLink& link) {
+    std::vector<PacketRef> refs(rx_burst_);
+    while (running_) {
+        std::size_t invalid = 0, no_buffer = 0;
+        std::size_t n = link.shm->receive(*pool_, refs.data(), refs.size(), invalid, no_buffer);
+        stats_.rx_invalid += invalid;
+        stats_.rx_no_buffer += no_buffer;
+        if (n == 0 && invalid == 0 && no_buffer == 0) {
+            link.shm->wait(running_);
+            stats_.rx_syscalls++;
+            continue;
+        }
+        deliver_burst(link.ifindex, refs.data(), n);
+        for (std::size_t i = 0; i < n; ++i) refs[i].reset();
+    }
+}
+
 void NetworkEngine::rx_loop(InterfaceLink& link) {
-    SimulatedPacket packet;
-    struct sockaddr_in sender_addr;
-    socklen_t addr_len = sizeof(sender_addr);
+    RxBatch batch(rx_burst_, *pool_);
+    while (running_) {
+        if (receive_burst(link, link.socket_fd, batch, true) < 0) break; // El socket se cerró o hubo error
+    }
+}
+
+int NetworkEngine::receive_burst(InterfaceLink& link, int fd, RxBatch& batch, bool wait) {
+    std::size_t received = 0;
+    std::size_t slots = batch.refill();
+
+    if (slots == 0) {
+        // Pool agotado: leer un datagrama a un buffer de descarte para no
+        // dejar el socket lleno y contabilizar la pérdida
+        struct iovec drop[2] = {{&batch.headers[0], sizeof(WireHeader)},
+                                {batch.scratch, sizeof(batch.scratch)}};
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = drop;
+        msg.msg_iovlen = 2;
+        ssize_t rec = recvmsg(fd, &msg, wait ? 0 : MSG_DONTWAIT);
+        stats_.rx_syscalls++;
+        if (rec < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        stats_.rx_no_buffer++;
+        return running_ ? 1 : -1;
+    }
+
+#ifdef __linux__
+    for (std::size_t i = 0; i < slots; ++i) {
+        std::memset(&batch.msgs[i], 0, sizeof(batch.msgs[i]));
+        batch.msgs[i].msg_hdr.msg_name = &batch.senders[i];
+        batch.msgs[i].msg_hdr.msg_namelen = sizeof(batch.senders[i]);
+        batch.msgs[i].msg_hdr.msg_iov = &batch.iov[2 * i];
+        batch.msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+    // En modo bloqueante espera el primer datagrama y luego toma todo lo que
+    // ya esté en cola, hasta 'burst', en una sola llamada
+    int rec = recvmmsg(fd, batch.msgs.data(), slots,
+                       wait ? MSG_WAITFORONE : MSG_DONTWAIT, nullptr);
+    stats_.rx_syscalls++;
+    if (rec < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return -1;
+    }
+    received = static_cast<std::size_t>(rec);
+    for (std::size_t i = 0; i < received; ++i) batch.lengths[i] = batch.msgs[i].msg_len;
+#else
+    // Sin recvmmsg: el primero puede bloquear y el resto se toma sin esperar
+    for (std::size_t i = 0; i < slots; ++i) {
+        std::memset(&batch.msgs[i], 0, sizeof(batch.msgs[i]));
+        batch.msgs[i].msg_name = &batch.senders[i];
+        batch.msgs[i].msg_namelen = sizeof(batch.senders[i]);
+        batch.msgs[i].msg_iov = &batch.iov[2 * i];
+        batch.msgs[i].msg_iovlen = 2;
+        ssize_t rec = recvmsg(fd, &batch.msgs[i], (wait && i == 0) ? 0 : MSG_DONTWAIT);
+        stats_.rx_syscalls++;
+        if (rec < 0) break;
+        batch.lengths[i] = static_cast<std::size_t>(rec);
+        received++;
+    }
+    if (received == 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return -1;
+    }
+#endif
+    if (!running_) return -1;
 
+    // Validar cada datagrama y compactar los válidos al inicio del arreglo
+    std::size_t valid = 0;
+    for (std::size_t i = 0; i < received; ++i) {
+#ifdef __linux__
+        bool truncated = batch.msgs[i].msg_hdr.msg_flags & MSG_TRUNC;
+#else
+        bool truncated = batch.msgs[i].msg_flags & MSG_TRUNC;
+#endif
+        if (truncated || !decodificar_cabecera(batch.headers[i], batch.lengths[i], *batch.refs[i])) {
+            stats_.rx_invalid++;
+            continue;
+        }
+        if (valid != i) std::swap(batch.refs[valid], batch.refs[i]); // Sólo descriptores
+        valid++;
+    }
+
+    deliver_burst(link.ifindex, batch.refs.data(), valid);
+    return static_cast<int>(received);
+}
+
+bool NetworkEngine::setup_reactors() {
+    // Las interfaces con varias colas ya tienen sus propios hilos
+    std::size_t single = 0;
+    for (const auto& link : links_) {
+        if (!link.shm && !link.memory && link.rx_queues <= 1) single++;
+    }
+    if (single == 0) return true;
+
+    std::size_t count = std::min(reactor_threads_, single);
+    reactors_.assign(count, Reactor());
+
+    for (auto& reactor : reactors_) {
+#ifdef __linux__
+        reactor.poll_fd = epoll_create1(EPOLL_CLOEXEC);
+        reactor.wake_fd[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (reactor.poll_fd < 0 || reactor.wake_fd[0] < 0) {
+            perror("Error creando reactor");
+            close_reactors();
+            return false;
+        }
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr; // nullptr identifica al eventfd de parada
+        epoll_ctl(reactor.poll_fd, EPOLL_CTL_ADD, reactor.wake_fd[0], &ev);
+#else
+        if (pipe(reactor.wake_fd) < 0) {
+            perror("Error creando reactor");
+            close_reactors();
+            return false;
+        }
+        fcntl(reactor.wake_fd[0], F_SETFL, O_NONBLOCK);
+        fcntl(reactor.wake_fd[1], F_SETFL, O_NONBLOCK);
+#endif
+    }
+
+    // Repartir los enlaces entre los reactores
+    std::size_t next = 0;
+    for (auto& link : links_) {
+        if (link.shm || link.memory || link.rx_queues > 1) continue;
+        Reactor& reactor = reactors_[next++ % reactors_.size()];
+        fcntl(link.socket_fd, F_SETFL, fcntl(link.socket_fd, F_GETFL) | O_NONBLOCK);
+        reactor.links.push_back(&link);
+#ifdef __linux__
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = &link;
+        epoll_ctl(reactor.poll_fd, EPOLL_CTL_ADD, link.socket_fd, &ev);
+#endif
+    }
+    return true;
+}
+
+void NetworkEngine::wake_reactors() {
+    for (auto& reactor : reactors_) {
+#ifdef __linux__
+        uint64_t one = 1;
+        if (reactor.wake_fd[0] >= 0) (void)!write(reactor.wake_fd[0], &one, sizeof(one));
+#else
+        char one = 1;
+        if (reactor.wake_fd[1] >= 0) (void)!write(reactor.wake_fd[1], &one, 1);
+#endif
+    }
+}
+
+void NetworkEngine::close_reactors() {
+    for (auto& reactor : reactors_) {
+        if (reactor.poll_fd >= 0) close(reactor.poll_fd);
+        if (reactor.wake_fd[0] >= 0) close(reactor.wake_fd[0]);
+        if (reactor.wake_fd[1] >= 0) close(reactor.wake_fd[1]);
+    }
+    reactors_.clear();
+}
+
+void NetworkEngine::reactor_loop(Reactor& reactor) {
+    // Máximo de ráfagas seguidas por socket antes de atender a los demás
+    constexpr int MAX_BURSTS_PER_EVENT = 16;
+    RxBatch batch(rx_burst_, *pool_);
+
+    auto drain = [&](InterfaceLink& link) {
+        for (int i = 0; i < MAX_BURSTS_PER_EVENT && running_; ++i) {
+            int rec = receive_burst(link, link.socket_fd, batch, false);
+            if (rec < static_cast<int>(batch.burst)) break; // Socket vacío
+        }
+    };
+
+#ifdef __linux__
+    constexpr int MAX_EVENTS = 64;
+    struct epoll_event events[MAX_EVENTS];
     while (running_) {
-        ssize_t rec = recvfrom(link.socket_fd, &packet, sizeof(packet), 0,
-                               (struct sockaddr*)&sender_addr, &addr_len);
-        
-        if (rec > 0 && on_receive_) {
-            // Verificar integridad básica
-            if (std::memcmp(packet.header_id, "ROUT", 4) == 0) {
-                on_receive_(link.interface_name, packet);
-            }
-        } else if (rec < 0 && running_) {
-            // El socket se cerró o hubo error
+        int n = epoll_wait(reactor.poll_fd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n && running_; ++i) {
+            if (events[i].data.ptr == nullptr) return; // Parada solicitada
+            drain(*static_cast<InterfaceLink*>(events[i].data.ptr));
+        }
+    }
+#else
+    std::vector<struct pollfd> fds(reactor.links.size() + 1);
+    fds[0].fd = reactor.wake_fd[0];
+    fds[0].events = POLLIN;
+    for (std::size_t i = 0; i < reactor.links.size(); ++i) {
+        fds[i + 1].fd = reactor.links[i]->socket_fd;
+        fds[i + 1].events = POLLIN;
+    }
+    while (running_) {
+        int n = poll(fds.data(), fds.size(), -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
             break;
         }
+        if (fds[0].revents) return; // Parada solicitada
+        for (std::size_t i = 1; i < fds.size() && running_; ++i) {
+            if (fds[i].revents & POLLIN) drain(*reactor.links[i - 1]);
+        }
     }
+#endif
 }
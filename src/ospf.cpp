@@ -0,0 +1,1755 @@
+#include "../include/ospf.hpp"
+#include "../include/network_engine.hpp"
+#include "../include/router_core.hpp"
+#include "../include/worker_pool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+namespace {
+
+// Formato de los paquetes (RFC 2328, apéndice A), en orden de red
+constexpr uint8_t OSPF_VERSION = 2;
+constexpr std::size_t CABECERA = 24;
+constexpr std::size_t HELLO_FIJO = 20; // Sin la lista de vecinos
+constexpr std::size_t DD_FIJO = 8;     // Sin las cabeceras de LSA
+
+constexpr std::size_t MAX_CUERPO = PACKET_MAX_PAYLOAD - CABECERA;
+// Un LSA tiene que caber solo en un LSU (detrás del contador de LSAs)
+constexpr std::size_t MAX_LSA = MAX_CUERPO - 4;
+constexpr std::size_t LSR_ENTRADA = 12; // Tipo, Link State ID y anunciante
+
+constexpr uint8_t TIPO_HELLO = 1;
+constexpr uint8_t TIPO_DD = 2;
+constexpr uint8_t TIPO_LSR = 3;
+constexpr uint8_t TIPO_LSU = 4;
+constexpr uint8_t TIPO_ACK = 5;
+
+constexpr uint8_t OPCION_E = 0x02; // Acepta LSAs externos
+constexpr uint8_t DD_I = 0x04;     // Primer paquete del intercambio
+constexpr uint8_t DD_M = 0x02;     // Siguen más paquetes
+constexpr uint8_t DD_MS = 0x01;    // El emisor es el maestro
+
+constexpr uint8_t PRIORIDAD = 1;
+
+// Cada cuánto se buscan LSAs que llegaron a MaxAge, y cuánto se espera para
+// volver a instalar las rutas si la CLI tenía el core tomado
+constexpr auto ENVEJECIMIENTO = std::chrono::seconds(60);
+constexpr auto REINTENTO_INSTALACION = std::chrono::milliseconds(100);
+
+// Mínimo entre dos LSUs de inundación y entre dos retransmisiones por la
+// misma interfaz (los valores de 'timers pacing' de IOS)
+constexpr auto RITMO_INUNDACION = std::chrono::milliseconds(33);
+constexpr auto RITMO_RETRANSMISION = std::chrono::milliseconds(66);
+
+// Checksum de Internet (RFC 1071) de todo el paquete salvo el campo de
+// autenticación. Sobre un paquete con su checksum puesto da 0.
+uint16_t checksum(const char *datos, std::size_t largo) {
+  uint32_t suma = 0;
+  auto sumar = [&](std::size_t desde, std::size_t hasta) {
+    for (std::size_t i = desde; i + 1 < hasta; i += 2)
+      suma += leer16(datos + i);
+    if ((hasta - desde) % 2)
+      suma += static_cast<uint8_t>(datos[hasta - 1]) << 8;
+  };
+  sumar(0, 16);
+  sumar(CABECERA, largo);
+  while (suma >> 16)
+    suma = (suma & 0xFFFF) + (suma >> 16);
+  return static_cast<uint16_t>(~suma);
+}
+
+std::chrono::milliseconds segundos(uint32_t s) {
+  return std::chrono::milliseconds(uint64_t(s) * 1000);
+}
+
+std::chrono::steady_clock::time_point ahora() {
+  return std::chrono::steady_clock::now();
+}
+
+} // namespace
+
+const char *nombre_estado(EstadoVecino estado) {
+  switch (estado) {
+  case EstadoVecino::DOWN:
+    return "DOWN";
+  case EstadoVecino::ATTEMPT:
+    return "ATTEMPT";
+  case EstadoVecino::INIT:
+    return "INIT";
+  case EstadoVecino::TWO_WAY:
+    return "2WAY";
+  case EstadoVecino::EXSTART:
+    return "EXSTART";
+  case EstadoVecino::EXCHANGE:
+    return "EXCHANGE";
+  case EstadoVecino::LOADING:
+    return "LOADING";
+  case EstadoVecino::FULL:
+    return "FULL";
+  }
+  return "?";
+}
+
+ProcesoOSPF::ProcesoOSPF(RouterCore &core, TimerWheel &temporizadores)
+    : core_(core), temporizadores_(temporizadores),
+      aleatorio_(std::random_device{}()) {}
+
+// Ningún callback puede quedar corriendo ni pendiente: los que esperan el
+// mutex ven 'detenido_' y salen sin programar otros
+ProcesoOSPF::~ProcesoOSPF() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    detenido_ = true;
+  }
+  temporizadores_.cancelar_todos(this);
+}
+
+uint32_t ProcesoOSPF::router_id() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return router_id_;
+}
+
+ProcesoOSPF::Interfaz *ProcesoOSPF::buscar_interfaz(int ifindex) {
+  if (ifindex < 0 || static_cast<std::size_t>(ifindex) >= por_ifindex_.size())
+    return nullptr;
+  int pos = por_ifindex_[ifindex];
+  return pos < 0 ? nullptr : &interfaces_[pos];
+}
+
+// El motor entrega los paquetes con el ifindex del enlace físico; sobre un
+// mismo enlace puede haber subinterfaces, que se distinguen por la subred
+ProcesoOSPF::Interfaz *ProcesoOSPF::interfaz_de_paquete(int enlace,
+                                                         uint32_t origen) {
+  Interfaz *directa = buscar_interfaz(enlace);
+  if (directa &&
+      (directa->config.ip & directa->config.mascara) ==
+          (origen & directa->config.mascara))
+    return directa;
+  for (auto &intf : interfaces_) {
+    if (intf.config.enlace == enlace &&
+        (intf.config.ip & intf.config.mascara) ==
+            (origen & intf.config.mascara))
+      return &intf;
+  }
+  return directa; // Punto a punto: la máscara no tiene por qué coincidir
+}
+
+ProcesoOSPF::Vecino *ProcesoOSPF::buscar_vecino(Interfaz &intf,
+                                                uint32_t router_id) {
+  for (auto &v : intf.vecinos)
+    if (v.router_id == router_id)
+      return &v;
+  return nullptr;
+}
+
+void ProcesoOSPF::reindexar() {
+  por_ifindex_.clear();
+  for (std::size_t i = 0; i < interfaces_.size(); ++i) {
+    int ifindex = interfaces_[i].config.ifindex;
+    if (ifindex < 0)
+      continue;
+    if (static_cast<std::size_t>(ifindex) >= por_ifindex_.size())
+      por_ifindex_.resize(ifindex + 1, -1);
+    por_ifindex_[ifindex] = static_cast<int>(i);
+  }
+}
+
+void ProcesoOSPF::configurar(const std::string &proceso, uint32_t router_id,
+                             std::vector<ConfigInterfazOSPF> configs,
+                             const ThrottleSPF &throttle,
+                             std::vector<RangoArea> rangos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  proceso_ = proceso;
+  // Un SPF ya programado conserva su momento; los valores nuevos rigen desde
+  // el próximo cambio
+  throttle_ = throttle;
+  espera_actual_ms_ = std::clamp(espera_actual_ms_, throttle_.espera,
+                                 std::max(throttle_.espera, throttle_.maximo));
+
+  // Con otro router-id todas las adyacencias y la base de datos empiezan de
+  // cero, y las rutas calculadas con el anterior se retiran
+  bool reiniciar = router_id != router_id_;
+  if (reiniciar) {
+    for (auto &intf : interfaces_)
+      bajar_interfaz(intf);
+    router_id_ = router_id;
+    areas_.clear();
+    for (TimerWheel::Id *t : {&originacion_, &refresco_, &envejecimiento_}) {
+      if (*t)
+        temporizadores_.cancelar(*t);
+      *t = 0;
+    }
+    ultima_originacion_ = {};
+    rutas_.clear();
+    rutas_pendientes_ = false;
+    programar_instalacion(std::chrono::milliseconds(0));
+  }
+
+  std::vector<Interfaz> nuevas;
+  std::vector<bool> levantar;
+  nuevas.reserve(configs.size());
+  for (auto &config : configs) {
+    Interfaz *actual = buscar_interfaz(config.ifindex);
+    // El costo sólo cambia el router-LSA: no hace falta tirar la adyacencia
+    ConfigInterfazOSPF comparable = config;
+    if (actual)
+      comparable.costo = actual->config.costo;
+    if (actual && !reiniciar && actual->config == comparable) {
+      actual->config.costo = config.costo;
+      nuevas.push_back(std::move(*actual));
+      levantar.push_back(false);
+    } else {
+      if (actual)
+        bajar_interfaz(*actual);
+      Interfaz intf;
+      intf.config = std::move(config);
+      nuevas.push_back(std::move(intf));
+      levantar.push_back(true);
+    }
+    if (actual)
+      actual->config.ifindex = -1; // Ya se usó
+  }
+  for (auto &intf : interfaces_)
+    if (intf.config.ifindex >= 0)
+      bajar_interfaz(intf); // Ya no la cubre ningún 'network'
+
+  interfaces_ = std::move(nuevas);
+  reindexar();
+
+  // Un área por cada una que tenga interfaces. La base de un área que se va
+  // se descarta; sus rutas y los summary-LSAs que generaba se retiran con el
+  // próximo SPF.
+  std::set<uint32_t> ids;
+  for (const auto &intf : interfaces_)
+    ids.insert(intf.config.area);
+  bool cambio_areas = rangos != rangos_;
+  rangos_ = std::move(rangos);
+  for (auto it = areas_.begin(); it != areas_.end();) {
+    if (ids.count(it->first)) {
+      ++it;
+      continue;
+    }
+    it = areas_.erase(it);
+    cambio_areas = true;
+  }
+  for (uint32_t id : ids) {
+    auto [it, nueva] = areas_.try_emplace(id);
+    if (!nueva)
+      continue;
+    it->second.id = id;
+    it->second.spf.reiniciar(router_id_);
+    cambio_areas = true;
+  }
+
+  for (std::size_t i = 0; i < interfaces_.size(); ++i)
+    if (levantar[i])
+      levantar_interfaz(interfaces_[i]);
+
+  // Si las interfaces no cambiaron, el router-LSA sale igual y no se anuncia
+  programar_originacion();
+  programar_envejecimiento();
+  if (cambio_areas && router_id_ != 0) {
+    rutas_pendientes_ = true;
+    programar_spf();
+  }
+}
+
+// ------- Interfaces --------
+
+void ProcesoOSPF::levantar_interfaz(Interfaz &intf) {
+  if (router_id_ == 0 || intf.config.pasiva || intf.config.loopback)
+    return;
+  // El primer hello sale enseguida, con un desfase al azar para que muchos
+  // routers arrancando juntos no transmitan en el mismo tick
+  std::uniform_int_distribution<int> desfase(0, 200);
+  programar_hello(intf, std::chrono::milliseconds(desfase(aleatorio_)));
+}
+
+void ProcesoOSPF::bajar_interfaz(Interfaz &intf) {
+  for (TimerWheel::Id *t : {&intf.hello, &intf.inundacion}) {
+    if (*t)
+      temporizadores_.cancelar(*t);
+    *t = 0;
+  }
+  intf.por_inundar.clear();
+  while (!intf.vecinos.empty())
+    quitar_vecino(intf, intf.vecinos.back().router_id,
+                  "Interface down or detached");
+}
+
+void ProcesoOSPF::programar_hello(Interfaz &intf,
+                                  std::chrono::milliseconds espera) {
+  int ifindex = intf.config.ifindex;
+  intf.hello = temporizadores_.programar(
+      espera,
+      [this, ifindex](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Interfaz *intf = buscar_interfaz(ifindex);
+        if (detenido_ || !intf || intf->hello != id)
+          return;
+        enviar_hello(*intf);
+        programar_hello(*intf, segundos(intf->config.hello));
+      },
+      this);
+}
+
+void ProcesoOSPF::enviar(const Interfaz &intf, uint8_t tipo,
+                         const char *cuerpo, std::size_t largo) {
+  NetworkEngine *net = core_.net_engine;
+  std::size_t total = CABECERA + largo;
+  if (!net || total > PACKET_MAX_PAYLOAD)
+    return;
+
+  // En enlaces punto a punto todo va a AllSPFRouters, con TTL 1
+  SimulatedPacket pkt;
+  pkt.protocol = PROTO_OSPF;
+  pkt.ttl = 1;
+  pkt.src_ip = intf.config.ip;
+  pkt.dst_ip = OSPF_ALL_SPF_ROUTERS;
+  pkt.payload_len = static_cast<uint16_t>(total);
+
+  char *p = pkt.payload;
+  p[0] = OSPF_VERSION;
+  p[1] = tipo;
+  poner16(p + 2, static_cast<uint16_t>(total));
+  poner32(p + 4, router_id_);
+  poner32(p + 8, intf.config.area);
+  poner16(p + 12, 0); // Checksum
+  poner16(p + 14, 0); // Sin autenticación
+  std::memset(p + 16, 0, 8);
+  std::memcpy(p + CABECERA, cuerpo, largo);
+  poner16(p + 12, checksum(p, total));
+
+  net->send_packet(intf.config.enlace, pkt);
+}
+
+void ProcesoOSPF::enviar_hello(Interfaz &intf) {
+  char cuerpo[PACKET_MAX_PAYLOAD - CABECERA];
+  poner32(cuerpo, intf.config.mascara);
+  poner16(cuerpo + 4, intf.config.hello);
+  cuerpo[6] = OPCION_E;
+  cuerpo[7] = PRIORIDAD;
+  poner32(cuerpo + 8, intf.config.dead);
+  poner32(cuerpo + 12, 0); // Sin DR ni BDR en punto a punto
+  poner32(cuerpo + 16, 0);
+
+  // Vecinos de los que se recibió un hello hace menos de un dead interval
+  std::size_t largo = HELLO_FIJO;
+  for (const auto &v : intf.vecinos) {
+    if (v.estado < EstadoVecino::INIT || largo + 4 > sizeof(cuerpo))
+      continue;
+    poner32(cuerpo + largo, v.router_id);
+    largo += 4;
+  }
+  enviar(intf, TIPO_HELLO, cuerpo, largo);
+  stats_.hello_tx++;
+}
+
+// Tantos LSAs por Link State Update como quepan, con la edad actual más
+// InfTransDelay
+std::size_t ProcesoOSPF::enviar_lsu(const Interfaz &intf,
+                                    const std::vector<const LSA *> &lsas,
+                                    std::size_t max_paquetes) {
+  char cuerpo[MAX_CUERPO];
+  std::size_t largo = 4;
+  uint32_t cantidad = 0;
+  std::size_t paquetes = 0;
+  auto vaciar = [&]() {
+    if (cantidad == 0)
+      return;
+    poner32(cuerpo, cantidad);
+    enviar(intf, TIPO_LSU, cuerpo, largo);
+    stats_.lsu_tx++;
+    paquetes++;
+    largo = 4;
+    cantidad = 0;
+  };
+  auto momento = ahora();
+  std::size_t i = 0;
+  for (; i < lsas.size(); ++i) {
+    const LSA *lsa = lsas[i];
+    std::size_t tamano = lsa->datos.size();
+    if (tamano > MAX_LSA) {
+      // originar() no los acepta y uno recibido vino en un paquete igual:
+      // no debería pasar, pero si pasa que quede a la vista
+      stats_.lsas_grandes++;
+      std::cout << "\n%OSPF-4-LSA_TOO_BIG: Process " << proceso_ << ", LSA "
+                << ip_a_texto(lsa->cabecera.id) << " from "
+                << ip_a_texto(lsa->cabecera.anunciante) << " (" << tamano
+                << " bytes) not sent on " << intf.config.nombre << std::endl;
+      continue;
+    }
+    if (largo + tamano > MAX_CUERPO) {
+      vaciar();
+      if (paquetes == max_paquetes)
+        break;
+    }
+    std::memcpy(cuerpo + largo, lsa->datos.data(), tamano);
+    poner16(cuerpo + largo,
+            std::min<uint16_t>(lsa->edad(momento) + LSA_INF_TRANS_DELAY,
+                               LSA_MAX_AGE));
+    largo += tamano;
+    cantidad++;
+  }
+  vaciar();
+  return i;
+}
+
+void ProcesoOSPF::enviar_ack(const Interfaz &intf,
+                             const std::vector<CabeceraLSA> &cabeceras) {
+  char cuerpo[MAX_CUERPO];
+  std::size_t largo = 0;
+  for (const auto &c : cabeceras) {
+    if (largo + LSA_CABECERA > MAX_CUERPO) {
+      enviar(intf, TIPO_ACK, cuerpo, largo);
+      stats_.ack_tx++;
+      largo = 0;
+    }
+    c.escribir(cuerpo + largo);
+    largo += LSA_CABECERA;
+  }
+  if (largo) {
+    enviar(intf, TIPO_ACK, cuerpo, largo);
+    stats_.ack_tx++;
+  }
+}
+
+// Un Link State Request con los pedidos que quepan; el resto va en el
+// siguiente, cuando lleguen estos
+void ProcesoOSPF::enviar_lsr(Interfaz &intf, Vecino &v) {
+  char cuerpo[MAX_CUERPO];
+  std::size_t largo = 0;
+  for (const auto &p : v.pedidos) {
+    if (largo + LSR_ENTRADA > MAX_CUERPO)
+      break;
+    poner32(cuerpo + largo, p.tipo);
+    poner32(cuerpo + largo + 4, p.id);
+    poner32(cuerpo + largo + 8, p.anunciante);
+    largo += LSR_ENTRADA;
+  }
+  if (largo) {
+    enviar(intf, TIPO_LSR, cuerpo, largo);
+    stats_.lsr_tx++;
+    v.lsr_enviado = ahora();
+  }
+}
+
+// ------- Recepción --------
+
+void ProcesoOSPF::recibir(int ifindex, const SimulatedPacket &pkt) {
+  const char *p = pkt.payload;
+  if (pkt.payload_len < CABECERA || p[0] != OSPF_VERSION) {
+    stats_.descartados++;
+    return;
+  }
+  std::size_t largo = leer16(p + 2);
+  if (largo < CABECERA || largo > pkt.payload_len ||
+      checksum(p, largo) != 0) {
+    stats_.descartados++;
+    return;
+  }
+  uint8_t tipo = static_cast<uint8_t>(p[1]);
+  uint32_t router_id = leer32(p + 4);
+  uint32_t area = leer32(p + 8);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (router_id_ == 0 || router_id == router_id_)
+    return;
+  Interfaz *intf = interfaz_de_paquete(ifindex, pkt.src_ip);
+  if (!intf || intf->config.pasiva || intf->config.loopback ||
+      area != intf->config.area) {
+    stats_.descartados++;
+    return;
+  }
+
+  const char *cuerpo = p + CABECERA;
+  std::size_t largo_cuerpo = largo - CABECERA;
+  switch (tipo) {
+  case TIPO_HELLO:
+    recibir_hello(*intf, pkt.src_ip, router_id, cuerpo, largo_cuerpo);
+    break;
+  case TIPO_DD:
+    if (Vecino *v = buscar_vecino(*intf, router_id))
+      recibir_dd(*intf, *v, cuerpo, largo_cuerpo);
+    else
+      stats_.descartados++;
+    break;
+  case TIPO_LSR:
+  case TIPO_LSU:
+  case TIPO_ACK: {
+    // Sólo se intercambian LSAs con vecinos que ya describieron su base
+    Vecino *v = buscar_vecino(*intf, router_id);
+    if (!v || v->estado < EstadoVecino::EXCHANGE) {
+      stats_.descartados++;
+      break;
+    }
+    if (tipo == TIPO_LSR)
+      recibir_lsr(*intf, *v, cuerpo, largo_cuerpo);
+    else if (tipo == TIPO_LSU)
+      recibir_lsu(*intf, *v, cuerpo, largo_cuerpo);
+    else
+      recibir_ack(*v, cuerpo, largo_cuerpo);
+    break;
+  }
+  default:
+    stats_.descartados++;
+    break;
+  }
+}
+
+// RFC 2328, 10.5
+void ProcesoOSPF::recibir_hello(Interfaz &intf, uint32_t origen,
+                                uint32_t router_id, const char *cuerpo,
+                                std::size_t largo) {
+  if (largo < HELLO_FIJO) {
+    stats_.descartados++;
+    return;
+  }
+  uint16_t hello = leer16(cuerpo + 4);
+  uint8_t opciones = static_cast<uint8_t>(cuerpo[6]);
+  uint8_t prioridad = static_cast<uint8_t>(cuerpo[7]);
+  uint32_t dead = leer32(cuerpo + 8);
+  // En punto a punto no se compara la máscara
+  if (hello != intf.config.hello || dead != intf.config.dead ||
+      (opciones & OPCION_E) != OPCION_E) {
+    stats_.descartados++;
+    return;
+  }
+  stats_.hello_rx++;
+
+  Vecino *v = buscar_vecino(intf, router_id);
+  if (!v) {
+    intf.vecinos.emplace_back();
+    v = &intf.vecinos.back();
+    v->router_id = router_id;
+  }
+  v->ip = origen;
+  v->prioridad = prioridad;
+  if (v->estado == EstadoVecino::DOWN)
+    cambiar_estado(intf, *v, EstadoVecino::INIT, "Received Hello");
+  reiniciar_inactividad(intf, *v);
+
+  bool me_ve = false;
+  for (std::size_t off = HELLO_FIJO; off + 4 <= largo; off += 4)
+    me_ve = me_ve || leer32(cuerpo + off) == router_id_;
+
+  if (!me_ve) {
+    // 1-WayReceived: el vecino dejó de vernos
+    if (v->estado >= EstadoVecino::TWO_WAY) {
+      cancelar_temporizadores(*v);
+      reiniciar_inactividad(intf, *v);
+      v->hay_ultimo_dd = false;
+      vaciar_listas(*v);
+      cambiar_estado(intf, *v, EstadoVecino::INIT, "1-Way");
+    }
+    return;
+  }
+  // 2-WayReceived. En punto a punto siempre se forma la adyacencia.
+  if (v->estado == EstadoVecino::INIT) {
+    cambiar_estado(intf, *v, EstadoVecino::TWO_WAY, "2-Way Received");
+    iniciar_exstart(intf, *v);
+  }
+}
+
+// RFC 2328, 10.6 y 10.8
+void ProcesoOSPF::recibir_dd(Interfaz &intf, Vecino &v, const char *cuerpo,
+                             std::size_t largo) {
+  if (largo < DD_FIJO) {
+    stats_.descartados++;
+    return;
+  }
+  uint16_t mtu = leer16(cuerpo);
+  uint8_t opciones = static_cast<uint8_t>(cuerpo[2]);
+  uint8_t flags = static_cast<uint8_t>(cuerpo[3]);
+  uint32_t seq = leer32(cuerpo + 4);
+  if (mtu > PACKET_MAX_PAYLOAD) {
+    stats_.descartados++;
+    return;
+  }
+  stats_.dd_rx++;
+
+  bool duplicado = v.hay_ultimo_dd && flags == v.ultimo_flags &&
+                   opciones == v.ultimo_opciones && seq == v.ultimo_seq;
+
+  switch (v.estado) {
+  case EstadoVecino::DOWN:
+  case EstadoVecino::ATTEMPT:
+  case EstadoVecino::TWO_WAY:
+    return;
+
+  case EstadoVecino::INIT:
+    // El DD implica que el vecino ya nos ve (2-WayReceived)
+    cambiar_estado(intf, v, EstadoVecino::TWO_WAY, "2-Way Received");
+    iniciar_exstart(intf, v);
+    [[fallthrough]];
+
+  case EstadoVecino::EXSTART:
+    if ((flags & (DD_I | DD_M | DD_MS)) == (DD_I | DD_M | DD_MS) &&
+        largo == DD_FIJO && v.router_id > router_id_) {
+      // El vecino es el maestro: se adopta su número de secuencia
+      v.maestro = false;
+      v.dd_seq = seq;
+    } else if (!(flags & (DD_I | DD_MS)) && seq == v.dd_seq &&
+               v.router_id < router_id_) {
+      v.maestro = true; // Respuesta del esclavo a nuestro primer DD
+    } else {
+      return;
+    }
+    negociacion_hecha(intf, v);
+    break;
+
+  case EstadoVecino::EXCHANGE:
+    if (duplicado) {
+      // El esclavo responde a los duplicados reenviando su último DD
+      if (!v.maestro && !v.ultimo_dd.empty())
+        enviar(intf, TIPO_DD, v.ultimo_dd.data(), v.ultimo_dd.size());
+      return;
+    }
+    if (bool(flags & DD_MS) == v.maestro || (flags & DD_I) ||
+        (v.hay_ultimo_dd && opciones != v.ultimo_opciones) ||
+        seq != (v.maestro ? v.dd_seq : v.dd_seq + 1)) {
+      reiniciar_adyacencia(intf, v, "SeqNumberMismatch");
+      return;
+    }
+    break;
+
+  case EstadoVecino::LOADING:
+  case EstadoVecino::FULL:
+    if (duplicado) {
+      if (!v.maestro && !v.ultimo_dd.empty())
+        enviar(intf, TIPO_DD, v.ultimo_dd.data(), v.ultimo_dd.size());
+      return;
+    }
+    reiniciar_adyacencia(intf, v, "SeqNumberMismatch");
+    return;
+  }
+
+  // Paquete aceptado: sus cabeceras van a la lista de pedidos y confirma el
+  // último DD que mandamos, cuyas cabeceras salen del resumen
+  if (!leer_resumen(intf, v, cuerpo + DD_FIJO, largo - DD_FIJO)) {
+    reiniciar_adyacencia(intf, v, "SeqNumberMismatch");
+    return;
+  }
+  v.hay_ultimo_dd = true;
+  v.ultimo_flags = flags;
+  v.ultimo_opciones = opciones;
+  v.ultimo_seq = seq;
+  v.resumen.erase(v.resumen.begin(),
+                  v.resumen.begin() + std::min(v.resumen_enviados,
+                                               v.resumen.size()));
+  v.resumen_enviados = 0;
+
+  if (v.maestro) {
+    if (v.retransmision)
+      temporizadores_.cancelar(v.retransmision);
+    v.retransmision = 0;
+    v.dd_seq++;
+    if (!v.mas_enviado && !(flags & DD_M)) {
+      intercambio_hecho(intf, v);
+    } else {
+      enviar_dd(intf, v, DD_MS);
+      armar_retransmision(intf, v);
+    }
+  } else {
+    v.dd_seq = seq;
+    enviar_dd(intf, v, 0);
+    if (!(flags & DD_M) && !v.mas_enviado)
+      intercambio_hecho(intf, v);
+  }
+}
+
+// Cabeceras de un DD: se pide todo LSA que no tengamos o del que el vecino
+// tenga una instancia más nueva (RFC 2328, 10.6)
+bool ProcesoOSPF::leer_resumen(Interfaz &intf, Vecino &v,
+                               const char *cabeceras, std::size_t largo) {
+  const LSDB &lsdb = area_de(intf).lsdb;
+  auto momento = ahora();
+  for (std::size_t off = 0; off + LSA_CABECERA <= largo; off += LSA_CABECERA) {
+    CabeceraLSA c;
+    c.leer(cabeceras + off);
+    if (c.tipo != LSA_ROUTER && c.tipo != LSA_SUMMARY_RED)
+      return false;
+    const LSA *actual = lsdb.buscar(c.clave());
+    if (actual &&
+        comparar_instancias(c, actual->cabecera_actual(momento)) <= 0)
+      continue;
+    auto it = std::find_if(v.pedidos.begin(), v.pedidos.end(),
+                           [&](const CabeceraLSA &p) {
+                             return p.clave() == c.clave();
+                           });
+    if (it == v.pedidos.end())
+      v.pedidos.push_back(c);
+    else if (comparar_instancias(c, *it) > 0)
+      *it = c;
+  }
+  return true;
+}
+
+// RFC 2328, 10.7: se responde con los LSAs pedidos. Pedir uno que no
+// tenemos es un error del intercambio.
+void ProcesoOSPF::recibir_lsr(Interfaz &intf, Vecino &v, const char *cuerpo,
+                              std::size_t largo) {
+  stats_.lsr_rx++;
+  const LSDB &lsdb = area_de(intf).lsdb;
+  std::vector<const LSA *> lsas;
+  for (std::size_t off = 0; off + LSR_ENTRADA <= largo; off += LSR_ENTRADA) {
+    ClaveLSA clave{static_cast<uint8_t>(leer32(cuerpo + off)),
+                   leer32(cuerpo + off + 4), leer32(cuerpo + off + 8)};
+    const LSA *lsa = lsdb.buscar(clave);
+    if (!lsa) {
+      reiniciar_adyacencia(intf, v, "BadLSReq");
+      return;
+    }
+    lsas.push_back(lsa);
+  }
+  enviar_lsu(intf, lsas);
+}
+
+// RFC 2328, 13
+void ProcesoOSPF::recibir_lsu(Interfaz &intf, Vecino &v, const char *cuerpo,
+                              std::size_t largo) {
+  if (largo < 4) {
+    stats_.descartados++;
+    return;
+  }
+  stats_.lsu_rx++;
+  Area &area = area_de(intf);
+  auto momento = ahora();
+  std::vector<CabeceraLSA> acks;
+  std::size_t cantidad = leer32(cuerpo);
+  std::size_t off = 4;
+  for (std::size_t i = 0; i < cantidad && off + LSA_CABECERA <= largo; ++i) {
+    CabeceraLSA c;
+    c.leer(cuerpo + off);
+    const char *datos = cuerpo + off;
+    if (c.largo < LSA_CABECERA || off + c.largo > largo)
+      break;
+    off += c.largo;
+
+    // Duplicados primero: en una red que converge la mayoría de lo que llega
+    // ya está en la base. La búsqueda por tipo, id y anunciante más la
+    // comparación de secuencia y checksum de la cabecera alcanzan para
+    // descartarlos sin verificar el checksum del LSA.
+    const LSA *actual = area.lsdb.buscar(c.clave());
+    if (actual && comparar_instancias(c, actual->cabecera_actual(momento)) == 0) {
+      stats_.duplicados++;
+      // Si estaba por retransmitirse al vecino, vale como confirmación
+      // implícita. Igual se confirma: como nuestra copia sale encolada, es
+      // probable que no llegue a salir (ver vaciar_inundacion) y el vecino
+      // no tendría otra confirmación.
+      v.retransmitir.erase(c.clave());
+      acks.push_back(c);
+      continue;
+    }
+    if ((c.tipo != LSA_ROUTER && c.tipo != LSA_SUMMARY_RED) ||
+        !checksum_valido(datos, c.largo)) {
+      stats_.descartados++;
+      continue;
+    }
+
+    // Un MaxAge de algo que no tenemos sólo se confirma
+    if (c.edad >= LSA_MAX_AGE && !actual && !hay_intercambios()) {
+      acks.push_back(c);
+      continue;
+    }
+
+    int comparacion =
+        actual ? comparar_instancias(c, actual->cabecera_actual(momento)) : 1;
+    auto pedido = std::find_if(
+        v.pedidos.begin(), v.pedidos.end(),
+        [&](const CabeceraLSA &p) { return p.clave() == c.clave(); });
+
+    if (comparacion > 0) {
+      // Instancia nueva: se instala, se inunda por las demás adyacencias y
+      // se confirma
+      if (pedido != v.pedidos.end() && comparar_instancias(c, *pedido) >= 0)
+        v.pedidos.erase(pedido);
+      instalar(area, std::vector<char>(datos, datos + c.largo));
+      stats_.lsas_nuevos++;
+      inundar(area, *area.lsdb.buscar(c.clave()), &v);
+      acks.push_back(c);
+      // Un LSA propio más nuevo que el nuestro (de antes de reiniciar): se
+      // vuelve a originar con una secuencia mayor (RFC 2328, 13.4). Un
+      // summary lo decide el próximo SPF: se reemplaza si todavía
+      // corresponde y si no se retira.
+      if (c.anunciante == router_id_ && c.tipo == LSA_ROUTER) {
+        originar_router_lsa(area, true);
+      } else if (c.anunciante == router_id_) {
+        rutas_pendientes_ = true;
+        programar_spf();
+      }
+      continue;
+    }
+    if (pedido != v.pedidos.end()) {
+      reiniciar_adyacencia(intf, v, "BadLSReq");
+      return;
+    }
+    // La nuestra es más nueva: se le devuelve
+    if (!(actual->max_age(momento) && actual->cabecera.seq == LSA_SEQ_MAXIMA))
+      enviar_lsu(intf, {actual});
+  }
+  if (!acks.empty())
+    enviar_ack(intf, acks);
+  comprobar_carga(intf, v);
+}
+
+void ProcesoOSPF::recibir_ack(Vecino &v, const char *cuerpo,
+                              std::size_t largo) {
+  stats_.ack_rx++;
+  for (std::size_t off = 0; off + LSA_CABECERA <= largo; off += LSA_CABECERA) {
+    CabeceraLSA c;
+    c.leer(cuerpo + off);
+    auto it = v.retransmitir.find(c.clave());
+    if (it != v.retransmitir.end() &&
+        comparar_instancias(c, it->second.cabecera) == 0)
+      v.retransmitir.erase(it);
+  }
+}
+
+// LOADING termina cuando llegaron todos los LSAs pedidos
+void ProcesoOSPF::comprobar_carga(Interfaz &intf, Vecino &v) {
+  if (v.estado == EstadoVecino::LOADING && v.pedidos.empty())
+    cambiar_estado(intf, v, EstadoVecino::FULL, "Loading Done");
+}
+
+bool ProcesoOSPF::hay_intercambios() const {
+  for (const auto &intf : interfaces_)
+    for (const auto &v : intf.vecinos)
+      if (v.estado == EstadoVecino::EXCHANGE ||
+          v.estado == EstadoVecino::LOADING)
+        return true;
+  return false;
+}
+
+// ------- Máquina de estados --------
+
+void ProcesoOSPF::cambiar_estado(Interfaz &intf, Vecino &v,
+                                 EstadoVecino nuevo, const char *motivo) {
+  EstadoVecino anterior = v.estado;
+  if (anterior == nuevo)
+    return;
+  v.estado = nuevo;
+  stats_.cambios_estado++;
+
+  // Como en IOS, sólo se informa al llegar a FULL o al perderlo. Es también
+  // lo único que cambia los enlaces del router-LSA.
+  if (nuevo == EstadoVecino::FULL || anterior == EstadoVecino::FULL)
+    programar_originacion();
+  if (nuevo == EstadoVecino::FULL || anterior == EstadoVecino::FULL)
+    std::cout << "\n%OSPF-5-ADJCHG: Process " << proceso_ << ", Nbr "
+              << ip_a_texto(v.router_id) << " on " << intf.config.nombre
+              << " from " << nombre_estado(anterior) << " to "
+              << nombre_estado(nuevo) << ", " << motivo << std::endl;
+}
+
+void ProcesoOSPF::iniciar_exstart(Interfaz &intf, Vecino &v) {
+  cambiar_estado(intf, v, EstadoVecino::EXSTART, "AdjOK?");
+  // Cada intento usa un número de secuencia nuevo; el primero es al azar
+  v.dd_seq = v.dd_seq ? v.dd_seq + 1 : static_cast<uint32_t>(aleatorio_());
+  v.maestro = true; // Hasta que la negociación diga otra cosa
+  v.hay_ultimo_dd = false;
+  vaciar_listas(v);
+  if (v.retransmision_lsa)
+    temporizadores_.cancelar(v.retransmision_lsa);
+  v.retransmision_lsa = 0;
+  enviar_dd(intf, v, DD_I | DD_M | DD_MS);
+  armar_retransmision(intf, v);
+}
+
+void ProcesoOSPF::negociacion_hecha(Interfaz &intf, Vecino &v) {
+  // El esclavo no retransmite: sólo responde
+  if (!v.maestro && v.retransmision) {
+    temporizadores_.cancelar(v.retransmision);
+    v.retransmision = 0;
+  }
+  // Lista de resumen: la base de datos al momento de negociar
+  auto momento = ahora();
+  v.resumen.clear();
+  v.resumen_enviados = 0;
+  area_de(intf).lsdb.para_cada([&](const LSA &lsa) {
+    if (!lsa.max_age(momento))
+      v.resumen.push_back(lsa.cabecera_actual(momento));
+  });
+  cambiar_estado(intf, v, EstadoVecino::EXCHANGE, "Negotiation Done");
+}
+
+void ProcesoOSPF::intercambio_hecho(Interfaz &intf, Vecino &v) {
+  if (v.retransmision)
+    temporizadores_.cancelar(v.retransmision);
+  v.retransmision = 0;
+  // Sin LSAs pedidos se salta LOADING
+  if (v.pedidos.empty()) {
+    cambiar_estado(intf, v, EstadoVecino::FULL, "Exchange Done");
+    return;
+  }
+  cambiar_estado(intf, v, EstadoVecino::LOADING, "Exchange Done");
+  enviar_lsr(intf, v);
+  armar_retransmision_lsa(intf, v, segundos(intf.config.rxmt));
+}
+
+void ProcesoOSPF::reiniciar_adyacencia(Interfaz &intf, Vecino &v,
+                                       const char *motivo) {
+  if (v.estado == EstadoVecino::FULL)
+    cambiar_estado(intf, v, EstadoVecino::EXSTART, motivo);
+  iniciar_exstart(intf, v);
+}
+
+void ProcesoOSPF::quitar_vecino(Interfaz &intf, uint32_t router_id,
+                                const char *motivo) {
+  auto it = std::find_if(intf.vecinos.begin(), intf.vecinos.end(),
+                         [&](const Vecino &v) { return v.router_id == router_id; });
+  if (it == intf.vecinos.end())
+    return;
+  cancelar_temporizadores(*it);
+  cambiar_estado(intf, *it, EstadoVecino::DOWN, motivo);
+  intf.vecinos.erase(it);
+}
+
+void ProcesoOSPF::reiniciar_inactividad(Interfaz &intf, Vecino &v) {
+  auto espera = segundos(intf.config.dead);
+  if (v.inactividad && temporizadores_.reprogramar(v.inactividad, espera))
+    return;
+  int ifindex = intf.config.ifindex;
+  uint32_t router_id = v.router_id;
+  v.inactividad = temporizadores_.programar(
+      espera,
+      [this, ifindex, router_id](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Interfaz *intf = buscar_interfaz(ifindex);
+        Vecino *v = intf ? buscar_vecino(*intf, router_id) : nullptr;
+        if (detenido_ || !v || v->inactividad != id)
+          return;
+        v->inactividad = 0;
+        quitar_vecino(*intf, router_id, "Dead timer expired");
+      },
+      this);
+}
+
+// Salvo el primero (I), cada DD lleva las cabeceras del resumen que quepan y
+// el bit M si quedan más
+void ProcesoOSPF::enviar_dd(Interfaz &intf, Vecino &v, uint8_t flags) {
+  std::size_t n = 0;
+  if (!(flags & DD_I)) {
+    n = std::min(v.resumen.size(), (MAX_CUERPO - DD_FIJO) / LSA_CABECERA);
+    if (n < v.resumen.size())
+      flags |= DD_M;
+  }
+  v.ultimo_dd.resize(DD_FIJO + n * LSA_CABECERA);
+  char *cuerpo = v.ultimo_dd.data();
+  poner16(cuerpo, static_cast<uint16_t>(PACKET_MAX_PAYLOAD));
+  cuerpo[2] = OPCION_E;
+  cuerpo[3] = static_cast<char>(flags);
+  poner32(cuerpo + 4, v.dd_seq);
+  for (std::size_t i = 0; i < n; ++i)
+    v.resumen[i].escribir(cuerpo + DD_FIJO + i * LSA_CABECERA);
+  v.resumen_enviados = n;
+  v.mas_enviado = flags & DD_M;
+  enviar(intf, TIPO_DD, cuerpo, v.ultimo_dd.size());
+  stats_.dd_tx++;
+}
+
+// El maestro (y ambos lados en EXSTART) reenvía su último DD cada
+// RxmtInterval hasta que llegue la respuesta
+void ProcesoOSPF::armar_retransmision(Interfaz &intf, Vecino &v) {
+  if (v.retransmision)
+    temporizadores_.cancelar(v.retransmision);
+  int ifindex = intf.config.ifindex;
+  uint32_t router_id = v.router_id;
+  v.retransmision = temporizadores_.programar(
+      segundos(intf.config.rxmt),
+      [this, ifindex, router_id](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Interfaz *intf = buscar_interfaz(ifindex);
+        Vecino *v = intf ? buscar_vecino(*intf, router_id) : nullptr;
+        if (detenido_ || !v || v->retransmision != id)
+          return;
+        v->retransmision = 0;
+        bool espera_respuesta =
+            v->estado == EstadoVecino::EXSTART ||
+            (v->estado == EstadoVecino::EXCHANGE && v->maestro);
+        if (!espera_respuesta || v->ultimo_dd.empty())
+          return;
+        enviar(*intf, TIPO_DD, v->ultimo_dd.data(), v->ultimo_dd.size());
+        stats_.retransmisiones++;
+        armar_retransmision(*intf, *v);
+      },
+      this);
+}
+
+void ProcesoOSPF::cancelar_temporizadores(Vecino &v) {
+  for (TimerWheel::Id *t :
+       {&v.inactividad, &v.retransmision, &v.retransmision_lsa}) {
+    if (*t)
+      temporizadores_.cancelar(*t);
+    *t = 0;
+  }
+}
+
+void ProcesoOSPF::vaciar_listas(Vecino &v) {
+  v.resumen.clear();
+  v.resumen_enviados = 0;
+  v.pedidos.clear();
+  v.retransmitir.clear();
+}
+
+// Pedidos pendientes (en LOADING) y LSAs inundados sin confirmar se reenvían
+// un RxmtInterval después del último envío. Por vez sale un solo LSU: si
+// quedan más vencidos, el siguiente va tras RITMO_RETRANSMISION.
+void ProcesoOSPF::armar_retransmision_lsa(Interfaz &intf, Vecino &v,
+                                          std::chrono::milliseconds espera) {
+  if (v.retransmision_lsa)
+    return; // Ya hay uno en curso: cubre lo que se acaba de agregar
+  int ifindex = intf.config.ifindex;
+  uint32_t router_id = v.router_id;
+  v.retransmision_lsa = temporizadores_.programar(
+      espera,
+      [this, ifindex, router_id](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Interfaz *intf = buscar_interfaz(ifindex);
+        Vecino *v = intf ? buscar_vecino(*intf, router_id) : nullptr;
+        if (detenido_ || !v || v->retransmision_lsa != id)
+          return;
+        v->retransmision_lsa = 0;
+
+        auto momento = ahora();
+        auto rxmt = segundos(intf->config.rxmt);
+        auto hasta = [&](std::chrono::steady_clock::time_point t) {
+          return std::chrono::duration_cast<std::chrono::milliseconds>(
+              t - momento);
+        };
+        auto proxima = rxmt;
+        bool cargando =
+            v->estado == EstadoVecino::LOADING && !v->pedidos.empty();
+        if (cargando) {
+          if (momento >= v->lsr_enviado + rxmt) {
+            enviar_lsr(*intf, *v);
+            stats_.retransmisiones++;
+          } else {
+            proxima = hasta(v->lsr_enviado + rxmt);
+          }
+        }
+
+        // Las entradas cuya instancia ya no está en la base se descartan
+        const LSDB &lsdb = area_de(*intf).lsdb;
+        std::vector<const LSA *> lsas;
+        std::vector<Retransmision *> vencidas;
+        for (auto it = v->retransmitir.begin(); it != v->retransmitir.end();) {
+          const LSA *lsa = lsdb.buscar(it->first);
+          const CabeceraLSA &c = it->second.cabecera;
+          if (!lsa || lsa->cabecera.seq != c.seq ||
+              lsa->cabecera.checksum != c.checksum) {
+            it = v->retransmitir.erase(it);
+            continue;
+          }
+          if (momento >= it->second.enviado + rxmt) {
+            lsas.push_back(lsa);
+            vencidas.push_back(&it->second);
+          } else {
+            proxima = std::min(proxima, hasta(it->second.enviado + rxmt));
+          }
+          ++it;
+        }
+        std::size_t enviados = enviar_lsu(*intf, lsas, 1);
+        for (std::size_t i = 0; i < enviados; ++i)
+          vencidas[i]->enviado = momento;
+        stats_.retransmisiones += enviados;
+        if (enviados < lsas.size())
+          proxima = RITMO_RETRANSMISION;
+
+        if (cargando || !v->retransmitir.empty())
+          armar_retransmision_lsa(*intf, *v, proxima);
+      },
+      this);
+}
+
+// ------- Base de datos e inundación --------
+
+// Instalar una instancia nueva; la anterior deja de retransmitirse. Si cambió
+// lo que describe, el SPF del área tiene que volver a mirar a su anunciante;
+// un summary sólo cambia las rutas inter-área.
+bool ProcesoOSPF::instalar(Area &area, std::vector<char> datos) {
+  CabeceraLSA c;
+  c.leer(datos.data());
+  quitar_de_retransmision(area, c.clave());
+  if (!area.lsdb.instalar(std::move(datos), ahora()))
+    return false;
+  if (c.tipo == LSA_ROUTER)
+    area.spf.cambio(c.anunciante);
+  else if (c.anunciante != router_id_)
+    rutas_pendientes_ = true;
+  else
+    return true; // Los summaries propios no cambian nuestras rutas
+  programar_spf();
+  return true;
+}
+
+// RFC 2328, 13.3. En punto a punto el único vecino de la interfaz por la
+// que llegó es quien lo mandó, así que no se devuelve por ahí. El envío
+// queda encolado en la interfaz (ver vaciar_inundacion).
+void ProcesoOSPF::inundar(Area &area, const LSA &lsa, const Vecino *origen) {
+  auto momento = ahora();
+  CabeceraLSA cabecera = lsa.cabecera_actual(momento);
+  ClaveLSA clave = cabecera.clave();
+  for (auto &intf : interfaces_) {
+    if (intf.config.area != area.id)
+      continue;
+    bool agregado = false;
+    for (auto &v : intf.vecinos) {
+      if (v.estado < EstadoVecino::EXCHANGE)
+        continue;
+      if (v.estado < EstadoVecino::FULL) {
+        auto it = std::find_if(
+            v.pedidos.begin(), v.pedidos.end(),
+            [&](const CabeceraLSA &p) { return p.clave() == clave; });
+        if (it != v.pedidos.end()) {
+          int comparacion = comparar_instancias(cabecera, *it);
+          if (comparacion < 0)
+            continue; // El vecino tiene una más nueva
+          v.pedidos.erase(it);
+          comprobar_carga(intf, v);
+          if (comparacion == 0)
+            continue;
+        }
+      }
+      if (&v == origen)
+        continue;
+      v.retransmitir[clave] = {cabecera, momento};
+      armar_retransmision_lsa(intf, v, segundos(intf.config.rxmt));
+      agregado = true;
+    }
+    if (agregado)
+      encolar_inundacion(intf, clave);
+  }
+}
+
+// Lo que se encola mientras se procesa un LSU (o una ráfaga de cambios
+// propios) sale en el mismo paquete, y nunca antes de RITMO_INUNDACION desde
+// el LSU anterior de la interfaz
+void ProcesoOSPF::encolar_inundacion(Interfaz &intf, const ClaveLSA &clave) {
+  intf.por_inundar.insert(clave);
+  if (intf.inundacion)
+    return;
+  auto momento = ahora();
+  auto listo = intf.ultima_lsu + RITMO_INUNDACION;
+  auto espera = listo > momento
+                    ? std::chrono::duration_cast<std::chrono::milliseconds>(
+                          listo - momento)
+                    : std::chrono::milliseconds(0);
+  int ifindex = intf.config.ifindex;
+  intf.inundacion = temporizadores_.programar(
+      espera,
+      [this, ifindex](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Interfaz *intf = buscar_interfaz(ifindex);
+        if (detenido_ || !intf || intf->inundacion != id)
+          return;
+        intf->inundacion = 0;
+        vaciar_inundacion(*intf);
+      },
+      this);
+}
+
+// Un LSU con lo encolado que algún vecino todavía espera: si la misma
+// instancia ya llegó de su lado (confirmación implícita) o se confirmó
+// antes de salir, no se manda
+void ProcesoOSPF::vaciar_inundacion(Interfaz &intf) {
+  const LSDB &lsdb = area_de(intf).lsdb;
+  std::vector<const LSA *> lsas;
+  for (const ClaveLSA &clave : intf.por_inundar) {
+    const LSA *lsa = lsdb.buscar(clave);
+    bool esperado = false;
+    for (const auto &v : intf.vecinos) {
+      auto it = v.retransmitir.find(clave);
+      if (lsa && it != v.retransmitir.end() &&
+          it->second.cabecera.seq == lsa->cabecera.seq &&
+          it->second.cabecera.checksum == lsa->cabecera.checksum)
+        esperado = true;
+    }
+    if (esperado)
+      lsas.push_back(lsa);
+    else
+      stats_.suprimidos++;
+  }
+  intf.por_inundar.clear();
+
+  auto momento = ahora();
+  std::size_t enviados = enviar_lsu(intf, lsas, 1);
+  if (enviados)
+    intf.ultima_lsu = momento;
+  for (std::size_t i = 0; i < enviados; ++i)
+    for (auto &v : intf.vecinos) {
+      auto it = v.retransmitir.find(lsas[i]->cabecera.clave());
+      if (it != v.retransmitir.end())
+        it->second.enviado = momento;
+    }
+  for (std::size_t i = enviados; i < lsas.size(); ++i)
+    encolar_inundacion(intf, lsas[i]->cabecera.clave());
+}
+
+void ProcesoOSPF::quitar_de_retransmision(const Area &area,
+                                          const ClaveLSA &clave) {
+  for (auto &intf : interfaces_)
+    if (intf.config.area == area.id)
+      for (auto &v : intf.vecinos)
+        v.retransmitir.erase(clave);
+}
+
+bool ProcesoOSPF::en_retransmision(const Area &area,
+                                   const ClaveLSA &clave) const {
+  for (const auto &intf : interfaces_)
+    if (intf.config.area == area.id)
+      for (const auto &v : intf.vecinos)
+        if (v.retransmitir.count(clave))
+          return true;
+  return false;
+}
+
+// Los cambios de una misma ráfaga (varias interfaces, vecinos que llegan a
+// FULL a la vez) salen en un solo LSA por área, y nunca más de uno cada
+// MinLSInterval
+void ProcesoOSPF::programar_originacion() {
+  if (originacion_ || detenido_ || router_id_ == 0)
+    return;
+  auto momento = ahora();
+  auto minimo = ultima_originacion_ + std::chrono::seconds(LSA_MIN_LS_INTERVAL);
+  auto espera = momento >= minimo
+                    ? std::chrono::milliseconds(0)
+                    : std::chrono::duration_cast<std::chrono::milliseconds>(
+                          minimo - momento);
+  originacion_ = temporizadores_.programar(
+      espera,
+      [this](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (detenido_ || originacion_ != id)
+          return;
+        originacion_ = 0;
+        for (auto &[id_area, area] : areas_)
+          originar_router_lsa(area, false);
+      },
+      this);
+}
+
+// Instalar e inundar una instancia propia con la secuencia siguiente. Si el
+// cuerpo es igual al de la vigente no sale nada, salvo que se fuerce (para
+// refrescarla o reemplazar una más nueva de antes de reiniciar).
+bool ProcesoOSPF::originar(Area &area, std::vector<char> datos, bool forzar) {
+  CabeceraLSA cabecera;
+  cabecera.leer(datos.data());
+  ClaveLSA clave = cabecera.clave();
+  // Uno que no cabe en un paquete no llegaría nunca a los vecinos (y los
+  // dejaría en LOADING): sigue vigente la instancia anterior
+  if (datos.size() > MAX_LSA) {
+    stats_.lsas_grandes++;
+    std::cout << "\n%OSPF-4-LSA_TOO_BIG: Process " << proceso_ << ", LSA "
+              << ip_a_texto(cabecera.id) << " in area " << area.id
+              << " needs " << datos.size() << " bytes, max " << MAX_LSA
+              << ", not originated" << std::endl;
+    return false;
+  }
+  auto momento = ahora();
+  const LSA *actual = area.lsdb.buscar(clave);
+  if (actual && !forzar && !actual->max_age(momento) &&
+      std::equal(datos.begin() + LSA_CABECERA, datos.end(),
+                 actual->datos.begin() + LSA_CABECERA, actual->datos.end()))
+    return false;
+
+  cabecera.edad = 0;
+  cabecera.seq = actual ? actual->cabecera.seq + 1 : LSA_SEQ_INICIAL;
+  cabecera.escribir(datos.data());
+  poner_checksum(datos.data(), datos.size());
+  stats_.lsas_originados++;
+  instalar(area, std::move(datos));
+  inundar(area, *area.lsdb.buscar(clave), nullptr);
+  programar_refresco();
+  return true;
+}
+
+// Retiro anticipado (RFC 2328, 14.1): la instancia propia pasa a MaxAge y se
+// inunda para que los demás la borren
+void ProcesoOSPF::retirar(Area &area, const ClaveLSA &clave) {
+  const LSA *lsa = area.lsdb.buscar(clave);
+  if (!lsa)
+    return;
+  std::vector<char> datos = lsa->datos;
+  poner16(datos.data(), LSA_MAX_AGE);
+  instalar(area, std::move(datos));
+  inundar(area, *area.lsdb.buscar(clave), nullptr);
+}
+
+// Router-LSA (RFC 2328, 12.4.1): un enlace P2P por vecino en FULL y la
+// subred de cada interfaz del área como stub; las Loopback se anuncian como
+// host. Un ABR lo marca con el bit B.
+void ProcesoOSPF::originar_router_lsa(Area &area, bool forzar) {
+  if (router_id_ == 0)
+    return;
+  std::vector<EnlaceRouter> enlaces;
+  for (const auto &intf : interfaces_) {
+    const ConfigInterfazOSPF &c = intf.config;
+    if (c.area != area.id)
+      continue;
+    if (c.loopback) {
+      enlaces.push_back({c.ip, 0xFFFFFFFF, ENLACE_STUB, 0});
+      continue;
+    }
+    for (const auto &v : intf.vecinos)
+      if (v.estado == EstadoVecino::FULL)
+        enlaces.push_back({v.router_id, c.ip, ENLACE_P2P, c.costo});
+    enlaces.push_back({c.ip & c.mascara, c.mascara, ENLACE_STUB, c.costo});
+  }
+
+  CabeceraLSA cabecera;
+  cabecera.opciones = OPCION_E;
+  cabecera.id = cabecera.anunciante = router_id_;
+  if (originar(area, armar_router_lsa(cabecera, enlaces,
+                                      es_abr() ? ROUTER_BIT_B : 0),
+               forzar))
+    ultima_originacion_ = ahora();
+}
+
+// Summary-LSAs de un ABR (RFC 2328, 12.4.3). A cada área va una entrada por
+// ruta intra-área de las demás (incluidas las redes de sus interfaces) y, si
+// no es el backbone, las inter-área aprendidas en el backbone. Las redes que
+// caen en un 'area range' de su área salen como el rango, con el mayor de
+// sus costos. Los summaries propios que dejaron de corresponder se retiran.
+void ProcesoOSPF::originar_resumenes() {
+  if (router_id_ == 0)
+    return;
+  struct Resumen {
+    uint32_t mascara;
+    uint32_t metrica;
+  };
+  std::map<uint32_t, std::map<uint32_t, Resumen>> deseados; // Área -> red
+
+  auto anunciar = [&](uint32_t origen, uint32_t red, uint32_t mascara,
+                      uint32_t costo) {
+    for (const auto &[id, area] : areas_) {
+      if (id == origen)
+        continue;
+      // El Link State ID es la red: dos máscaras para la misma red no
+      // pueden convivir y queda la primera
+      auto [it, nuevo] = deseados[id].try_emplace(red, Resumen{mascara, costo});
+      if (!nuevo && it->second.mascara == mascara)
+        it->second.metrica = std::min(it->second.metrica, costo);
+    }
+  };
+
+  if (es_abr()) {
+    for (const auto &[id, area] : areas_) {
+      std::vector<RutaOSPF> propias = area.spf.rutas();
+      for (const auto &intf : interfaces_) {
+        const ConfigInterfazOSPF &c = intf.config;
+        if (c.area != id)
+          continue;
+        if (c.loopback)
+          propias.push_back({c.ip, 0xFFFFFFFF, 0});
+        else
+          propias.push_back({c.ip & c.mascara, c.mascara, c.costo});
+      }
+
+      std::map<std::size_t, uint32_t> por_rango; // Posición en rangos_ -> costo
+      for (const auto &r : propias) {
+        auto rango = std::find_if(
+            rangos_.begin(), rangos_.end(), [&](const RangoArea &g) {
+              return g.area == id && r.mascara >= g.mascara &&
+                     (r.red & g.mascara) == g.red;
+            });
+        if (rango == rangos_.end()) {
+          anunciar(id, r.red, r.mascara, r.costo);
+          continue;
+        }
+        auto [it, nuevo] = por_rango.try_emplace(rango - rangos_.begin(), r.costo);
+        if (!nuevo)
+          it->second = std::max(it->second, r.costo);
+      }
+      for (const auto &[i, costo] : por_rango)
+        anunciar(id, rangos_[i].red, rangos_[i].mascara, costo);
+    }
+    if (areas_.count(0))
+      for (const auto &r : rutas_)
+        if (r.inter_area)
+          anunciar(0, r.red, r.mascara, r.costo);
+  }
+
+  auto momento = ahora();
+  for (auto &[id, area] : areas_) {
+    const auto &lista = deseados[id];
+    for (const auto &[red, resumen] : lista) {
+      CabeceraLSA cabecera;
+      cabecera.opciones = OPCION_E;
+      cabecera.id = red;
+      cabecera.anunciante = router_id_;
+      originar(area,
+               armar_summary_lsa(cabecera, resumen.mascara, resumen.metrica),
+               false);
+    }
+    std::vector<ClaveLSA> sobran;
+    area.lsdb.para_cada([&](const LSA &lsa) {
+      const CabeceraLSA &c = lsa.cabecera;
+      if (c.tipo == LSA_SUMMARY_RED && c.anunciante == router_id_ &&
+          !lsa.max_age(momento) && !lista.count(c.id))
+        sobran.push_back(c.clave());
+    });
+    for (const auto &clave : sobran)
+      retirar(area, clave);
+  }
+}
+
+// Todos los LSAs propios se vuelven a originar antes de que envejezcan en los
+// demás routers: un solo temporizador desde la primera originación sin
+// refrescar
+void ProcesoOSPF::programar_refresco() {
+  if (refresco_ || detenido_)
+    return;
+  refresco_ = temporizadores_.programar(
+      std::chrono::seconds(LSA_REFRESH_TIME),
+      [this](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (detenido_ || refresco_ != id)
+          return;
+        refresco_ = 0;
+        refrescar();
+      },
+      this);
+}
+
+void ProcesoOSPF::refrescar() {
+  auto momento = ahora();
+  for (auto &[id, area] : areas_) {
+    originar_router_lsa(area, true);
+    std::vector<std::vector<char>> resumenes;
+    area.lsdb.para_cada([&](const LSA &lsa) {
+      if (lsa.cabecera.tipo == LSA_SUMMARY_RED &&
+          lsa.cabecera.anunciante == router_id_ && !lsa.max_age(momento))
+        resumenes.push_back(lsa.datos);
+    });
+    for (auto &datos : resumenes)
+      originar(area, std::move(datos), true);
+  }
+}
+
+void ProcesoOSPF::programar_envejecimiento() {
+  if (envejecimiento_ || detenido_ || router_id_ == 0)
+    return;
+  envejecimiento_ = temporizadores_.programar(
+      ENVEJECIMIENTO,
+      [this](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (detenido_ || envejecimiento_ != id)
+          return;
+        envejecimiento_ = 0;
+        for (auto &[id_area, area] : areas_)
+          envejecer(area);
+        programar_envejecimiento();
+      },
+      this);
+}
+
+// Los LSAs que llegaron a MaxAge dejan de contar para el SPF y se inundan
+// para que los demás también los retiren; se borran cuando ningún vecino
+// tiene pendiente confirmarlos
+void ProcesoOSPF::envejecer(Area &area) {
+  auto momento = ahora();
+  for (const ClaveLSA &clave : area.lsdb.vencer(momento)) {
+    if (clave.tipo == LSA_ROUTER)
+      area.spf.cambio(clave.anunciante);
+    else
+      rutas_pendientes_ = true;
+    programar_spf();
+    inundar(area, *area.lsdb.buscar(clave), nullptr);
+  }
+  std::vector<ClaveLSA> viejos;
+  area.lsdb.para_cada([&](const LSA &lsa) {
+    if (lsa.max_age(momento) && !en_retransmision(area, lsa.cabecera.clave()))
+      viejos.push_back(lsa.cabecera.clave());
+  });
+  if (!hay_intercambios())
+    for (const auto &clave : viejos)
+      area.lsdb.quitar(clave);
+}
+
+// ------- Cálculo de rutas --------
+
+// Backoff exponencial: tras un período de 'maximo' sin SPF se espera
+// 'inicial'; si no, hasta cumplir la espera actual desde el último, que se
+// duplica para el siguiente
+void ProcesoOSPF::programar_spf() {
+  if (detenido_)
+    return;
+  info_spf_.disparos++;
+  if (spf_pendiente_) {
+    info_spf_.ahorradas++;
+    return;
+  }
+
+  auto momento = ahora();
+  std::chrono::milliseconds espera(throttle_.inicial);
+  if (ultimo_spf_ == std::chrono::steady_clock::time_point{} ||
+      momento - ultimo_spf_ >= std::chrono::milliseconds(throttle_.maximo)) {
+    espera_actual_ms_ = throttle_.espera;
+  } else {
+    auto listo = ultimo_spf_ + std::chrono::milliseconds(espera_actual_ms_);
+    if (listo > momento)
+      espera = std::max(espera,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            listo - momento));
+    espera_actual_ms_ =
+        std::min(uint64_t(espera_actual_ms_) * 2,
+                 uint64_t(std::max(throttle_.espera, throttle_.maximo)));
+  }
+
+  spf_pendiente_ = temporizadores_.programar(
+      espera,
+      [this](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (detenido_ || spf_pendiente_ != id)
+          return;
+        spf_pendiente_ = 0;
+        ejecutar_spf();
+      },
+      this);
+}
+
+// Las áreas con cambios se calculan a la vez en el pool del core, cada una
+// sobre su propia base y su propio árbol; la tabla se vuelve a armar con
+// todas y sólo se instala si cambió
+void ProcesoOSPF::ejecutar_spf() {
+  std::vector<Area *> pendientes;
+  for (auto &[id, area] : areas_)
+    if (area.spf.hay_pendientes())
+      pendientes.push_back(&area);
+  if (pendientes.empty() && !rutas_pendientes_)
+    return;
+  ultimo_spf_ = ahora();
+  rutas_pendientes_ = false;
+
+  // Las tareas sólo leen las interfaces (resolver_salto) mientras este hilo
+  // espera con el mutex tomado
+  CalculoSPF::ResolverSalto resolver = [this](uint32_t vecino, uint32_t datos,
+                                              int &salida, uint32_t &via) {
+    return resolver_salto(vecino, datos, salida, via);
+  };
+  std::vector<EjecucionSPF> ejecuciones(pendientes.size());
+  std::vector<std::function<void()>> tareas;
+  for (std::size_t i = 0; i < pendientes.size(); ++i)
+    tareas.push_back([&, i] {
+      pendientes[i]->spf.calcular(pendientes[i]->lsdb, resolver,
+                                  ejecuciones[i]);
+      ejecuciones[i].area = pendientes[i]->id;
+    });
+  if (core_.calculo)
+    core_.calculo->ejecutar(tareas);
+  else
+    for (const auto &tarea : tareas)
+      tarea();
+
+  for (const auto &ejecucion : ejecuciones) {
+    switch (ejecucion.tipo) {
+    case EjecucionSPF::Tipo::COMPLETO:
+      info_spf_.completos++;
+      break;
+    case EjecucionSPF::Tipo::INCREMENTAL:
+      info_spf_.incrementales++;
+      break;
+    case EjecucionSPF::Tipo::PARCIAL:
+      info_spf_.parciales++;
+      break;
+    }
+    info_spf_.tiempo_total_us += ejecucion.duracion_us;
+    info_spf_.tiempo_maximo_us =
+        std::max(info_spf_.tiempo_maximo_us, ejecucion.duracion_us);
+    info_spf_.ultimas.insert(info_spf_.ultimas.begin(), ejecucion);
+  }
+  if (info_spf_.ultimas.size() > 10)
+    info_spf_.ultimas.resize(10);
+
+  std::vector<RutaOSPF> tabla = armar_tabla();
+  if (tabla != rutas_) {
+    rutas_ = std::move(tabla);
+    instalar_rutas();
+  }
+  originar_resumenes();
+}
+
+// Rutas intra-área de todas las áreas (la de menor costo si un prefijo está
+// en varias) y, para los prefijos que no tienen, las inter-área: costo hasta
+// el ABR más la métrica de su summary (RFC 2328, 16.2). Un ABR con backbone
+// sólo usa los summaries del backbone.
+std::vector<RutaOSPF> ProcesoOSPF::armar_tabla() const {
+  std::map<std::pair<uint32_t, uint32_t>, RutaOSPF> mejores;
+  auto mejor = [](const RutaOSPF &a, const RutaOSPF &b) {
+    return a.costo != b.costo ? a.costo < b.costo : a.anunciante < b.anunciante;
+  };
+  for (const auto &[id, area] : areas_) {
+    for (const auto &r : area.spf.rutas()) {
+      auto [it, nuevo] = mejores.try_emplace({r.red, r.mascara}, r);
+      if (!nuevo && mejor(r, it->second))
+        it->second = r;
+    }
+  }
+
+  std::set<std::pair<uint32_t, uint32_t>> conectadas;
+  for (const auto &intf : interfaces_) {
+    const ConfigInterfazOSPF &c = intf.config;
+    conectadas.insert(c.loopback ? std::pair{c.ip, 0xFFFFFFFFu}
+                                 : std::pair{c.ip & c.mascara, c.mascara});
+  }
+  bool solo_backbone = es_abr() && areas_.count(0);
+  auto momento = ahora();
+  for (const auto &[id, area] : areas_) {
+    if (solo_backbone && id != 0)
+      continue;
+    area.lsdb.para_cada([&](const LSA &lsa) {
+      const CabeceraLSA &c = lsa.cabecera;
+      uint32_t mascara, metrica, distancia, via;
+      int salida;
+      if (c.tipo != LSA_SUMMARY_RED || c.anunciante == router_id_ ||
+          lsa.max_age(momento) ||
+          !leer_summary_lsa(lsa.datos.data(), lsa.datos.size(), mascara,
+                            metrica) ||
+          metrica >= LSA_INFINITO ||
+          !area.spf.camino(c.anunciante, distancia, salida, via))
+        return;
+      RutaOSPF r{c.id & mascara, mascara, distancia + metrica, salida,
+                 via,         c.anunciante, true};
+      if (conectadas.count({r.red, r.mascara}))
+        return;
+      auto [it, nuevo] = mejores.try_emplace({r.red, r.mascara}, r);
+      if (!nuevo && it->second.inter_area && mejor(r, it->second))
+        it->second = r;
+    });
+  }
+
+  std::vector<RutaOSPF> tabla;
+  tabla.reserve(mejores.size());
+  for (auto &[clave, r] : mejores)
+    tabla.push_back(r);
+  return tabla;
+}
+
+// Sólo desde el hilo de la rueda: la CLI tiene el core tomado mientras
+// ejecuta un comando y configurar() corre dentro de uno
+void ProcesoOSPF::instalar_rutas() {
+  if (instalacion_)
+    temporizadores_.cancelar(instalacion_);
+  instalacion_ = 0;
+  if (!core_.instalar_rutas_ospf(rutas_))
+    programar_instalacion(REINTENTO_INSTALACION);
+}
+
+void ProcesoOSPF::programar_instalacion(std::chrono::milliseconds espera) {
+  if (instalacion_ || detenido_)
+    return;
+  instalacion_ = temporizadores_.programar(
+      espera,
+      [this](TimerWheel::Id id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (detenido_ || instalacion_ != id)
+          return;
+        instalacion_ = 0;
+        instalar_rutas();
+      },
+      this);
+}
+
+// Vecino directo de la raíz: sale por la interfaz cuya IP es la del enlace,
+// hacia la dirección del vecino en FULL
+bool ProcesoOSPF::resolver_salto(uint32_t vecino, uint32_t datos, int &salida,
+                                 uint32_t &via) const {
+  for (const auto &intf : interfaces_) {
+    if (intf.config.ip != datos)
+      continue;
+    for (const auto &v : intf.vecinos) {
+      if (v.router_id == vecino && v.estado == EstadoVecino::FULL) {
+        salida = intf.config.ifindex;
+        via = v.ip;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// ------- Consultas de la CLI --------
+
+std::vector<InfoVecinoOSPF> ProcesoOSPF::vecinos() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<InfoVecinoOSPF> lista;
+  for (const auto &intf : interfaces_) {
+    for (const auto &v : intf.vecinos) {
+      InfoVecinoOSPF info;
+      info.router_id = v.router_id;
+      info.ip = v.ip;
+      info.estado = v.estado;
+      info.prioridad = v.prioridad;
+      info.muerto_en_ms = temporizadores_.restante_ms(v.inactividad);
+      info.interfaz = intf.config.nombre;
+      lista.push_back(std::move(info));
+    }
+  }
+  return lista;
+}
+
+std::vector<InfoInterfazOSPF> ProcesoOSPF::interfaces() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<InfoInterfazOSPF> lista;
+  for (const auto &intf : interfaces_) {
+    InfoInterfazOSPF info;
+    info.config = intf.config;
+    info.vecinos = intf.vecinos.size();
+    info.adyacentes = std::count_if(
+        intf.vecinos.begin(), intf.vecinos.end(),
+        [](const Vecino &v) { return v.estado == EstadoVecino::FULL; });
+    info.hello_en_ms = intf.hello ? temporizadores_.restante_ms(intf.hello) : -1;
+    lista.push_back(std::move(info));
+  }
+  return lista;
+}
+
+std::vector<InfoLSA> ProcesoOSPF::base_datos() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto momento = ahora();
+  std::vector<InfoLSA> lista;
+  for (const auto &[id, area] : areas_) {
+    area.lsdb.para_cada([&](const LSA &lsa) {
+      InfoLSA info;
+      info.area = id;
+      info.cabecera = lsa.cabecera_actual(momento);
+      if (lsa.cabecera.tipo == LSA_ROUTER &&
+          lsa.datos.size() >= LSA_CABECERA + 4)
+        info.enlaces = leer16(lsa.datos.data() + LSA_CABECERA + 2);
+      else if (lsa.cabecera.tipo == LSA_SUMMARY_RED)
+        leer_summary_lsa(lsa.datos.data(), lsa.datos.size(), info.mascara,
+                         info.metrica);
+      lista.push_back(info);
+    });
+  }
+  std::sort(lista.begin(), lista.end(),
+            [](const InfoLSA &a, const InfoLSA &b) {
+              const CabeceraLSA &x = a.cabecera, &y = b.cabecera;
+              if (a.area != b.area)
+                return a.area < b.area;
+              if (x.tipo != y.tipo)
+                return x.tipo < y.tipo;
+              return x.id != y.id ? x.id < y.id : x.anunciante < y.anunciante;
+            });
+  return lista;
+}
+
+InfoSPF ProcesoOSPF::estadisticas_spf() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  InfoSPF info = info_spf_;
+  for (const auto &[id, area] : areas_) {
+    info.lsas += area.lsdb.size();
+    info.suma_checksums += area.lsdb.suma_checksums();
+    info.alcanzados += area.spf.alcanzados();
+  }
+  info.rutas = rutas_.size();
+  info.areas = areas_.size();
+  info.abr = es_abr();
+  info.throttle = throttle_;
+  info.espera_actual_ms = espera_actual_ms_;
+  info.proximo_en_ms =
+      spf_pendiente_ ? temporizadores_.restante_ms(spf_pendiente_) : -1;
+  return info;
+}
@@ -0,0 +1,132 @@
+#include "../include/packet_pool.hpp"
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+
+constexpr std::size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+inline uint64_t empaquetar(uint32_t etiqueta, uint32_t indice) {
+  return (static_cast<uint64_t>(etiqueta) << 32) | indice;
+}
+inline uint32_t indice_de(uint64_t cabeza) {
+  return static_cast<uint32_t>(cabeza);
+}
+inline uint32_t etiqueta_de(uint64_t cabeza) {
+  return static_cast<uint32_t>(cabeza >> 32);
+}
+
+} // namespace
+
+PacketPool::PacketPool(std::size_t capacity, bool huge_pages)
+    : capacity_(capacity < 1 ? 1 : capacity) {
+  std::size_t bytes = capacity_ * sizeof(PacketBuffer);
+  void *mem = MAP_FAILED;
+
+  if (huge_pages) {
+    mapped_bytes_ = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+#ifdef MAP_HUGETLB
+    mem = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    huge_pages_ = mem != MAP_FAILED;
+  }
+
+  if (mem == MAP_FAILED) {
+    mapped_bytes_ = huge_pages ? mapped_bytes_ : bytes;
+    mem = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+      throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    // Sin páginas grandes reservadas: pedir Transparent Huge Pages
+    if (huge_pages)
+      huge_pages_ = madvise(mem, mapped_bytes_, MADV_HUGEPAGE) == 0;
+#endif
+  }
+
+  buffers_ = static_cast<PacketBuffer *>(mem);
+  next_ = new std::atomic<uint32_t>[capacity_];
+  for (std::size_t i = 0; i < capacity_; ++i) {
+    PacketBuffer *buf = new (&buffers_[i]) PacketBuffer();
+    buf->index = static_cast<uint32_t>(i);
+    buf->pool = this;
+    next_[i].store(i + 1 < capacity_ ? static_cast<uint32_t>(i + 1) : NIL,
+                   std::memory_order_relaxed);
+  }
+  head_.store(empaquetar(0, 0));
+}
+
+PacketPool::~PacketPool() {
+  for (std::size_t i = 0; i < capacity_; ++i)
+    buffers_[i].~PacketBuffer();
+  munmap(buffers_, mapped_bytes_);
+  delete[] next_;
+}
+
+PacketRef PacketPool::alloc() {
+  uint64_t cabeza = head_.load(std::memory_order_acquire);
+  while (true) {
+    uint32_t indice = indice_de(cabeza);
+    if (indice == NIL) {
+      stats_.exhausted.fetch_add(1, std::memory_order_relaxed);
+      return PacketRef();
+    }
+    uint32_t siguiente = next_[indice].load(std::memory_order_relaxed);
+    uint64_t nueva = empaquetar(etiqueta_de(cabeza) + 1, siguiente);
+    if (head_.compare_exchange_weak(cabeza, nueva, std::memory_order_acq_rel,
+                                    std::memory_order_acquire)) {
+      PacketBuffer *buf = &buffers_[indice];
+      buf->refs.store(1, std::memory_order_relaxed);
+
+      // Sólo se reinicia la cabecera: el payload se sobrescribe al usarse
+      SimulatedPacket &pkt = buf->pkt;
+      pkt.version = PACKET_VERSION;
+      pkt.ttl = 64;
+      pkt.protocol = PROTO_DATOS;
+      pkt.flags = 0;
+      pkt.payload_len = 0;
+      pkt.src_ip = 0;
+      pkt.dst_ip = 0;
+
+      stats_.allocs.fetch_add(1, std::memory_order_relaxed);
+      std::size_t usados = in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+      uint64_t maximo = stats_.high_water.load(std::memory_order_relaxed);
+      while (usados > maximo &&
+             !stats_.high_water.compare_exchange_weak(
+                 maximo, usados, std::memory_order_relaxed)) {
+      }
+      return PacketRef(buf);
+    }
+  }
+}
+
+PacketRef PacketPool::clone(const SimulatedPacket &pkt) {
+  PacketRef copia = alloc();
+  if (copia) {
+    copia->version = pkt.version;
+    copia->ttl = pkt.ttl;
+    copia->protocol = pkt.protocol;
+    copia->flags = pkt.flags;
+    copia->payload_len = pkt.payload_len;
+    copia->src_ip = pkt.src_ip;
+    copia->dst_ip = pkt.dst_ip;
+    std::memcpy(copia->payload, pkt.payload, pkt.payload_len);
+  }
+  return copia;
+}
+
+void PacketPool::release(PacketBuffer *buf) {
+  stats_.frees.fetch_add(1, std::memory_order_relaxed);
+  in_use_.fetch_sub(1, std::memory_order_relaxed);
+
+  uint64_t cabeza = head_.load(std::memory_order_acquire);
+  while (true) {
+    next_[buf->index].store(indice_de(cabeza), std::memory_order_relaxed);
+    uint64_t nueva = empaquetar(etiqueta_de(cabeza) + 1, buf->index);
+    if (head_.compare_exchange_weak(cabeza, nueva, std::memory_order_acq_rel,
+                                    std::memory_order_acquire))
+      return;
+  }
+}
@@ -0,0 +1,145 @@
+#include "../include/ping.hpp"
+#include "../include/router_core.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// Cada cuánto revisa la CLI si llegó la respuesta. No afecta a la medición:
+// el RTT sale de la marca de tiempo que viaja en el paquete.
+constexpr auto ESPERA = std::chrono::microseconds(50);
+
+} // namespace
+
+uint64_t ahora_ns() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+SesionPing::SesionPing(uint16_t id, std::size_t total)
+    : id_(id), rtt_(std::clamp<std::size_t>(total, 1, MAX_RANURAS)) {}
+
+void SesionPing::registrar_respuesta(const CabeceraEcho &eco,
+                                     uint64_t ahora) {
+  uint16_t seq = ntohs(eco.seq);
+  uint64_t rtt = ahora > eco.enviado_ns ? ahora - eco.enviado_ns : 1;
+  uint64_t vacio = 0;
+  if (!rtt_[seq % rtt_.size()].compare_exchange_strong(vacio, rtt))
+    duplicados_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SesionPing::preparar(uint32_t n) {
+  rtt_[n % rtt_.size()].store(0, std::memory_order_relaxed);
+}
+
+uint64_t SesionPing::rtt_ns(uint32_t n) const {
+  return rtt_[n % rtt_.size()].load(std::memory_order_acquire);
+}
+
+ResultadoPing ejecutar_ping(RouterCore &core, const OpcionesPing &opciones,
+                            const std::function<void(char)> &progreso) {
+  using reloj = std::chrono::steady_clock;
+  ResultadoPing resultado;
+  if (!core.direccion_origen(opciones.destino, resultado.origen)) {
+    resultado.error = "No hay ruta hacia " + ip_a_texto(opciones.destino);
+    return resultado;
+  }
+
+  std::size_t total = std::max<std::size_t>(opciones.repeat, 1);
+  auto sesion = std::make_shared<SesionPing>(core.nuevo_id_ping(), total);
+  core.agregar_sesion_ping(sesion);
+
+  // El relleno se escribe una vez; cada envío sólo cambia la cabecera Echo
+  SimulatedPacket pkt;
+  pkt.protocol = PROTO_ICMP;
+  pkt.src_ip = resultado.origen;
+  pkt.dst_ip = opciones.destino;
+  pkt.payload_len = static_cast<uint16_t>(std::clamp<std::size_t>(
+      opciones.size, sizeof(CabeceraEcho), PACKET_MAX_PAYLOAD));
+  for (std::size_t i = sizeof(CabeceraEcho); i < pkt.payload_len; ++i)
+    pkt.payload[i] = static_cast<char>(i % 2 ? 0xCD : 0xAB);
+
+  auto enviar = [&](uint32_t n) {
+    sesion->preparar(n);
+    CabeceraEcho eco;
+    std::memset(&eco, 0, sizeof(eco));
+    std::memcpy(eco.marca, "ECHO_REQUEST", ICMP_MARCA);
+    eco.id = htons(sesion->id());
+    eco.seq = htons(static_cast<uint16_t>(n));
+    eco.enviado_ns = ahora_ns();
+    std::memcpy(pkt.payload, &eco, sizeof(eco));
+    core.originar_paquete(pkt); // Si no sale, vence como cualquier pérdida
+    resultado.enviados++;
+  };
+
+  std::vector<double> rtts;
+  rtts.reserve(std::min(total, SesionPing::MAX_RANURAS));
+
+  if (!opciones.flood) {
+    for (uint32_t n = 0; n < total; ++n) {
+      reloj::time_point inicio = reloj::now();
+      enviar(n);
+      uint64_t rtt;
+      while (!(rtt = sesion->rtt_ns(n)) &&
+             reloj::now() < inicio + opciones.timeout)
+        std::this_thread::sleep_for(ESPERA);
+      if (rtt)
+        rtts.push_back(rtt / 1e6);
+      if (progreso)
+        progreso(rtt ? '!' : '.');
+      if (n + 1 < total)
+        std::this_thread::sleep_until(inicio + opciones.interval);
+    }
+  } else {
+    // Ventana deslizante: apenas una solicitud responde o vence, sale otra
+    struct EnVuelo {
+      uint32_t n;
+      reloj::time_point limite;
+    };
+    std::size_t ventana =
+        std::clamp<std::size_t>(opciones.ventana, 1, SesionPing::MAX_RANURAS / 2);
+    std::vector<EnVuelo> vuelo;
+    vuelo.reserve(ventana);
+    uint32_t siguiente = 0;
+    while (siguiente < total || !vuelo.empty()) {
+      while (vuelo.size() < ventana && siguiente < total) {
+        enviar(siguiente);
+        vuelo.push_back({siguiente++, reloj::now() + opciones.timeout});
+      }
+
+      reloj::time_point ahora = reloj::now();
+      std::size_t antes = vuelo.size();
+      std::erase_if(vuelo, [&](const EnVuelo &v) {
+        uint64_t rtt = sesion->rtt_ns(v.n);
+        if (rtt)
+          rtts.push_back(rtt / 1e6);
+        return rtt || ahora >= v.limite;
+      });
+      if (vuelo.size() == antes)
+        std::this_thread::yield();
+    }
+  }
+
+  core.quitar_sesion_ping(sesion.get());
+
+  resultado.recibidos = rtts.size();
+  resultado.duplicados = sesion->duplicados();
+  if (!rtts.empty()) {
+    double suma = 0, cuadrados = 0;
+    resultado.min_ms = rtts[0];
+    resultado.max_ms = rtts[0];
+    for (double rtt : rtts) {
+      suma += rtt;
+      cuadrados += rtt * rtt;
+      resultado.min_ms = std::min(resultado.min_ms, rtt);
+      resultado.max_ms = std::max(resultado.max_ms, rtt);
+    }
+    resultado.avg_ms = suma / rtts.size();
+    resultado.stddev_ms = std::sqrt(std::max(
+        0.0, cuadrados / rtts.size() - resultado.avg_ms * resultado.avg_ms));
+  }
+  return resultado;
+}
@@ -0,0 +1,209 @@
+#include "../include/pipeline.hpp"
+#include "../include/network_engine.hpp"
+#include "../include/router_core.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Ranura de productor del hilo actual. Se libera cuando el hilo termina, así
+// los hilos RX que se vuelven a crear (p. ej. al cambiar rx-queues) la reusan.
+struct RegistroProductor {
+  std::atomic<bool> *ocupado = nullptr;
+  const void *pipeline = nullptr;
+  int indice = -1;
+
+  ~RegistroProductor() {
+    if (ocupado)
+      ocupado->store(false, std::memory_order_release);
+  }
+};
+
+thread_local RegistroProductor productor;
+
+// Cuántas vueltas en vacío hace un worker antes de dormirse
+constexpr int VUELTAS_ANTES_DE_DORMIR = 64;
+
+} // namespace
+
+ForwardingPipeline::ForwardingPipeline(RouterCore &core, NetworkEngine &net,
+                                       std::size_t workers,
+                                       std::size_t tam_ring)
+    : core_(core), net_(net), tam_ring_(std::bit_ceil(
+                                  std::max<std::size_t>(tam_ring, RAFAGA))) {
+  workers = std::clamp<std::size_t>(workers, 1, MAX_WORKERS);
+  for (std::size_t w = 0; w < workers; ++w) {
+    auto worker = std::make_unique<Worker>();
+    for (std::size_t p = 0; p < MAX_PRODUCTORES; ++p)
+      worker->colas.push_back(
+          std::make_unique<SpscRing<DescriptorPipeline>>(tam_ring_));
+    workers_.push_back(std::move(worker));
+  }
+}
+
+ForwardingPipeline::~ForwardingPipeline() { stop(); }
+
+void ForwardingPipeline::start() {
+  if (running_)
+    return;
+  running_ = true;
+  for (auto &worker : workers_)
+    worker->hilo = std::thread(&ForwardingPipeline::worker_loop, this,
+                               std::ref(*worker));
+}
+
+void ForwardingPipeline::stop() {
+  if (!running_)
+    return;
+  running_ = false;
+  for (auto &worker : workers_) {
+    worker->senal.fetch_add(1);
+    worker->senal.notify_one();
+  }
+  for (auto &worker : workers_) {
+    if (worker->hilo.joinable())
+      worker->hilo.join();
+  }
+
+  // Lo que quedó en las colas se descarta y los buffers vuelven al pool
+  DescriptorPipeline resto[RAFAGA];
+  for (auto &worker : workers_) {
+    for (auto &cola : worker->colas) {
+      std::size_t n;
+      while ((n = cola->pop_burst(resto, RAFAGA)) > 0) {
+        for (std::size_t i = 0; i < n; ++i)
+          resto[i].pkt.reset();
+      }
+    }
+  }
+}
+
+int ForwardingPipeline::registrar_productor() {
+  if (productor.pipeline == this)
+    return productor.indice;
+
+  for (std::size_t i = 0; i < MAX_PRODUCTORES; ++i) {
+    bool libre = false;
+    if (ocupado_[i].compare_exchange_strong(libre, true)) {
+      if (productor.ocupado)
+        productor.ocupado->store(false, std::memory_order_release);
+      productor.ocupado = &ocupado_[i];
+      productor.pipeline = this;
+      productor.indice = static_cast<int>(i);
+
+      std::size_t activos = productores_activos_.load();
+      while (activos < i + 1 &&
+             !productores_activos_.compare_exchange_weak(activos, i + 1)) {
+      }
+      return productor.indice;
+    }
+  }
+  return -1;
+}
+
+void ForwardingPipeline::encolar(int ifindex, PacketRef *pkts, std::size_t n) {
+  int p = registrar_productor();
+  if (p < 0) {
+    // Sin cola propia no se puede encolar sin romper el modelo SPSC
+    sin_cola_++;
+    core_.handle_incoming_burst(ifindex, pkts, n);
+    return;
+  }
+
+  std::size_t cantidad = workers_.size();
+  uint64_t destinos = 0; // Bitmap de workers que recibieron algo
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t w = (pkts[i]->src_ip ^ pkts[i]->dst_ip) % cantidad;
+    Worker &worker = *workers_[w];
+    // El descriptor se mueve: el hilo RX pide otro buffer para esa posición
+    DescriptorPipeline desc{ifindex, std::move(pkts[i])};
+    if (!worker.colas[p]->push(std::move(desc))) {
+      worker.stats.drop_lleno.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    destinos |= uint64_t(1) << w;
+  }
+
+  // Despertar sólo a los workers dormidos. La barrera ordena la publicación
+  // en la cola antes de leer 'dormido' (el worker hace lo simétrico).
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (std::size_t w = 0; destinos; ++w, destinos >>= 1) {
+    if (!(destinos & 1))
+      continue;
+    Worker &worker = *workers_[w];
+    if (worker.dormido.load(std::memory_order_relaxed)) {
+      worker.senal.fetch_add(1, std::memory_order_release);
+      worker.senal.notify_one();
+    }
+  }
+}
+
+void ForwardingPipeline::procesar(DescriptorPipeline *desc, std::size_t n) {
+  // Agrupar paquetes consecutivos de la misma interfaz en una sola ráfaga
+  PacketRef refs[RAFAGA];
+  std::size_t inicio = 0;
+  while (inicio < n) {
+    int ifindex = desc[inicio].ifindex;
+    std::size_t k = 0;
+    while (inicio + k < n && desc[inicio + k].ifindex == ifindex) {
+      refs[k] = std::move(desc[inicio + k].pkt);
+      k++;
+    }
+    core_.handle_incoming_burst(ifindex, refs, k);
+    for (std::size_t i = 0; i < k; ++i)
+      refs[i].reset();
+    inicio += k;
+  }
+}
+
+void ForwardingPipeline::worker_loop(Worker &worker) {
+  DescriptorPipeline rafaga[RAFAGA];
+  TxBatch tx(net_); // Etapa TX de este worker
+  int vacias = 0;
+
+  while (running_.load(std::memory_order_relaxed)) {
+    std::size_t total = 0;
+    std::size_t activos = productores_activos_.load(std::memory_order_acquire);
+    for (std::size_t p = 0; p < activos; ++p) {
+      std::size_t n = worker.colas[p]->pop_burst(rafaga, RAFAGA);
+      if (n == 0)
+        continue;
+      procesar(rafaga, n);
+      total += n;
+    }
+
+    if (total > 0) {
+      tx.flush();
+      worker.stats.procesados.fetch_add(total, std::memory_order_relaxed);
+      worker.stats.rondas.fetch_add(1, std::memory_order_relaxed);
+      vacias = 0;
+      continue;
+    }
+
+    if (++vacias < VUELTAS_ANTES_DE_DORMIR) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Dormir hasta que un productor avise. Se vuelve a revisar las colas
+    // después de anunciarse dormido para no perder un aviso.
+    uint32_t senal = worker.senal.load(std::memory_order_acquire);
+    worker.dormido.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool hay_datos = false;
+    for (std::size_t p = 0; p < productores_activos_.load() && !hay_datos; ++p)
+      hay_datos = !worker.colas[p]->empty();
+    if (!hay_datos && running_)
+      worker.senal.wait(senal, std::memory_order_acquire);
+    worker.dormido.store(false, std::memory_order_relaxed);
+    worker.stats.despertares.fetch_add(1, std::memory_order_relaxed);
+    vacias = 0;
+  }
+}
+
+std::size_t ForwardingPipeline::profundidad(std::size_t worker) const {
+  std::size_t total = 0;
+  for (const auto &cola : workers_[worker]->colas)
+    total += cola->size();
+  return total;
+}
@@ -0,0 +1,139 @@
+#include "../include/rcu.hpp"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t RANURAS_POR_BLOQUE = 256;
+
+// Cada hilo lector publica aquí la época en la que entró (0 = fuera)
+struct alignas(64) Ranura {
+  std::atomic<uint64_t> epoca{0};
+  std::atomic<bool> ocupada{false};
+};
+
+// Las ranuras van en bloques encadenados: cuando se ocupan todas se agrega
+// otro, así que un router con miles de hilos RX no se queda sin ellas. Los
+// bloques no se liberan nunca (una ranura que se suelta se reutiliza), así
+// que se recorren sin lock.
+struct Bloque {
+  Ranura ranuras[RANURAS_POR_BLOQUE];
+  std::atomic<Bloque *> siguiente{nullptr};
+};
+
+struct Retirado {
+  void *objeto;
+  void (*liberar)(void *);
+  uint64_t epoca; // Época en la que dejó de ser visible
+};
+
+Bloque primer_bloque;
+std::mutex mutex_bloques; // Serializa el agregado de bloques
+std::atomic<uint64_t> epoca_global{1};
+
+std::mutex mutex_retirados;
+std::vector<Retirado> retirados;
+
+// Tomar una ranura libre para el hilo actual; si no queda ninguna, en un
+// bloque nuevo. seq_cst al enlazarlo: un reclamar() que no ve el bloque
+// tampoco puede haber visto la época de un lector que entró en él.
+Ranura *tomar_ranura() {
+  for (Bloque *bloque = &primer_bloque;;) {
+    for (auto &ranura : bloque->ranuras) {
+      bool libre = false;
+      if (ranura.ocupada.compare_exchange_strong(libre, true))
+        return &ranura;
+    }
+    Bloque *siguiente = bloque->siguiente.load();
+    if (!siguiente) {
+      std::lock_guard<std::mutex> lock(mutex_bloques);
+      siguiente = bloque->siguiente.load();
+      if (!siguiente) {
+        siguiente = new Bloque;
+        bloque->siguiente.store(siguiente);
+      }
+    }
+    bloque = siguiente;
+  }
+}
+
+struct RegistroHilo {
+  Ranura *ranura = nullptr;
+  int profundidad = 0;
+
+  ~RegistroHilo() {
+    if (ranura) {
+      ranura->epoca.store(0);
+      ranura->ocupada.store(false, std::memory_order_release);
+    }
+  }
+};
+
+thread_local RegistroHilo registro;
+
+} // namespace
+
+namespace rcu {
+
+SeccionLectura::SeccionLectura() {
+  if (registro.profundidad++ > 0)
+    return;
+  if (!registro.ranura)
+    registro.ranura = tomar_ranura();
+  // seq_cst: la ranura debe ser visible antes de cargar el puntero protegido
+  registro.ranura->epoca.store(epoca_global.load());
+}
+
+SeccionLectura::~SeccionLectura() {
+  if (--registro.profundidad > 0)
+    return;
+  registro.ranura->epoca.store(0, std::memory_order_release);
+}
+
+void retirar(void *objeto, void (*liberar)(void *)) {
+  // Un lector que vio 'objeto' entró con una época <= e
+  uint64_t e = epoca_global.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(mutex_retirados);
+    retirados.push_back({objeto, liberar, e});
+  }
+  reclamar();
+}
+
+std::size_t reclamar() {
+  uint64_t minima = UINT64_MAX;
+  for (const Bloque *bloque = &primer_bloque; bloque;
+       bloque = bloque->siguiente.load()) {
+    for (const auto &ranura : bloque->ranuras) {
+      uint64_t e = ranura.epoca.load();
+      if (e != 0 && e < minima)
+        minima = e;
+    }
+  }
+
+  std::vector<Retirado> liberables;
+  {
+    std::lock_guard<std::mutex> lock(mutex_retirados);
+    auto it = retirados.begin();
+    while (it != retirados.end()) {
+      if (it->epoca < minima) {
+        liberables.push_back(*it);
+        it = retirados.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  for (const auto &r : liberables)
+    r.liberar(r.objeto);
+  return liberables.size();
+}
+
+std::size_t pendientes() {
+  std::lock_guard<std::mutex> lock(mutex_retirados);
+  return retirados.size();
+}
+
+} // namespace rcu
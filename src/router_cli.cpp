@@ -1,7 +1,14 @@
 #include "../include/router_cli.hpp"
 #include "../include/packet.hpp"
 #include "../include/network_engine.hpp"
+#include "../include/ospf.hpp"
+#include "../include/pipeline.hpp"
+#include "../include/ping.hpp"
+#include <algorithm>
 #include <chrono> //Para simular ping
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <thread> //Para simular ping
@@ -219,17 +226,30 @@ void RouterCLI::run() {
     std::cout << prompt() << " ";
     if (!std::getline(std::cin, linea))
       break;
+    if (!ejecutar(linea))
+      break;
+  }
+}
 
-    CommandContexto contexto = crear_contexto();
-    std::string error;
+// El comando completo corre con la configuración tomada: OSPF instala sus
+// rutas desde otro hilo y no debe verlas a medio cambiar
+bool RouterCLI::ejecutar(const std::string &linea) {
+  std::lock_guard<std::mutex> lock(core_.mutex_config);
+  CommandContexto contexto = crear_contexto();
+  std::string error;
 
-    const auto &arbol = obtener_arbol_de_modo(modo_actual);
+  const auto &arbol = obtener_arbol_de_modo(modo_actual);
 
-    bool ok = arbol.ejecutar_linea(contexto, linea, error);
+  bool ok = arbol.ejecutar_linea(contexto, linea, error);
 
-    if (!ok && !error.empty())
-      std::cout << "ERROR: " << error << std::endl;
-  }
+  if (!ok && !error.empty())
+    std::cout << "ERROR: " << error << std::endl;
+  return sesion_activa_;
+}
+
+void RouterCLI::reiniciar_sesion() {
+  modo_actual = CliMode::USER_EXEC;
+  sesion_activa_ = true;
 }
 
 // ------- REGISTRO DE COMANDOS --------
@@ -329,6 +349,23 @@ void RouterCLI::registrar_comandos_priv_exec() {
         handle_show_ip_ospf_interface(contexto, tokens);
       });
 
+  // Show ip ospf database
+  arbol_priv_exec.nuevo_comando(
+      {"show", "ip", "ospf", "database"}, "Mostrar la base de datos OSPF",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_show_ip_ospf_database(contexto, tokens);
+      });
+
+  // Show ip ospf statistics
+  arbol_priv_exec.nuevo_comando(
+      {"show", "ip", "ospf", "statistics"},
+      "Mostrar las ejecuciones del SPF y los contadores de OSPF",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_show_ip_ospf_statistics(contexto, tokens);
+      });
+
   // Show ip route
   arbol_priv_exec.nuevo_comando({"show", "ip", "route"},
                                 "Mostrar la tabla de enrutamiento",
@@ -337,6 +374,23 @@ void RouterCLI::registrar_comandos_priv_exec() {
                                   handle_show_ip_route(contexto, tokens);
                                 });
 
+  // Show ip traffic
+  arbol_priv_exec.nuevo_comando({"show", "ip", "traffic"},
+                                "Mostrar contadores de forwarding",
+                                [this](const CommandContexto &contexto,
+                                       const std::vector<std::string> &tokens) {
+                                  handle_show_ip_traffic(contexto, tokens);
+                                });
+
+  // Show engine statistics
+  arbol_priv_exec.nuevo_comando({"show", "engine", "statistics"},
+                                "Mostrar contadores del motor de red",
+                                [this](const CommandContexto &contexto,
+                                       const std::vector<std::string> &tokens) {
+                                  handle_show_engine_statistics(contexto,
+                                                                tokens);
+                                });
+
   // Ping
   arbol_priv_exec.nuevo_comando({"ping"}, "Enviar ICMP a otra dirección IP",
                                 [this](const CommandContexto &contexto,
@@ -374,6 +428,45 @@ void RouterCLI::registrar_comandos_priv_exec() {
                                        const std::vector<std::string> &tokens) {
                                   handle_reload(contexto, tokens);
                                 });
+
+  // Generador de tráfico
+  arbol_priv_exec.nuevo_comando({"traffic-generator", "start"},
+                                "Enviar tráfico sintético por una interfaz",
+                                [this](const CommandContexto &contexto,
+                                       const std::vector<std::string> &tokens) {
+                                  handle_traffic_generator_start(contexto,
+                                                                 tokens);
+                                });
+  arbol_priv_exec.nuevo_comando({"traffic-generator", "stop"},
+                                "Detener el generador de tráfico",
+                                [this](const CommandContexto &contexto,
+                                       const std::vector<std::string> &tokens) {
+                                  handle_traffic_generator_stop(contexto,
+                                                                tokens);
+                                });
+  arbol_priv_exec.nuevo_comando({"show", "traffic-generator"},
+                                "Estadísticas del generador y del receptor",
+                                [this](const CommandContexto &contexto,
+                                       const std::vector<std::string> &tokens) {
+                                  handle_show_traffic_generator(contexto,
+                                                                tokens);
+                                });
+  arbol_priv_exec.nuevo_comando({"clear", "traffic-generator"},
+                                "Reiniciar los contadores del receptor",
+                                [this](const CommandContexto &contexto,
+                                       const std::vector<std::string> &tokens) {
+                                  handle_clear_traffic_generator(contexto,
+                                                                 tokens);
+                                });
+
+  // Clear ip ospf process
+  arbol_priv_exec.nuevo_comando(
+      {"clear", "ip", "ospf", "process"},
+      "Reiniciar el proceso OSPF (vuelve a elegir el router-id)",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_clear_ip_ospf_process(contexto, tokens);
+      });
 }
 
 void RouterCLI::registrar_comandos_global_cfg() {
@@ -426,6 +519,22 @@ void RouterCLI::registrar_comandos_global_cfg() {
         handle_interface(contexto, tokens);
       });
 
+  // Ip route
+  arbol_global_cfg.nuevo_comando(
+      {"ip", "route"}, "Agregar una ruta estática",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_ip_route(contexto, tokens);
+      });
+
+  // No ip route
+  arbol_global_cfg.nuevo_comando(
+      {"no", "ip", "route"}, "Eliminar una ruta estática",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_no_ip_route(contexto, tokens);
+      });
+
   // Router OSPF
   arbol_global_cfg.nuevo_comando(
       {"router", "ospf"}, "Ingresar a la configuración de OPSF",
@@ -433,6 +542,14 @@ void RouterCLI::registrar_comandos_global_cfg() {
              const std::vector<std::string> &tokens) {
         handle_router_ospf(contexto, tokens);
       });
+
+  // No router OSPF
+  arbol_global_cfg.nuevo_comando(
+      {"no", "router", "ospf"}, "Eliminar el proceso OSPF y su configuración",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_no_router_ospf(contexto, tokens);
+      });
 }
 
 void RouterCLI::registrar_comandos_line_cfg() {
@@ -475,6 +592,14 @@ void RouterCLI::registrar_comandos_if_cfg() {
                                handle_ip_address(contexto, tokens);
                              });
 
+  // No ip address
+  arbol_if_cfg.nuevo_comando({"no", "ip", "address"},
+                             "Quitar direcciones IP de la interfaz",
+                             [this](const CommandContexto &contexto,
+                                    const std::vector<std::string> &tokens) {
+                               handle_no_ip_address(contexto, tokens);
+                             });
+
   // No shutdown
   arbol_if_cfg.nuevo_comando({"no", "shutdown"}, "Activar la interfaz",
                              [this](const CommandContexto &contexto,
@@ -496,6 +621,38 @@ void RouterCLI::registrar_comandos_if_cfg() {
                                handle_shutdown(contexto, tokens);
                              });
 
+  // Ip ospf hello-interval
+  arbol_if_cfg.nuevo_comando({"ip", "ospf", "hello-interval"},
+                             "Segundos entre hellos OSPF",
+                             [this](const CommandContexto &contexto,
+                                    const std::vector<std::string> &tokens) {
+                               handle_ip_ospf_hello_interval(contexto, tokens);
+                             });
+
+  // Ip ospf dead-interval
+  arbol_if_cfg.nuevo_comando({"ip", "ospf", "dead-interval"},
+                             "Segundos sin hellos para dar un vecino por caído",
+                             [this](const CommandContexto &contexto,
+                                    const std::vector<std::string> &tokens) {
+                               handle_ip_ospf_dead_interval(contexto, tokens);
+                             });
+
+  // Ip ospf cost
+  arbol_if_cfg.nuevo_comando({"ip", "ospf", "cost"},
+                             "Costo OSPF de la interfaz",
+                             [this](const CommandContexto &contexto,
+                                    const std::vector<std::string> &tokens) {
+                               handle_ip_ospf_cost(contexto, tokens);
+                             });
+
+  // Rx-queues
+  arbol_if_cfg.nuevo_comando({"rx-queues"},
+                             "Repartir la recepción en varias colas",
+                             [this](const CommandContexto &contexto,
+                                    const std::vector<std::string> &tokens) {
+                               handle_rx_queues(contexto, tokens);
+                             });
+
   // Exit
   arbol_if_cfg.nuevo_comando({"exit"}, "Regresar a modo configuración global",
                              [this](const CommandContexto &contexto,
@@ -543,6 +700,38 @@ void RouterCLI::registrar_comandos_ospf_cfg() {
                                  handle_no_passive_interface(contexto, tokens);
                                });
 
+  // Timers throttle spf
+  arbol_ospf_cfg.nuevo_comando({"timers", "throttle", "spf"},
+                               "Esperas del SPF en milisegundos",
+                               [this](const CommandContexto &contexto,
+                                      const std::vector<std::string> &tokens) {
+                                 handle_timers_throttle_spf(contexto, tokens);
+                               });
+
+  // No timers throttle spf
+  arbol_ospf_cfg.nuevo_comando(
+      {"no", "timers", "throttle", "spf"},
+      "Volver a las esperas del SPF por defecto",
+      [this](const CommandContexto &contexto,
+             const std::vector<std::string> &tokens) {
+        handle_no_timers_throttle_spf(contexto, tokens);
+      });
+
+  // Area range
+  arbol_ospf_cfg.nuevo_comando({"area"},
+                               "Resumir las redes del área en un rango",
+                               [this](const CommandContexto &contexto,
+                                      const std::vector<std::string> &tokens) {
+                                 handle_area_range(contexto, tokens);
+                               });
+
+  // No area range
+  arbol_ospf_cfg.nuevo_comando({"no", "area"}, "Quitar un rango del área",
+                               [this](const CommandContexto &contexto,
+                                      const std::vector<std::string> &tokens) {
+                                 handle_no_area_range(contexto, tokens);
+                               });
+
   // Exit
   arbol_ospf_cfg.nuevo_comando({"exit"}, "Regresar a modo configuración global",
                                [this](const CommandContexto &contexto,
@@ -567,59 +756,103 @@ void RouterCLI::handle_enable(const CommandContexto &,
 
 void RouterCLI::handle_exit(const CommandContexto &,
                             const std::vector<std::string> &) {
-  // Cerrando sesión
+  // Cerrando sesión: run() termina y main detiene el motor de red
   std::cout << "\nSaliendo del router..." << std::endl;
-  std::exit(0);
+  sesion_activa_ = false;
 }
 
 void RouterCLI::handle_ping(const CommandContexto &contexto,
                             const std::vector<std::string> &tokens) {
+  const char *formato =
+      "Formato: ping <dirección ip> [repeat N] [size BYTES] [timeout SEG] "
+      "[interval MS] [flood]";
   if (tokens.size() < 2) {
-    std::cout
-        << "ERROR: no se incluyó la dirección IP\nFormato: ping <dirección ip>"
-        << std::endl;
+    std::cout << "ERROR: no se incluyó la dirección IP\n" << formato
+              << std::endl;
     return;
   }
 
-  std::string dest_ip = tokens[1];
-  
-  // 1. Buscar la ruta en el núcleo
-  InfoRoute *ruta = contexto.core->find_route(dest_ip);
-  if (!ruta) {
-    std::cout << "ERROR: No hay ruta hacia " << dest_ip << std::endl;
+  OpcionesPing opciones;
+  if (!ip_desde_texto(tokens[1], opciones.destino)) {
+    std::cout << "ERROR: Dirección IP inválida" << std::endl;
     return;
   }
-
-  // 2. Obtener la interfaz de salida
-  InfoInterfaz *intf_salida = contexto.core->get_interfaz(ruta->interfaz);
-  if (!intf_salida || !intf_salida->up) {
-    std::cout << "ERROR: Interfaz de salida (" << ruta->interfaz << ") está caída o no existe." << std::endl;
+  for (std::size_t i = 2; i < tokens.size(); ++i) {
+    const std::string &opcion = tokens[i];
+    if (opcion == "flood") {
+      opciones.flood = true;
+      continue;
+    }
+    if (i + 1 >= tokens.size()) {
+      std::cout << "ERROR: falta el valor de '" << opcion << "'\n" << formato
+                << std::endl;
+      return;
+    }
+    const char *valor = tokens[++i].c_str();
+    if (opcion == "repeat") {
+      opciones.repeat = std::strtoul(valor, nullptr, 10);
+    } else if (opcion == "size") {
+      opciones.size = std::strtoul(valor, nullptr, 10);
+    } else if (opcion == "timeout") {
+      opciones.timeout = std::chrono::milliseconds(
+          static_cast<long>(std::strtod(valor, nullptr) * 1000));
+    } else if (opcion == "interval") {
+      opciones.interval =
+          std::chrono::milliseconds(std::strtoul(valor, nullptr, 10));
+    } else {
+      std::cout << "ERROR: opción desconocida '" << opcion << "'\n" << formato
+                << std::endl;
+      return;
+    }
+  }
+  if (opciones.repeat < 1 ||
+      opciones.size < sizeof(CabeceraEcho) ||
+      opciones.size > PACKET_MAX_PAYLOAD) {
+    std::cout << "ERROR: repeat debe ser al menos 1 y size estar entre "
+              << sizeof(CabeceraEcho) << " y " << PACKET_MAX_PAYLOAD
+              << std::endl;
+    return;
+  }
+  if (!contexto.core->net_engine) {
+    std::cout << "ERROR: Motor de red no inicializado." << std::endl;
+    return;
+  }
+  uint32_t origen;
+  if (!contexto.core->direccion_origen(opciones.destino, origen)) {
+    std::cout << "ERROR: No hay ruta hacia " << tokens[1] << std::endl;
     return;
   }
 
-  std::cout << "Pinging " << dest_ip << " with 32 bytes of data:" << std::endl;
-
-  // 3. Crear y enviar paquetes
-  for (int i = 0; i < 4; i++) {
-    SimulatedPacket pkt;
-    pkt.protocol = 1; // ICMP
-    std::strncpy(pkt.src_ip, intf_salida->ip.c_str(), 16);
-    std::strncpy(pkt.dst_ip, dest_ip.c_str(), 16);
-    std::strncpy(pkt.payload, "ECHO_REQUEST", 1024);
-    pkt.payload_len = std::strlen(pkt.payload);
-
-    if (contexto.core->net_engine) {
-       if (!contexto.core->net_engine->send_packet(intf_salida->nombre, pkt)) {
-           std::cout << "Request timed out (could not send)." << std::endl;
-       } else {
-           // Esperamos un poco para dar tiempo a recibir la respuesta en el otro hilo
-           std::this_thread::sleep_for(std::chrono::milliseconds(300));
-       }
-    } else {
-        std::cout << "ERROR: Motor de red no inicializado." << std::endl;
-        break;
-    }
+  std::cout << "Sending " << opciones.repeat << ", " << opciones.size
+            << "-byte ICMP Echos to " << tokens[1] << ", timeout is "
+            << opciones.timeout.count() / 1000.0 << " seconds:" << std::endl;
+
+  // Un '!' por respuesta y un '.' por solicitud vencida, 70 por línea
+  std::size_t columna = 0;
+  ResultadoPing r = ejecutar_ping(
+      *contexto.core, opciones, [&columna](char marca) {
+        std::cout << marca << std::flush;
+        if (++columna % 70 == 0)
+          std::cout << std::endl;
+      });
+  if (!r.error.empty()) {
+    std::cout << "ERROR: " << r.error << std::endl;
+    return;
+  }
+  if (columna % 70 != 0)
+    std::cout << std::endl;
+
+  std::cout << "Success rate is " << (r.recibidos * 100 / r.enviados)
+            << " percent (" << r.recibidos << "/" << r.enviados << ")";
+  if (r.recibidos > 0) {
+    std::cout << std::fixed << std::setprecision(3)
+              << ", round-trip min/avg/max/stddev = " << r.min_ms << "/"
+              << r.avg_ms << "/" << r.max_ms << "/" << r.stddev_ms << " ms"
+              << std::defaultfloat;
   }
+  std::cout << std::endl;
+  if (r.duplicados > 0)
+    std::cout << r.duplicados << " duplicate replies" << std::endl;
 }
 
 void RouterCLI::handle_help(const CommandContexto &,
@@ -697,34 +930,301 @@ void RouterCLI::handle_show_ip_interface_brief(
 
 void RouterCLI::handle_show_ip_ospf_neighbor(const CommandContexto &contexto,
                                              const std::vector<std::string> &) {
+  ProcesoOSPF *ospf = contexto.core->ospf();
+  if (!ospf)
+    return;
+
   std::cout << "Neighbor ID     Pri   State            Dead Time   Address     "
                "    Interface"
             << std::endl;
 
-  // Imprimir cada vecino
-  for (const auto &vecino : contexto.core->ospf_neighbors) {
-    printf("%-15s 1     %-16s 00:00:30    %-15s %s", vecino.router_id.c_str(),
-           vecino.state.c_str(), vecino.neighbor_ip.c_str(),
+  // Imprimir cada vecino. En punto a punto no hay DR: el rol se muestra "-"
+  for (const auto &vecino : ospf->vecinos()) {
+    std::string estado = std::string(nombre_estado(vecino.estado)) + "/  -";
+    long long segundos =
+        vecino.muerto_en_ms < 0 ? 0 : (vecino.muerto_en_ms + 999) / 1000;
+    char muerto[32];
+    std::snprintf(muerto, sizeof(muerto), "%02lld:%02lld:%02lld",
+                  segundos / 3600, segundos / 60 % 60, segundos % 60);
+    printf("%-15s %-5d %-16s %-11s %-15s %s\n",
+           ip_a_texto(vecino.router_id).c_str(), vecino.prioridad,
+           estado.c_str(), muerto, ip_a_texto(vecino.ip).c_str(),
            vecino.interfaz.c_str());
   }
 }
 
+// show ip ospf interface [interfaz]
 void RouterCLI::handle_show_ip_ospf_interface(
+    const CommandContexto &contexto, const std::vector<std::string> &tokens) {
+  ProcesoOSPF *ospf = contexto.core->ospf();
+  if (!ospf)
+    return;
+
+  std::string filtro;
+  if (tokens.size() > 4)
+    filtro = RouterCore::expandir_nombre_interfaz(tokens[4]);
+
+  std::string router_id = ip_a_texto(ospf->router_id());
+  for (const auto &info : ospf->interfaces()) {
+    const ConfigInterfazOSPF &c = info.config;
+    if (!filtro.empty() && c.nombre != filtro)
+      continue;
+    int prefijo = __builtin_popcount(c.mascara);
+    std::cout << c.nombre << " is up, line protocol is up" << std::endl;
+    std::cout << "  Internet Address " << ip_a_texto(c.ip) << "/" << prefijo
+              << ", Area " << c.area << std::endl;
+    std::cout << "  Process ID " << contexto.core->ospf_config.process_id
+              << ", Router ID " << router_id << ", Network Type "
+              << (c.loopback ? "LOOPBACK" : "POINT_TO_POINT")
+              << ", Cost: " << (c.loopback ? 1 : c.costo) << std::endl;
+    if (c.loopback) {
+      std::cout << "  Loopback interface is treated as a stub Host"
+                << std::endl;
+      continue;
+    }
+    std::cout << "  Timer intervals configured, Hello " << c.hello
+              << ", Dead " << c.dead << ", Retransmit " << c.rxmt
+              << std::endl;
+    if (c.pasiva) {
+      std::cout << "    No Hellos (Passive interface)" << std::endl;
+      continue;
+    }
+    if (info.hello_en_ms >= 0) {
+      long long segundos = info.hello_en_ms / 1000;
+      printf("    Hello due in %02lld:%02lld:%02lld\n", segundos / 3600,
+             segundos / 60 % 60, segundos % 60);
+    }
+    std::cout << "  Neighbor Count is " << info.vecinos
+              << ", Adjacent neighbor count is " << info.adyacentes
+              << std::endl;
+  }
+}
+
+void RouterCLI::handle_show_ip_ospf_database(
+    const CommandContexto &contexto, const std::vector<std::string> &) {
+  ProcesoOSPF *ospf = contexto.core->ospf();
+  if (!ospf)
+    return;
+
+  std::cout << "\n            OSPF Router with ID ("
+            << ip_a_texto(ospf->router_id()) << ") (Process ID "
+            << contexto.core->ospf_config.process_id << ")\n"
+            << std::endl;
+  // Viene ordenada por área y tipo: una sección por cada par
+  bool primera = true;
+  uint32_t area = 0;
+  uint8_t tipo = 0;
+  for (const auto &info : ospf->base_datos()) {
+    const CabeceraLSA &c = info.cabecera;
+    if (primera || info.area != area || c.tipo != tipo) {
+      area = info.area;
+      tipo = c.tipo;
+      std::cout << (primera ? "" : "\n") << "                "
+                << (tipo == LSA_ROUTER ? "Router Link States"
+                                       : "Summary Net Link States")
+                << " (Area " << area << ")\n"
+                << std::endl;
+      std::cout << "Link ID         ADV Router      Age         Seq#       "
+                << (tipo == LSA_ROUTER ? "Checksum Link count"
+                                       : "Checksum Mask            Metric")
+                << std::endl;
+      primera = false;
+    }
+    printf("%-15s %-15s %-11u 0x%08X 0x%04X   ", ip_a_texto(c.id).c_str(),
+           ip_a_texto(c.anunciante).c_str(), static_cast<unsigned>(c.edad),
+           static_cast<uint32_t>(c.seq), static_cast<unsigned>(c.checksum));
+    if (tipo == LSA_ROUTER)
+      printf("%zu\n", info.enlaces);
+    else
+      printf("%-15s %u\n", ip_a_texto(info.mascara).c_str(), info.metrica);
+  }
+}
+
+// Ejecuciones del SPF (la más reciente primero) y paquetes por tipo
+void RouterCLI::handle_show_ip_ospf_statistics(
     const CommandContexto &contexto, const std::vector<std::string> &) {
-  std::cout << "Por implementar" << std::endl;
+  ProcesoOSPF *ospf = contexto.core->ospf();
+  if (!ospf)
+    return;
+
+  InfoSPF info = ospf->estadisticas_spf();
+  uint64_t total = info.completos + info.incrementales + info.parciales;
+  std::cout << "  SPF algorithm executed " << total << " times ("
+            << info.completos << " full, " << info.incrementales
+            << " incremental, " << info.parciales << " partial)" << std::endl;
+  std::cout << "  SPF time: " << info.tiempo_total_us << " usecs total, "
+            << info.tiempo_maximo_us << " usecs max" << std::endl;
+  std::cout << "  SPF throttling: initial " << info.throttle.inicial
+            << " msecs, hold " << info.throttle.espera << " msecs, max "
+            << info.throttle.maximo << " msecs (current hold "
+            << info.espera_actual_ms << " msecs)" << std::endl;
+  std::cout << "  " << info.disparos << " SPF triggers, " << info.ahorradas
+            << " coalesced into a scheduled run (runs saved)" << std::endl;
+  if (info.proximo_en_ms >= 0)
+    std::cout << "  Next SPF in " << info.proximo_en_ms << " msecs"
+              << std::endl;
+  std::cout << "  " << info.areas << (info.areas == 1 ? " area" : " areas")
+            << (info.abr ? ", this router is an area border router" : "")
+            << std::endl;
+  printf("  %zu LSAs in database, checksum sum 0x%08X\n", info.lsas,
+         info.suma_checksums);
+  std::cout << "  " << info.alcanzados << " routers reachable, " << info.rutas
+            << " routes\n"
+            << std::endl;
+
+  std::cout << "  Delta T   Area      Type         LSAs  Nodes Routes Time(us)  "
+               "Trigger"
+            << std::endl;
+  auto ahora = std::chrono::steady_clock::now();
+  for (const auto &e : info.ultimas) {
+    long long segundos =
+        std::chrono::duration_cast<std::chrono::seconds>(ahora - e.momento)
+            .count();
+    char delta[32];
+    std::snprintf(delta, sizeof(delta), "%02lld:%02lld:%02lld",
+                  segundos / 3600, segundos / 60 % 60, segundos % 60);
+    const char *tipo = e.tipo == EjecucionSPF::Tipo::COMPLETO ? "Full"
+                       : e.tipo == EjecucionSPF::Tipo::INCREMENTAL
+                           ? "Incremental"
+                           : "Partial";
+    printf("  %-9s %-9u %-12s %-5zu %-5zu %-6zu %-9llu %s\n", delta, e.area,
+           tipo, e.lsas, e.vertices, e.rutas,
+           static_cast<unsigned long long>(e.duracion_us),
+           e.disparador ? ip_a_texto(e.disparador).c_str() : "-");
+  }
+
+  const EstadisticasOSPF &s = ospf->stats();
+  std::cout << "\n  Packets      Sent       Received" << std::endl;
+  printf("  Hello        %-10llu %llu\n",
+         static_cast<unsigned long long>(s.hello_tx.load()),
+         static_cast<unsigned long long>(s.hello_rx.load()));
+  printf("  DB Des       %-10llu %llu\n",
+         static_cast<unsigned long long>(s.dd_tx.load()),
+         static_cast<unsigned long long>(s.dd_rx.load()));
+  printf("  LS Req       %-10llu %llu\n",
+         static_cast<unsigned long long>(s.lsr_tx.load()),
+         static_cast<unsigned long long>(s.lsr_rx.load()));
+  printf("  LS Upd       %-10llu %llu\n",
+         static_cast<unsigned long long>(s.lsu_tx.load()),
+         static_cast<unsigned long long>(s.lsu_rx.load()));
+  printf("  LS Ack       %-10llu %llu\n",
+         static_cast<unsigned long long>(s.ack_tx.load()),
+         static_cast<unsigned long long>(s.ack_rx.load()));
+  std::cout << "  LSAs originated " << s.lsas_originados << ", new received "
+            << s.lsas_nuevos << ", retransmitted " << s.retransmisiones
+            << ", discarded packets " << s.descartados << std::endl;
+  std::cout << "  Duplicate LSAs dropped " << s.duplicados
+            << ", floods suppressed " << s.suprimidos << std::endl;
+  std::cout << "  LSAs too large for one packet " << s.lsas_grandes
+            << std::endl;
 }
 
 void RouterCLI::handle_show_ip_route(const CommandContexto &contexto,
                                      const std::vector<std::string> &) {
   // Codigos de rutas
-  std::cout << "Codes: C - connected, O - OSPF, S - static\n" << std::endl;
+  std::cout << "Codes: C - connected, O - OSPF, IA - OSPF inter area, S - "
+               "static\n"
+            << std::endl;
 
   for (const auto &ruta : contexto.core->rutas) {
-    std::cout << ruta.protocolo << "    " << ruta.destino << "/" << ruta.netmask
-              << " via " << ruta.via << ", " << ruta.interfaz << std::endl;
+    const InfoInterfaz *intf = contexto.core->get_interfaz(ruta.ifindex);
+    std::cout << ruta.protocolo << (ruta.inter_area ? " IA " : "    ")
+              << ruta.destino << "/" << ruta.netmask;
+    if (ruta.protocolo == "O")
+      std::cout << " [" << RouterCore::distancia_administrativa(ruta.protocolo)
+                << "/" << ruta.metrica << "]";
+    std::cout << " via " << ruta.via << ", " << (intf ? intf->nombre : "")
+              << std::endl;
   }
 }
 
+void RouterCLI::handle_show_ip_traffic(const CommandContexto &contexto,
+                                       const std::vector<std::string> &) {
+  const auto &st = contexto.core->stats_fwd;
+  std::cout << "IP statistics:" << std::endl;
+  std::cout << "  Rcvd:  " << st.recibidos << " total, " << st.locales
+            << " local destination" << std::endl;
+  std::cout << "  Sent:  " << st.reenviados << " forwarded" << std::endl;
+  std::cout << "  Drop:  " << st.drop_ttl << " TTL expired, " << st.drop_sin_ruta
+            << " no route, " << st.drop_interfaz_caida
+            << " interface down, " << st.drop_tx << " send errors, "
+            << st.drop_sin_buffer << " no buffer" << std::endl;
+}
+
+void RouterCLI::handle_show_engine_statistics(
+    const CommandContexto &contexto, const std::vector<std::string> &) {
+  NetworkEngine *net = contexto.core->net_engine;
+  if (!net) {
+    std::cout << "ERROR: Motor de red no inicializado." << std::endl;
+    return;
+  }
+
+  const EngineStats &st = net->stats();
+  uint64_t rafagas = st.rx_bursts;
+  if (net->scheduler()) {
+    std::cout << "I/O backend: in-memory links (emulation)" << std::endl;
+    std::cout << "RX mode: shared scheduler (" << net->scheduler()->workers()
+              << " workers)" << std::endl;
+  } else {
+    std::cout << "I/O backend: "
+              << (net->backend() == IoBackend::URING ? "io_uring" : "sockets")
+              << std::endl;
+    if (net->backend() == IoBackend::URING)
+      std::cout << "RX mode: io_uring multishot (1 thread)" << std::endl;
+    else if (net->rx_mode() == RxMode::REACTOR)
+      std::cout << "RX mode: reactor (" << net->reactor_threads()
+                << " threads)" << std::endl;
+    else
+      std::cout << "RX mode: thread per interface" << std::endl;
+  }
+  std::cout << "RX burst size: " << net->rx_burst() << std::endl;
+  std::cout << "  RX: " << st.rx_packets << " packets, " << rafagas
+            << " bursts, " << st.rx_syscalls << " syscalls, " << st.rx_invalid
+            << " invalid" << std::endl;
+  if (rafagas > 0)
+    printf("  Average burst: %.2f packets\n",
+           static_cast<double>(st.rx_packets) / rafagas);
+  std::cout << "  TX: " << st.tx_packets << " packets, " << st.tx_syscalls
+            << " syscalls, " << st.tx_errors << " errors" << std::endl;
+
+  const PacketPool &pool = net->pool();
+  std::cout << "Packet pool: " << pool.capacity() << " buffers ("
+            << (pool.huge_pages() ? "huge pages" : "4K pages") << "), "
+            << pool.in_use() << " in use, " << pool.stats().high_water
+            << " peak, " << pool.stats().exhausted << " exhausted, "
+            << st.rx_no_buffer << " RX drops" << std::endl;
+
+  for (const auto &intf : contexto.core->interfaces) {
+    std::size_t colas = net->rx_queues(intf.nombre);
+    if (colas > 1)
+      std::cout << "  " << intf.nombre << ": " << colas << " RX queues"
+                << std::endl;
+  }
+
+  ForwardingPipeline *pipeline = contexto.core->pipeline;
+  if (!pipeline) {
+    std::cout << "Forwarding: inline on RX threads" << std::endl;
+    return;
+  }
+  std::cout << "Forwarding pipeline: " << pipeline->workers() << " workers, "
+            << pipeline->productores() << " RX producers, ring size "
+            << pipeline->tam_ring() << std::endl;
+  printf("  %-7s %-10s %-12s %-10s %-10s %-8s\n", "Worker", "Depth",
+         "Processed", "Rounds", "Ring drops", "Wakeups");
+  for (std::size_t w = 0; w < pipeline->workers(); ++w) {
+    const EstadisticasWorker &ws = pipeline->stats(w);
+    printf("  %-7zu %-10zu %-12llu %-10llu %-10llu %-8llu\n", w,
+           pipeline->profundidad(w),
+           static_cast<unsigned long long>(ws.procesados.load()),
+           static_cast<unsigned long long>(ws.rondas.load()),
+           static_cast<unsigned long long>(ws.drop_lleno.load()),
+           static_cast<unsigned long long>(ws.despertares.load()));
+  }
+  if (pipeline->sin_cola() > 0)
+    std::cout << "  " << pipeline->sin_cola()
+              << " bursts processed inline (no free ring)" << std::endl;
+}
+
 void RouterCLI::handle_copy_running_config_startup_config(
     const CommandContexto &contexto, const std::vector<std::string> &) {
   if (contexto.core->running_config.texto.empty())
@@ -755,6 +1255,184 @@ void RouterCLI::handle_reload(const CommandContexto &contexto,
   std::cout << "Reload completo." << std::endl;
 }
 
+// traffic-generator start <interfaz> <destino>[-<destino-fin>] [size N|MIN-MAX]
+//   [rate PPS|max] [count N] [duration SEG] [protocol N] [ttl N]
+//   [source A.B.C.D]
+void RouterCLI::handle_traffic_generator_start(
+    const CommandContexto &contexto, const std::vector<std::string> &tokens) {
+  const char *formato =
+      "Formato: traffic-generator start <interfaz> <destino>[-<destino-fin>] "
+      "[size N|MIN-MAX] [rate PPS|max] [count N] [duration SEG] "
+      "[protocol N] [ttl N] [source A.B.C.D]";
+  if (tokens.size() < 4) {
+    std::cout << "ERROR: formato incorrecto.\n" << formato << std::endl;
+    return;
+  }
+  NetworkEngine *net = contexto.core->net_engine;
+  if (!net) {
+    std::cout << "ERROR: Motor de red no inicializado." << std::endl;
+    return;
+  }
+  if (generador_ && generador_->activo()) {
+    std::cout << "ERROR: El generador ya está corriendo (traffic-generator "
+                 "stop)"
+              << std::endl;
+    return;
+  }
+
+  InfoInterfaz *intf = contexto.core->get_interfaz(tokens[2]);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << tokens[2] << "' no encontrada."
+              << std::endl;
+    return;
+  }
+
+  OpcionesGenerador opciones;
+  opciones.ifindex = intf->padre >= 0 ? intf->padre : intf->ifindex;
+  PlantillaTrafico &p = opciones.plantilla;
+  if (!ip_desde_texto(intf->ip, p.origen))
+    p.origen = 0;
+
+  // Rango de destinos A.B.C.D[-E.F.G.H]
+  std::string destinos = tokens[3];
+  std::size_t guion = destinos.find('-');
+  if (!ip_desde_texto(destinos.substr(0, guion), p.destino_inicio) ||
+      !ip_desde_texto(guion == std::string::npos ? destinos
+                                                 : destinos.substr(guion + 1),
+                      p.destino_fin) ||
+      p.destino_fin < p.destino_inicio) {
+    std::cout << "ERROR: Rango de destinos inválido" << std::endl;
+    return;
+  }
+
+  for (std::size_t i = 4; i < tokens.size(); i += 2) {
+    if (i + 1 == tokens.size()) {
+      std::cout << "ERROR: falta el valor de '" << tokens[i] << "'\n"
+                << formato << std::endl;
+      return;
+    }
+    const std::string &opcion = tokens[i];
+    const std::string &valor = tokens[i + 1];
+    if (opcion == "size") {
+      std::size_t sep = valor.find('-');
+      p.size_min = std::strtoul(valor.c_str(), nullptr, 10);
+      p.size_max = sep == std::string::npos
+                       ? p.size_min
+                       : std::strtoul(valor.c_str() + sep + 1, nullptr, 10);
+    } else if (opcion == "rate") {
+      opciones.pps =
+          valor == "max" ? 0 : std::strtoull(valor.c_str(), nullptr, 10);
+    } else if (opcion == "count") {
+      opciones.total = std::strtoull(valor.c_str(), nullptr, 10);
+    } else if (opcion == "duration") {
+      opciones.duracion = std::chrono::milliseconds(
+          static_cast<long>(std::strtod(valor.c_str(), nullptr) * 1000));
+    } else if (opcion == "protocol") {
+      p.protocol =
+          static_cast<uint8_t>(std::strtoul(valor.c_str(), nullptr, 10));
+    } else if (opcion == "ttl") {
+      p.ttl = static_cast<uint8_t>(std::strtoul(valor.c_str(), nullptr, 10));
+    } else if (opcion == "source") {
+      if (!ip_desde_texto(valor, p.origen)) {
+        std::cout << "ERROR: Dirección IP inválida" << std::endl;
+        return;
+      }
+    } else {
+      std::cout << "ERROR: opción desconocida '" << opcion << "'\n"
+                << formato << std::endl;
+      return;
+    }
+  }
+
+  if (!generador_)
+    generador_ = std::make_unique<GeneradorTrafico>(*net);
+  if (!generador_->start(opciones)) {
+    std::cout << "ERROR: size debe estar entre " << sizeof(CabeceraTrafico)
+              << " y " << PACKET_MAX_PAYLOAD
+              << " y la interfaz debe tener un enlace" << std::endl;
+    return;
+  }
+  std::cout << "Traffic generator started: flow " << std::hex
+            << generador_->flujo() << std::dec << " on " << intf->nombre
+            << std::endl;
+}
+
+void RouterCLI::handle_traffic_generator_stop(
+    const CommandContexto &, const std::vector<std::string> &) {
+  if (!generador_ || !generador_->activo()) {
+    std::cout << "El generador no está corriendo" << std::endl;
+    return;
+  }
+  generador_->stop();
+  std::cout << "Traffic generator stopped after " << generador_->stats().enviados
+            << " packets" << std::endl;
+}
+
+void RouterCLI::handle_show_traffic_generator(
+    const CommandContexto &contexto, const std::vector<std::string> &) {
+  std::cout << std::fixed << std::setprecision(1);
+  if (generador_ && generador_->segundos() > 0) {
+    const EstadisticasGenerador &st = generador_->stats();
+    double segundos = generador_->segundos();
+    uint64_t pps = generador_->opciones().pps;
+    std::cout << "Generator: flow " << std::hex << generador_->flujo()
+              << std::dec << ", "
+              << (generador_->activo() ? "running" : "stopped") << ", target "
+              << (pps ? std::to_string(pps) + " pps" : std::string("max"))
+              << std::endl;
+    std::cout << "  " << st.enviados << " packets, " << st.bytes
+              << " bytes in " << segundos << " s" << std::endl;
+    std::cout << "  " << st.enviados / segundos << " pps, "
+              << st.bytes * 8 / segundos / 1e6 << " Mbps" << std::endl;
+    std::cout << "  " << st.errores << " send errors, " << st.sin_buffer
+              << " no buffer" << std::endl;
+  } else {
+    std::cout << "Generator: not started" << std::endl;
+  }
+
+  auto flujos = contexto.core->receptor_trafico.resumen();
+  if (flujos.empty()) {
+    std::cout << "Receiver: no generator traffic received" << std::endl;
+  } else {
+    std::cout << "Receiver:" << std::endl;
+    std::printf("  %-8s %-5s %-12s %-12s %-10s %-7s %-12s %-12s %-12s\n",
+                "Flow", "Dsts", "Packets", "pps", "Mbps", "Loss%",
+                "Lat avg(us)", "p50/p99(us)", "max(us)");
+    for (const auto &f : flujos) {
+      double pps = f.segundos > 0 ? f.paquetes / f.segundos : 0;
+      double mbps = f.segundos > 0 ? f.bytes * 8 / f.segundos / 1e6 : 0;
+      double perdida =
+          100.0 * f.perdidos / static_cast<double>(f.paquetes + f.perdidos);
+      char p50_p99[32];
+      std::snprintf(p50_p99, sizeof(p50_p99), "%.0f/%.0f", f.lat_p50_us,
+                    f.lat_p99_us);
+      std::printf("  %-8x %-5zu %-12llu %-12.0f %-10.1f %-7.2f %-12.1f "
+                  "%-12s %-12.1f\n",
+                  f.flujo, f.destinos,
+                  static_cast<unsigned long long>(f.paquetes), pps, mbps,
+                  perdida, f.lat_avg_us, p50_p99, f.lat_max_us);
+    }
+  }
+  if (contexto.core->receptor_trafico.sin_lugar() > 0)
+    std::cout << "  " << contexto.core->receptor_trafico.sin_lugar()
+              << " packets not counted (flow table full)" << std::endl;
+  std::cout << std::defaultfloat;
+}
+
+void RouterCLI::handle_clear_traffic_generator(
+    const CommandContexto &contexto, const std::vector<std::string> &) {
+  contexto.core->receptor_trafico.limpiar();
+}
+
+void RouterCLI::handle_clear_ip_ospf_process(const CommandContexto &contexto,
+                                             const std::vector<std::string> &) {
+  if (!contexto.core->ospf_config.active) {
+    std::cout << "% OSPF no está configurado" << std::endl;
+    return;
+  }
+  contexto.core->reiniciar_ospf();
+}
+
 // ------- HANDLERS GLOBAL CONFIG --------
 void RouterCLI::handle_hostname(const CommandContexto &contexto,
                                 const std::vector<std::string> &tokens) {
@@ -777,7 +1455,7 @@ void RouterCLI::handle_line_console_0(const CommandContexto &,
   modo_actual = CliMode::LINE_CONFIG;
 }
 
-void RouterCLI::handle_interface(const CommandContexto &,
+void RouterCLI::handle_interface(const CommandContexto &contexto,
                                  const std::vector<std::string> &tokens) {
   if (tokens.size() < 2) {
     std::cout << "ERROR: formato incorrecto.\nFormato: interface <nombre>"
@@ -785,8 +1463,21 @@ void RouterCLI::handle_interface(const CommandContexto &,
     return;
   }
 
+  // Loopbacks y subinterfaces se crean al entrar por primera vez
+  std::size_t antes = contexto.core->interfaces.size();
+  InfoInterfaz *intf = contexto.core->crear_interfaz_logica(tokens[1]);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << tokens[1] << "' no encontrada."
+              << std::endl;
+    return;
+  }
+  if (contexto.core->interfaces.size() != antes) {
+    contexto.core->publicar_estado();
+    contexto.core->actualizar_running_config();
+  }
+
   modo_actual = CliMode::INTERFACE_CONFIG;
-  interfaz = tokens[1];
+  interfaz = intf->nombre;
 }
 
 void RouterCLI::handle_router_ospf(const CommandContexto &contexto,
@@ -803,6 +1494,78 @@ void RouterCLI::handle_router_ospf(const CommandContexto &contexto,
   // Activar OSPF en el core
   contexto.core->ospf_config.active = true;
   contexto.core->ospf_config.process_id = ospf_process_id;
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+void RouterCLI::handle_no_router_ospf(const CommandContexto &contexto,
+                                      const std::vector<std::string> &tokens) {
+  if (tokens.size() < 4) {
+    std::cout
+        << "ERROR: formato incorrecto.\nFormato: no router ospf <process-id>"
+        << std::endl;
+    return;
+  }
+  if (!contexto.core->ospf_config.active ||
+      contexto.core->ospf_config.process_id != tokens[3]) {
+    std::cout << "% Proceso OSPF " << tokens[3] << " no configurado"
+              << std::endl;
+    return;
+  }
+
+  // Como en IOS, con el proceso se va toda su configuración
+  contexto.core->ospf_config = ConfigOSPF{};
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+void RouterCLI::handle_ip_route(const CommandContexto &contexto,
+                                const std::vector<std::string> &tokens) {
+  if (tokens.size() < 5) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: ip route A.B.C.D "
+                 "M.M.M.M <siguiente-salto | interfaz>"
+              << std::endl;
+    return;
+  }
+
+  ConfigRutaEstatica ruta;
+  ruta.destino = tokens[2];
+  ruta.netmask = tokens[3];
+  ruta.siguiente_salto = tokens[4];
+
+  // Una misma combinación no se repite
+  for (const auto &existente : contexto.core->rutas_estaticas) {
+    if (existente.destino == ruta.destino &&
+        existente.netmask == ruta.netmask &&
+        existente.siguiente_salto == ruta.siguiente_salto)
+      return;
+  }
+
+  contexto.core->rutas_estaticas.push_back(ruta);
+  contexto.core->recalcular_rutas_estaticas();
+  contexto.core->actualizar_running_config();
+}
+
+void RouterCLI::handle_no_ip_route(const CommandContexto &contexto,
+                                   const std::vector<std::string> &tokens) {
+  if (tokens.size() < 5) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: no ip route A.B.C.D "
+                 "M.M.M.M <siguiente-salto | interfaz>"
+              << std::endl;
+    return;
+  }
+
+  auto &estaticas = contexto.core->rutas_estaticas;
+  for (auto it = estaticas.begin(); it != estaticas.end(); ++it) {
+    if (it->destino == tokens[3] && it->netmask == tokens[4] &&
+        (tokens.size() < 6 || it->siguiente_salto == tokens[5])) {
+      estaticas.erase(it);
+      contexto.core->recalcular_rutas_estaticas();
+      contexto.core->actualizar_running_config();
+      return;
+    }
+  }
+  std::cout << "ERROR: La ruta estática no existe" << std::endl;
 }
 
 void RouterCLI::handle_exit_global(const CommandContexto &,
@@ -844,9 +1607,9 @@ void RouterCLI::handle_login_local(const CommandContexto &contexto,
 void RouterCLI::handle_ip_address(const CommandContexto &contexto,
                                   const std::vector<std::string> &tokens) {
   if (tokens.size() < 4) {
-    std::cout
-        << "ERROR: formato incorrecto.\nFormato: ip address A.B.C.D M.M.M.M"
-        << std::endl;
+    std::cout << "ERROR: formato incorrecto.\nFormato: ip address A.B.C.D "
+                 "M.M.M.M [secondary]"
+              << std::endl;
     return;
   }
 
@@ -856,8 +1619,52 @@ void RouterCLI::handle_ip_address(const CommandContexto &contexto,
               << std::endl;
     return;
   }
-  intf->ip = tokens[2];
-  intf->netmask = tokens[3];
+
+  uint32_t ip, mascara;
+  if (!ip_desde_texto(tokens[2], ip) || !ip_desde_texto(tokens[3], mascara)) {
+    std::cout << "ERROR: Dirección IP inválida" << std::endl;
+    return;
+  }
+
+  if (tokens.size() > 4 && tokens[4] == "secondary") {
+    if (intf->ip.empty()) {
+      std::cout << "ERROR: La interfaz no tiene dirección primaria"
+                << std::endl;
+      return;
+    }
+    bool repetida = intf->ip == tokens[2];
+    for (const auto &sec : intf->secundarias)
+      repetida = repetida || sec.ip == tokens[2];
+    if (!repetida)
+      intf->secundarias.push_back({tokens[2], tokens[3]});
+  } else {
+    intf->ip = tokens[2];
+    intf->netmask = tokens[3];
+  }
+  contexto.core->recalcular_rutas_connected();
+  contexto.core->actualizar_running_config();
+}
+
+// no ip address [A.B.C.D M.M.M.M secondary]: sin argumentos borra todas las
+// direcciones de la interfaz
+void RouterCLI::handle_no_ip_address(const CommandContexto &contexto,
+                                     const std::vector<std::string> &tokens) {
+  InfoInterfaz *intf = contexto.core->get_interfaz(interfaz);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << interfaz << "' no encontrada."
+              << std::endl;
+    return;
+  }
+
+  if (tokens.size() > 3) {
+    std::erase_if(intf->secundarias, [&](const DireccionSecundaria &sec) {
+      return sec.ip == tokens[3];
+    });
+  } else {
+    intf->ip.clear();
+    intf->netmask.clear();
+    intf->secundarias.clear();
+  }
   contexto.core->recalcular_rutas_connected();
   contexto.core->actualizar_running_config();
 }
@@ -914,6 +1721,39 @@ void RouterCLI::handle_shutdown(const CommandContexto &contexto,
   contexto.core->actualizar_running_config();
 }
 
+void RouterCLI::handle_rx_queues(const CommandContexto &contexto,
+                                 const std::vector<std::string> &tokens) {
+  if (tokens.size() < 2) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: rx-queues <1-"
+              << NetworkEngine::MAX_RX_QUEUES << ">" << std::endl;
+    return;
+  }
+
+  InfoInterfaz *intf = contexto.core->get_interfaz(interfaz);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << interfaz << "' no encontrada."
+              << std::endl;
+    return;
+  }
+
+  std::size_t colas = std::strtoul(tokens[1].c_str(), nullptr, 10);
+  if (colas < 1 || colas > NetworkEngine::MAX_RX_QUEUES) {
+    std::cout << "ERROR: número de colas fuera de rango" << std::endl;
+    return;
+  }
+
+  NetworkEngine *net = contexto.core->net_engine;
+  if (!net || !net->set_rx_queues(intf->nombre, colas)) {
+    // Los enlaces shm y los del emulador tienen una sola cola
+    std::cout << "ERROR: La interfaz no tiene un enlace en la topología o su "
+                 "enlace tiene una sola cola"
+              << std::endl;
+    return;
+  }
+  intf->colas_rx = colas;
+  contexto.core->actualizar_running_config();
+}
+
 // ------- HANDLERS CONFIG OSPF --------
 void RouterCLI::handle_network(const CommandContexto &contexto,
                                const std::vector<std::string> &tokens) {
@@ -930,6 +1770,7 @@ void RouterCLI::handle_network(const CommandContexto &contexto,
   entry.area = std::stoi(tokens[4]);
 
   contexto.core->ospf_config.networks.push_back(entry);
+  contexto.core->actualizar_ospf();
   contexto.core->actualizar_running_config();
   std::cout << "Red " << entry.network << " agregada a OSPF area " << entry.area
             << std::endl;
@@ -944,16 +1785,227 @@ void RouterCLI::handle_router_id(const CommandContexto &contexto,
   }
 
   contexto.core->ospf_config.router_id = tokens[1];
+  contexto.core->actualizar_ospf();
   contexto.core->actualizar_running_config();
   std::cout << "Router-id configurado: " << tokens[1] << std::endl;
 }
 
-void RouterCLI::handle_passive_interface(const CommandContexto &,
-                                         const std::vector<std::string> &) {
-  std::cout << "Comando por implementar" << std::endl;
+void RouterCLI::handle_passive_interface(const CommandContexto &contexto,
+                                         const std::vector<std::string> &tokens) {
+  if (tokens.size() < 2) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: passive-interface "
+                 "<interfaz>"
+              << std::endl;
+    return;
+  }
+
+  InfoInterfaz *intf = contexto.core->get_interfaz(tokens[1]);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << tokens[1] << "' no encontrada."
+              << std::endl;
+    return;
+  }
+
+  auto &pasivas = contexto.core->ospf_config.passive_interfaces;
+  if (std::find(pasivas.begin(), pasivas.end(), intf->nombre) == pasivas.end())
+    pasivas.push_back(intf->nombre);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
 }
 
-void RouterCLI::handle_no_passive_interface(const CommandContexto &,
-                                            const std::vector<std::string> &) {
-  std::cout << "Comando por implementar" << std::endl;
+void RouterCLI::handle_no_passive_interface(
+    const CommandContexto &contexto, const std::vector<std::string> &tokens) {
+  if (tokens.size() < 3) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: no passive-interface "
+                 "<interfaz>"
+              << std::endl;
+    return;
+  }
+
+  std::string nombre = RouterCore::expandir_nombre_interfaz(tokens[2]);
+  std::erase(contexto.core->ospf_config.passive_interfaces, nombre);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+// timers throttle spf <inicial> <espera> <máximo>, en milisegundos
+void RouterCLI::handle_timers_throttle_spf(
+    const CommandContexto &contexto, const std::vector<std::string> &tokens) {
+  long valores[3] = {-1, -1, -1};
+  for (std::size_t i = 0; i < 3 && i + 3 < tokens.size(); ++i) {
+    char *fin = nullptr;
+    valores[i] = std::strtol(tokens[i + 3].c_str(), &fin, 10);
+    if (*fin != '\0')
+      valores[i] = -1;
+  }
+  if (valores[0] < 0 || valores[0] > 600000 || valores[1] < 1 ||
+      valores[1] > 600000 || valores[2] < 1 || valores[2] > 600000) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: timers throttle spf "
+                 "<0-600000> <1-600000> <1-600000>"
+              << std::endl;
+    return;
+  }
+  if (valores[1] > valores[2]) {
+    std::cout << "ERROR: la espera no puede superar el máximo." << std::endl;
+    return;
+  }
+
+  ThrottleSPF &throttle = contexto.core->ospf_config.throttle_spf;
+  throttle.inicial = static_cast<uint32_t>(valores[0]);
+  throttle.espera = static_cast<uint32_t>(valores[1]);
+  throttle.maximo = static_cast<uint32_t>(valores[2]);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+void RouterCLI::handle_no_timers_throttle_spf(
+    const CommandContexto &contexto, const std::vector<std::string> &) {
+  contexto.core->ospf_config.throttle_spf = {};
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+namespace {
+
+// Un rango es un prefijo: máscara contigua y la red sin bits fuera de ella
+bool rango_valido(const std::string &texto_red, uint32_t red,
+                  const std::string &texto_mascara, uint32_t mascara) {
+  if (!mascara_contigua(mascara)) {
+    std::cout << "% Invalid input: la máscara " << texto_mascara
+              << " no es contigua" << std::endl;
+    return false;
+  }
+  if (red & ~mascara) {
+    std::cout << "% Invalid input: " << texto_red
+              << " tiene bits fuera de la máscara " << texto_mascara
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+// area <id> range <red> <máscara>
+void RouterCLI::handle_area_range(const CommandContexto &contexto,
+                                  const std::vector<std::string> &tokens) {
+  char *fin = nullptr;
+  long area =
+      tokens.size() > 1 ? std::strtol(tokens[1].c_str(), &fin, 10) : -1;
+  uint32_t red, mascara;
+  if (tokens.size() < 5 || *fin != '\0' || area < 0 || tokens[2] != "range" ||
+      !ip_desde_texto(tokens[3], red) || !ip_desde_texto(tokens[4], mascara)) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: area N range A.B.C.D "
+                 "M.M.M.M"
+              << std::endl;
+    return;
+  }
+  if (!rango_valido(tokens[3], red, tokens[4], mascara))
+    return;
+
+  AreaRange rango;
+  rango.area = static_cast<int>(area);
+  rango.network = ip_a_texto(red);
+  rango.netmask = tokens[4];
+  auto &rangos = contexto.core->ospf_config.ranges;
+  bool existe = std::any_of(rangos.begin(), rangos.end(), [&](const AreaRange &r) {
+    return r.area == rango.area && r.network == rango.network &&
+           r.netmask == rango.netmask;
+  });
+  if (!existe)
+    rangos.push_back(rango);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+void RouterCLI::handle_no_area_range(const CommandContexto &contexto,
+                                     const std::vector<std::string> &tokens) {
+  char *fin = nullptr;
+  long area =
+      tokens.size() > 2 ? std::strtol(tokens[2].c_str(), &fin, 10) : -1;
+  uint32_t red, mascara;
+  if (tokens.size() < 6 || *fin != '\0' || area < 0 || tokens[3] != "range" ||
+      !ip_desde_texto(tokens[4], red) || !ip_desde_texto(tokens[5], mascara)) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: no area N range "
+                 "A.B.C.D M.M.M.M"
+              << std::endl;
+    return;
+  }
+  if (!rango_valido(tokens[4], red, tokens[5], mascara))
+    return;
+
+  std::string network = ip_a_texto(red);
+  std::erase_if(contexto.core->ospf_config.ranges, [&](const AreaRange &r) {
+    return r.area == area && r.network == network && r.netmask == tokens[5];
+  });
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+// ip ospf hello-interval <1-65535>
+void RouterCLI::handle_ip_ospf_hello_interval(
+    const CommandContexto &contexto, const std::vector<std::string> &tokens) {
+  long segundos =
+      tokens.size() > 3 ? std::strtol(tokens[3].c_str(), nullptr, 10) : 0;
+  if (segundos < 1 || segundos > 65535) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: ip ospf hello-interval "
+                 "<1-65535>"
+              << std::endl;
+    return;
+  }
+
+  InfoInterfaz *intf = contexto.core->get_interfaz(interfaz);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << interfaz << "' no encontrada."
+              << std::endl;
+    return;
+  }
+  intf->ospf_hello = static_cast<uint16_t>(segundos);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+// ip ospf cost <1-65535>
+void RouterCLI::handle_ip_ospf_cost(const CommandContexto &contexto,
+                                    const std::vector<std::string> &tokens) {
+  long costo =
+      tokens.size() > 3 ? std::strtol(tokens[3].c_str(), nullptr, 10) : 0;
+  if (costo < 1 || costo > 65535) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: ip ospf cost <1-65535>"
+              << std::endl;
+    return;
+  }
+
+  InfoInterfaz *intf = contexto.core->get_interfaz(interfaz);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << interfaz << "' no encontrada."
+              << std::endl;
+    return;
+  }
+  intf->ospf_cost = static_cast<uint16_t>(costo);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
+}
+
+// ip ospf dead-interval <1-65535>
+void RouterCLI::handle_ip_ospf_dead_interval(
+    const CommandContexto &contexto, const std::vector<std::string> &tokens) {
+  long segundos =
+      tokens.size() > 3 ? std::strtol(tokens[3].c_str(), nullptr, 10) : 0;
+  if (segundos < 1 || segundos > 65535) {
+    std::cout << "ERROR: formato incorrecto.\nFormato: ip ospf dead-interval "
+                 "<1-65535>"
+              << std::endl;
+    return;
+  }
+
+  InfoInterfaz *intf = contexto.core->get_interfaz(interfaz);
+  if (!intf) {
+    std::cout << "ERROR: Interfaz '" << interfaz << "' no encontrada."
+              << std::endl;
+    return;
+  }
+  intf->ospf_dead = static_cast<uint32_t>(segundos);
+  contexto.core->actualizar_ospf();
+  contexto.core->actualizar_running_config();
 }
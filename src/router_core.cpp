@@ -1,8 +1,21 @@
 #include "../include/router_core.hpp"
 #include "../include/packet.hpp"
 #include "../include/network_engine.hpp"
+#include "../include/ospf.hpp"
+#include "../include/packet_pool.hpp"
+#include "../include/ping.hpp"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <unordered_map>
+
+RouterCore::RouterCore() = default;
+
+// El proceso OSPF cancela sus temporizadores antes de que se destruya el resto
+RouterCore::~RouterCore() {
+  ospf_activo_.store(nullptr);
+  ospf_.reset();
+}
 
 // Método estático para expandir abreviaturas comunes de interfaces Cisco
 std::string RouterCore::expandir_nombre_interfaz(const std::string &nombre) {
@@ -16,80 +29,161 @@ std::string RouterCore::expandir_nombre_interfaz(const std::string &nombre) {
     if (pos != std::string::npos)
       return "Serial" + nombre.substr(pos);
   }
+  if (nombre.rfind("Lo", 0) == 0 || nombre.rfind("lo", 0) == 0) {
+    std::size_t pos = nombre.find_first_of("0123456789");
+    if (pos != std::string::npos)
+      return "Loopback" + nombre.substr(pos);
+  }
   return nombre; // Sin cambios si no coincide con ninguna abreviatura
 }
 
+// Traducir un nombre (completo o abreviado) a su ifindex, -1 si no existe.
+// El nombre completo se resuelve sin reservar memoria; sólo las abreviaturas
+// pasan por expandir_nombre_interfaz.
+int RouterCore::ifindex(const std::string &nombre) {
+  auto it = ifindex_por_nombre_.find(nombre);
+  if (it != ifindex_por_nombre_.end())
+    return it->second;
+  it = ifindex_por_nombre_.find(expandir_nombre_interfaz(nombre));
+  return it == ifindex_por_nombre_.end() ? -1 : it->second;
+}
+
 // Buscar una interfaz por nombre
 InfoInterfaz *RouterCore::get_interfaz(const std::string &nombre) {
-  std::string nombre_expandido = expandir_nombre_interfaz(nombre);
-  for (auto &intf : interfaces) {
-    if (intf.nombre == nombre_expandido)
-      return &intf;
+  return get_interfaz(ifindex(nombre));
+}
+
+InfoInterfaz *RouterCore::get_interfaz(int ifindex) {
+  if (ifindex < 0 || static_cast<std::size_t>(ifindex) >= interfaces.size())
+    return nullptr; // Interfaz no encontrada
+  return &interfaces[ifindex];
+}
+
+// Crear una interfaz con el siguiente ifindex libre (o devolver la que ya
+// tiene ese nombre)
+InfoInterfaz &RouterCore::agregar_interfaz(const std::string &nombre) {
+  auto it = ifindex_por_nombre_.find(nombre);
+  if (it != ifindex_por_nombre_.end())
+    return interfaces[it->second];
+
+  InfoInterfaz intf;
+  intf.ifindex = static_cast<int>(interfaces.size());
+  intf.nombre = nombre;
+  ifindex_por_nombre_[nombre] = intf.ifindex;
+  interfaces.push_back(std::move(intf));
+  return interfaces.back();
+}
+
+// 'interface X' desde la CLI sobre una interfaz que no existe: sólo se pueden
+// crear Loopbacks y subinterfaces (X.N) de una interfaz física existente. Las
+// físicas vienen de la topología.
+InfoInterfaz *RouterCore::crear_interfaz_logica(const std::string &nombre) {
+  if (InfoInterfaz *existente = get_interfaz(nombre))
+    return existente;
+
+  std::string completo = expandir_nombre_interfaz(nombre);
+  int padre = -1;
+  if (completo.rfind("Loopback", 0) != 0) {
+    std::size_t punto = completo.rfind('.');
+    if (punto == std::string::npos || punto + 1 == completo.size())
+      return nullptr;
+    InfoInterfaz *fisica = get_interfaz(completo.substr(0, punto));
+    if (!fisica || fisica->logica)
+      return nullptr;
+    padre = fisica->ifindex;
   }
-  return nullptr; // Interfaz no encontrada
+
+  InfoInterfaz &intf = agregar_interfaz(completo);
+  intf.logica = true;
+  intf.padre = padre;
+  intf.up = true; // Como en IOS, las interfaces lógicas nacen activas
+  return &intf;
 }
 
 // Crear una ruta y agregarla al vector de rutas
 InfoRoute *RouterCore::set_route(std::string destino, std::string netmask,
-                                 std::string via, std::string interfaz,
+                                 std::string via, int ifindex,
                                  std::string protocolo) {
   InfoRoute nueva_ruta;
   nueva_ruta.destino = std::move(destino);
   nueva_ruta.netmask = std::move(netmask);
   nueva_ruta.via = std::move(via);
-  nueva_ruta.interfaz = std::move(interfaz);
+  nueva_ruta.ifindex = ifindex;
   nueva_ruta.protocolo = std::move(protocolo);
 
   rutas.push_back(std::move(nueva_ruta));
+  instalar_en_fib(static_cast<uint32_t>(rutas.size() - 1));
   return &rutas.back();
 }
 
+// Distancia administrativa para elegir entre rutas al mismo prefijo
+int RouterCore::distancia_administrativa(const std::string &protocolo) {
+  if (protocolo == "C")
+    return 0;
+  if (protocolo == "S")
+    return 1;
+  if (protocolo == "O")
+    return 110;
+  return 255;
+}
+
+// Agregar rutas[indice] a la FIB si es preferible a la que ya tenga el prefijo
+void RouterCore::instalar_en_fib(uint32_t indice) {
+  const InfoRoute &ruta = rutas[indice];
+  uint32_t red, mascara;
+  if (!ip_desde_texto(ruta.destino, red) ||
+      !ip_desde_texto(ruta.netmask, mascara))
+    return;
+
+  uint8_t largo = prefijo_de_mascara(mascara);
+  uint32_t actual = fib.buscar_exacto(red, largo);
+  if (actual != FibTrie::SIN_VALOR &&
+      distancia_administrativa(rutas[actual].protocolo) <=
+          distancia_administrativa(ruta.protocolo))
+    return;
+
+  fib.insertar(red, largo, indice);
+}
+
+// Regenerar la FIB completa a partir de la RIB (tras borrar rutas)
+void RouterCore::reconstruir_fib() {
+  fib.limpiar();
+  for (uint32_t i = 0; i < rutas.size(); ++i)
+    instalar_en_fib(i);
+}
+
+// Las interfaces físicas (las de la topología, que se crean antes que
+// cualquier lógica) conservan su ifindex porque el motor de red ya está
+// asociado a él; sólo pierden su configuración. Las lógicas se eliminan.
 void RouterCore::init_default_state() {
-  interfaces.clear();
-
-  // GigabitEthernet0/0  (abrev. Gig0/0)
-  InfoInterfaz gig00;
-  gig00.nombre = "GigabitEthernet0/0";
-  gig00.ip = "";
-  gig00.netmask = "";
-  gig00.up = false;
-  interfaces.push_back(gig00);
-
-  // GigabitEthernet0/0/0  (Gig0/0/0)
-  InfoInterfaz gig000;
-  gig000.nombre = "GigabitEthernet0/0/0";
-  gig000.ip = "";
-  gig000.netmask = "";
-  gig000.up = false;
-  interfaces.push_back(gig000);
-
-  // GigabitEthernet0/0/1  (Gig0/0/1)
-  InfoInterfaz gig001;
-  gig001.nombre = "GigabitEthernet0/0/1";
-  gig001.ip = "";
-  gig001.netmask = "";
-  gig001.up = false;
-  interfaces.push_back(gig001);
-
-  // Serial0/0/0  (Se0/0/0)
-  InfoInterfaz s000;
-  s000.nombre = "Serial0/0/0";
-  s000.ip = "";
-  s000.netmask = "";
-  s000.up = false;
-  interfaces.push_back(s000);
-
-  // Serial0/0/1  (Se0/0/1)
-  InfoInterfaz s001;
-  s001.nombre = "Serial0/0/1";
-  s001.ip = "";
-  s001.netmask = "";
-  s001.up = false;
-  interfaces.push_back(s001);
-
-  // Limpiar vecinos y rutas
-  ospf_neighbors.clear();
+  std::erase_if(interfaces,
+                [](const InfoInterfaz &intf) { return intf.logica; });
+  ifindex_por_nombre_.clear();
+  for (auto &intf : interfaces) {
+    intf.ip.clear();
+    intf.netmask.clear();
+    intf.secundarias.clear();
+    intf.description.clear();
+    intf.up = false;
+    intf.ospf_hello = 0;
+    intf.ospf_dead = 0;
+    intf.ospf_cost = 0;
+    ifindex_por_nombre_[intf.nombre] = intf.ifindex;
+  }
+
+  // Sin topología: el chasis clásico de cinco puertos
+  if (interfaces.empty()) {
+    agregar_interfaz("GigabitEthernet0/0");   // Gig0/0
+    agregar_interfaz("GigabitEthernet0/0/0"); // Gig0/0/0
+    agregar_interfaz("GigabitEthernet0/0/1"); // Gig0/0/1
+    agregar_interfaz("Serial0/0/0");          // Se0/0/0
+    agregar_interfaz("Serial0/0/1");          // Se0/0/1
+  }
+
+  // Limpiar rutas
   rutas.clear();
+  rutas_estaticas.clear();
+  fib.limpiar();
 
   // OSPF
   ospf_config.active = false;
@@ -97,6 +191,12 @@ void RouterCore::init_default_state() {
   ospf_config.router_id = "";
   ospf_config.networks.clear();
   ospf_config.passive_interfaces.clear();
+  ospf_config.ranges.clear();
+  ospf_config.throttle_spf = {};
+  router_id_auto_ = 0;
+
+  publicar_estado();
+  actualizar_ospf(); // Los vecinos se pierden con la configuración
 }
 
 void RouterCore::generar_running_config() {
@@ -128,6 +228,19 @@ void RouterCore::generar_running_config() {
     if (!interfaz.ip.empty())
       oss << " ip address " << interfaz.ip << " " << interfaz.netmask
           << std::endl;
+    for (const auto &sec : interfaz.secundarias)
+      oss << " ip address " << sec.ip << " " << sec.netmask << " secondary"
+          << std::endl;
+
+    if (interfaz.ospf_hello)
+      oss << " ip ospf hello-interval " << interfaz.ospf_hello << std::endl;
+    if (interfaz.ospf_dead)
+      oss << " ip ospf dead-interval " << interfaz.ospf_dead << std::endl;
+    if (interfaz.ospf_cost)
+      oss << " ip ospf cost " << interfaz.ospf_cost << std::endl;
+
+    if (interfaz.colas_rx > 1)
+      oss << " rx-queues " << interfaz.colas_rx << std::endl;
 
     if (interfaz.up)
       oss << " no shutdown" << std::endl;
@@ -137,18 +250,35 @@ void RouterCore::generar_running_config() {
     oss << std::endl;
   }
 
+  // Rutas estáticas
+  for (const auto &ruta : rutas_estaticas) {
+    oss << "ip route " << ruta.destino << " " << ruta.netmask << " "
+        << ruta.siguiente_salto << std::endl;
+  }
+  if (!rutas_estaticas.empty())
+    oss << std::endl;
+
   // OSPF
   if (ospf_config.active) {
     oss << "!" << std::endl;
     oss << "router ospf " << ospf_config.process_id << std::endl;
     if (!ospf_config.router_id.empty())
       oss << " router-id " << ospf_config.router_id << std::endl;
+    const ThrottleSPF &throttle = ospf_config.throttle_spf;
+    if (!(throttle == ThrottleSPF{}))
+      oss << " timers throttle spf " << throttle.inicial << " "
+          << throttle.espera << " " << throttle.maximo << std::endl;
 
     for (const auto &net : ospf_config.networks) {
       oss << " network " << net.network << " " << net.wildcard << " area "
           << net.area << std::endl;
     }
 
+    for (const auto &rango : ospf_config.ranges) {
+      oss << " area " << rango.area << " range " << rango.network << " "
+          << rango.netmask << std::endl;
+    }
+
     for (const auto &p_intf : ospf_config.passive_interfaces) {
       oss << " passive-interface " << p_intf << std::endl;
     }
@@ -173,87 +303,444 @@ void RouterCore::process_password(const std::string &pwd, bool hashear) {
   }
 }
 
-void RouterCore::handle_incoming_packet(const std::string &iface,
-                                        const SimulatedPacket &pkt) {
-  // 1. Detectar si el paquete es para este router
-  bool es_para_mi = false;
-  for (const auto &intf : interfaces) {
-    if (intf.up && intf.ip == pkt.dst_ip) {
-      es_para_mi = true;
-      break;
-    }
+// Plano de datos: sólo lee el EstadoForwarding publicado, nunca 'interfaces'
+// ni 'rutas', que la CLI modifica en paralelo
+void RouterCore::handle_incoming_packet(int ifindex, PacketRef &pkt) {
+  handle_incoming_burst(ifindex, &pkt, 1);
+}
+
+// Una ráfaga completa se procesa con una sola lectura del estado publicado
+void RouterCore::handle_incoming_burst(int ifindex, PacketRef *pkts,
+                                       std::size_t n) {
+  stats_fwd.recibidos += n;
+
+  rcu::SeccionLectura lectura;
+  const EstadoForwarding *estado = estado_fwd.leer();
+  if (!estado)
+    return;
+
+  for (std::size_t i = 0; i < n; ++i)
+    procesar_paquete(*estado, ifindex, pkts[i]);
+}
+
+// Los paquetes se modifican en su propio buffer. Si alguien más tiene una
+// referencia al buffer, se trabaja sobre una copia del pool.
+bool RouterCore::tomar_exclusivo(PacketRef &pkt) {
+  if (pkt.unique())
+    return true;
+  if (!net_engine)
+    return false;
+  pkt = net_engine->pool().clone(*pkt);
+  if (!pkt) {
+    stats_fwd.drop_sin_buffer++;
+    return false;
+  }
+  return true;
+}
+
+void RouterCore::procesar_paquete(const EstadoForwarding &estado, int ifindex,
+                                  PacketRef &ref) {
+  const SimulatedPacket &pkt = *ref;
+
+  // Protocolos de ruteo: van al plano de control, nunca se reenvían
+  if (pkt.protocol == PROTO_OSPF &&
+      (pkt.dst_ip == OSPF_ALL_SPF_ROUTERS || pkt.dst_ip == OSPF_ALL_D_ROUTERS ||
+       estado.locales.contiene(pkt.dst_ip))) {
+    stats_fwd.locales++;
+    if (ProcesoOSPF *proceso = ospf())
+      proceso->recibir(ifindex, pkt);
+    return;
   }
 
-  if (es_para_mi) {
+  // 1. Detectar si el paquete es para este router
+  if (estado.locales.contiene(pkt.dst_ip)) {
+    stats_fwd.locales++;
+
     // Si es ICMP (Ping), respondemos automáticamente (Echo Reply)
-    if (pkt.protocol == 1) {
-      if (std::string(pkt.payload).find("ECHO_REQUEST") != std::string::npos) {
-        SimulatedPacket reply;
-        reply.protocol = 1;
-        std::strncpy(reply.src_ip, pkt.dst_ip, 16);
-        std::strncpy(reply.dst_ip, pkt.src_ip, 16);
-        std::strncpy(reply.payload, "ECHO_REPLY", 1024);
-        reply.payload_len = std::strlen(reply.payload);
-
-        if (net_engine) {
-          net_engine->send_packet(iface, reply);
-        }
-      } else if (std::string(pkt.payload).find("ECHO_REPLY") != std::string::npos) {
-         std::cout << "\n[ICMP] Reply from " << pkt.src_ip << ": bytes=" << pkt.payload_len << " TTL=" << (int)pkt.ttl << std::endl;
+    if (icmp_es(pkt, "ECHO_REQUEST")) {
+      // La solicitud se convierte en la respuesta dentro del mismo buffer; el
+      // identificador, la secuencia y el relleno vuelven tal cual
+      if (!tomar_exclusivo(ref))
+        return;
+      SimulatedPacket &reply = *ref;
+      std::swap(reply.src_ip, reply.dst_ip);
+      reply.ttl = 64;
+      std::memset(reply.payload, 0, ICMP_MARCA);
+      std::memcpy(reply.payload, "ECHO_REPLY", 10);
+
+      // La respuesta sigue la tabla de ruteo; si no hay ruta de regreso se
+      // devuelve por la interfaz de entrada
+      if (!enviar_por_ruta(estado, reply) && net_engine) {
+        net_engine->send_packet(ifindex, reply);
       }
+    } else if (icmp_es(pkt, "ECHO_REPLY")) {
+      if (!entregar_eco(pkt))
+        std::cout << "\n[ICMP] Reply from " << ip_a_texto(pkt.src_ip)
+                  << ": bytes=" << pkt.payload_len << " TTL=" << (int)pkt.ttl
+                  << std::endl;
+    } else {
+      receptor_trafico.registrar(pkt); // Tráfico del generador
     }
     return;
   }
 
-  // 2. Si no es para mí, logueamos (en el futuro aquí iría el reenvío/forwarding)
-  std::cout << "\n[Router] Forwarding/Drop: Paquete recibido en " << iface << ":" << std::endl;
-  std::cout << "  Origen: " << pkt.src_ip << " -> Destino: " << pkt.dst_ip
-            << std::endl;
+  // 2. Si no es para mí, se reenvía según la tabla de ruteo
+  reenviar_paquete(estado, ref);
 }
 
-InfoRoute *RouterCore::find_route(const std::string &dest_ip) {
-  // Búsqueda simple de ruta (Longest Prefix Match simplificado)
-  for (auto &ruta : rutas) {
-    if (calcular_red(dest_ip, ruta.netmask) == ruta.destino) {
-      return &ruta;
+// Etapa de forwarding: TTL, búsqueda en la tabla y salida por la interfaz.
+// Se permite reenviar por la misma interfaz de entrada.
+void RouterCore::reenviar_paquete(const EstadoForwarding &estado,
+                                  PacketRef &ref) {
+  const SimulatedPacket &pkt = *ref;
+
+  // TTL expirado: el paquete no puede dar otro salto
+  if (pkt.ttl <= 1) {
+    stats_fwd.drop_ttl++;
+    return;
+  }
+
+  uint32_t indice = estado.fib.buscar(pkt.dst_ip);
+  if (indice == FibTrie::SIN_VALOR) {
+    stats_fwd.drop_sin_ruta++;
+    return;
+  }
+
+  int salida = estado.rutas[indice].salida;
+  if (salida < 0 || !estado.interfaces[salida].up) {
+    stats_fwd.drop_interfaz_caida++;
+    return;
+  }
+  int enlace = estado.interfaces[salida].enlace;
+
+  // El TTL se decrementa en el propio buffer, sin copiar el paquete
+  if (!tomar_exclusivo(ref))
+    return;
+  ref->ttl--;
+
+  // Con un TxBatch activo (workers del pipeline) el envío se agrupa por
+  // interfaz; si no, sale en el momento
+  if (!net_engine ||
+      !net_engine->queue_packet(enlace, std::move(ref))) {
+    stats_fwd.drop_tx++;
+    return;
+  }
+  stats_fwd.reenviados++;
+}
+
+// Enviar un paquete originado por el router siguiendo la tabla de ruteo
+bool RouterCore::enviar_por_ruta(const EstadoForwarding &estado,
+                                 const SimulatedPacket &pkt) {
+  uint32_t indice = estado.fib.buscar(pkt.dst_ip);
+  if (indice == FibTrie::SIN_VALOR || !net_engine)
+    return false;
+
+  int salida = estado.rutas[indice].salida;
+  if (salida < 0 || !estado.interfaces[salida].up)
+    return false;
+
+  return net_engine->send_packet(estado.interfaces[salida].enlace, pkt);
+}
+
+bool RouterCore::originar_paquete(const SimulatedPacket &pkt) {
+  rcu::SeccionLectura lectura;
+  const EstadoForwarding *estado = estado_fwd.leer();
+  return estado && enviar_por_ruta(*estado, pkt);
+}
+
+// Dirección de la interfaz por la que sale el tráfico hacia 'destino'
+bool RouterCore::direccion_origen(uint32_t destino, uint32_t &origen) {
+  rcu::SeccionLectura lectura;
+  const EstadoForwarding *estado = estado_fwd.leer();
+  if (!estado)
+    return false;
+  uint32_t indice = estado->fib.buscar(destino);
+  if (indice == FibTrie::SIN_VALOR)
+    return false;
+  int salida = estado->rutas[indice].salida;
+  if (salida < 0 || !estado->interfaces[salida].up)
+    return false;
+  origen = estado->interfaces[salida].ip;
+  return origen != 0;
+}
+
+// Entregar un Echo Reply a la sesión de ping que lo pidió. Se llama dentro de
+// la sección de lectura del hilo RX, así que el registro no se libera mientras
+// se usa.
+bool RouterCore::entregar_eco(const SimulatedPacket &pkt) {
+  if (pkt.payload_len < sizeof(CabeceraEcho))
+    return false;
+  const RegistroEcos *registro = ecos_.leer();
+  if (!registro)
+    return false;
+
+  CabeceraEcho eco;
+  std::memcpy(&eco, pkt.payload, sizeof(eco));
+  uint16_t id = ntohs(eco.id);
+  for (const auto &sesion : registro->sesiones) {
+    if (sesion->id() == id) {
+      sesion->registrar_respuesta(eco, ahora_ns());
+      return true;
+    }
+  }
+  return false;
+}
+
+// El registro se copia en cada cambio: las sesiones empiezan y terminan a
+// ritmo humano y así el hilo RX lo lee sin locks
+void RouterCore::agregar_sesion_ping(std::shared_ptr<SesionPing> sesion) {
+  std::lock_guard<std::mutex> lock(mutex_ecos_);
+  auto nuevo = std::make_unique<RegistroEcos>();
+  {
+    rcu::SeccionLectura lectura;
+    if (const RegistroEcos *actual = ecos_.leer())
+      *nuevo = *actual;
+  }
+  nuevo->sesiones.push_back(std::move(sesion));
+  ecos_.publicar(std::move(nuevo));
+}
+
+void RouterCore::quitar_sesion_ping(const SesionPing *sesion) {
+  std::lock_guard<std::mutex> lock(mutex_ecos_);
+  auto nuevo = std::make_unique<RegistroEcos>();
+  {
+    rcu::SeccionLectura lectura;
+    if (const RegistroEcos *actual = ecos_.leer())
+      *nuevo = *actual;
+  }
+  std::erase_if(nuevo->sesiones,
+                [sesion](const auto &s) { return s.get() == sesion; });
+  ecos_.publicar(std::move(nuevo));
+}
+
+// Construir una copia inmutable de interfaces y rutas y publicarla para los
+// hilos de recepción. La versión anterior se libera cuando ningún lector la
+// está usando. set_route() no publica por sí sola para que las cargas masivas
+// de rutas no generen una copia por cada ruta.
+void RouterCore::publicar_estado() {
+  auto estado = std::make_unique<EstadoForwarding>();
+  estado->version = ++version_estado_;
+
+  // Las direcciones locales salen de las interfaces activas; este es el único
+  // lugar donde se construye la tabla, y se llama en cada cambio de IP o de
+  // estado de una interfaz
+  std::vector<uint32_t> locales;
+  estado->interfaces.reserve(interfaces.size());
+  for (const auto &intf : interfaces) {
+    InterfazForwarding copia;
+    copia.enlace = intf.padre >= 0 ? intf.padre : intf.ifindex;
+    copia.up = intf.up;
+    if (!ip_desde_texto(intf.ip, copia.ip))
+      copia.ip = 0;
+    if (intf.up) {
+      locales.push_back(copia.ip);
+      for (const auto &sec : intf.secundarias) {
+        uint32_t ip;
+        if (ip_desde_texto(sec.ip, ip))
+          locales.push_back(ip);
+      }
     }
+    estado->interfaces.push_back(std::move(copia));
   }
-  return nullptr;
+
+  estado->rutas.reserve(rutas.size());
+  for (const auto &ruta : rutas) {
+    RutaForwarding copia;
+    copia.salida = ruta.ifindex;
+    if (!ip_desde_texto(ruta.via, copia.via))
+      copia.via = 0;
+    estado->rutas.push_back(copia);
+  }
+
+  estado->locales.construir(locales);
+  estado->fib = fib;
+  estado_fwd.publicar(std::move(estado));
+}
+
+InfoRoute *RouterCore::find_route(const std::string &dest_ip) {
+  uint32_t ip;
+  if (!ip_desde_texto(dest_ip, ip))
+    return nullptr;
+  return find_route(ip);
+}
+
+// Longest Prefix Match sobre la FIB, sin reservar memoria
+InfoRoute *RouterCore::find_route(uint32_t dest_ip) {
+  uint32_t indice = fib.buscar(dest_ip);
+  if (indice == FibTrie::SIN_VALOR)
+    return nullptr;
+  return &rutas[indice];
 }
 
 // Lógica de descubrimiento de rutas directamente conectadas
 void RouterCore::recalcular_rutas_connected() {
-  // 1. Eliminar rutas previas de tipo "C" (Connected)
-  auto it = rutas.begin();
-  while (it != rutas.end()) {
-    if (it->protocolo == "C")
-      it = rutas.erase(it);
-    else
-      ++it;
-  }
+  // 1. Eliminar rutas previas de tipo "C" (Connected) en una sola pasada
+  std::erase_if(rutas, [](const InfoRoute &r) { return r.protocolo == "C"; });
+  reconstruir_fib(); // Los índices de las rutas restantes cambiaron
 
   // 2. Para cada interfaz activa con IP, calcular su red y añadir ruta
   for (const auto &intf : interfaces) {
-    if (intf.up && !intf.ip.empty() && !intf.netmask.empty()) {
+    if (!intf.up)
+      continue;
+    if (!intf.ip.empty() && !intf.netmask.empty()) {
       std::string red = calcular_red(intf.ip, intf.netmask);
-      set_route(red, intf.netmask, "directly connected", intf.nombre, "C");
+      set_route(red, intf.netmask, "directly connected", intf.ifindex, "C");
+    }
+    for (const auto &sec : intf.secundarias) {
+      std::string red = calcular_red(sec.ip, sec.netmask);
+      set_route(red, sec.netmask, "directly connected", intf.ifindex, "C");
     }
   }
+
+  // 3. Las rutas estáticas dependen de las conectadas
+  recalcular_rutas_estaticas();
+
+  // 4. OSPF corre sobre las interfaces activas con dirección
+  actualizar_ospf();
+}
+
+// Resolver las rutas estáticas configuradas contra las rutas conectadas
+void RouterCore::recalcular_rutas_estaticas() {
+  std::erase_if(rutas, [](const InfoRoute &r) { return r.protocolo == "S"; });
+  reconstruir_fib();
+
+  for (const auto &estatica : rutas_estaticas) {
+    std::string red = calcular_red(estatica.destino, estatica.netmask);
+
+    // Siguiente salto como interfaz de salida
+    InfoInterfaz *intf = get_interfaz(estatica.siguiente_salto);
+    if (intf) {
+      if (intf->up)
+        set_route(red, estatica.netmask, "directly connected", intf->ifindex,
+                  "S");
+      continue;
+    }
+
+    // Siguiente salto como IP: debe ser alcanzable por una ruta conectada
+    InfoRoute *conectada = find_route(estatica.siguiente_salto);
+    if (conectada && conectada->protocolo == "C")
+      set_route(red, estatica.netmask, estatica.siguiente_salto,
+                conectada->ifindex, "S");
+  }
+
+  publicar_estado();
 }
 
 // Utilidad para calcular la dirección de red (A.B.C.D & M.M.M.M)
 std::string RouterCore::calcular_red(const std::string &ip,
                                      const std::string &mask) {
-  unsigned int i1, i2, i3, i4;
-  unsigned int m1, m2, m3, m4;
-
-  // Analizar las cadenas de texto para encontrar los cuatro octetos
-  if (sscanf(ip.c_str(), "%u.%u.%u.%u", &i1, &i2, &i3, &i4) != 4)
-    return "0.0.0.0";
-  if (sscanf(mask.c_str(), "%u.%u.%u.%u", &m1, &m2, &m3, &m4) != 4)
+  uint32_t ip_bin, mask_bin;
+  if (!ip_desde_texto(ip, ip_bin) || !ip_desde_texto(mask, mask_bin))
     return "0.0.0.0";
+  return ip_a_texto(ip_bin & mask_bin);
+}
 
-  std::ostringstream oss;
-  oss << (i1 & m1) << "." << (i2 & m2) << "." << (i3 & m3) << "." << (i4 & m4);
-  return oss.str();
-}
\ No newline at end of file
+// Interfaces que cubre algún 'network' (la primera sentencia que coincide
+// define el área) y router-id: el configurado, o la mayor dirección de una
+// Loopback activa, o la mayor de cualquier interfaz activa. Como en IOS, el
+// elegido solo se conserva hasta que se reinicia el proceso: cambiar
+// direcciones o bajar esa Loopback no lo mueve (tiraría todas las
+// adyacencias)
+void RouterCore::actualizar_ospf() {
+  if (!ospf_) {
+    if (!ospf_config.active || !temporizadores)
+      return;
+    ospf_ = std::make_unique<ProcesoOSPF>(*this, *temporizadores);
+    ospf_activo_.store(ospf_.get(), std::memory_order_release);
+  }
+  if (!ospf_config.active) {
+    router_id_auto_ = 0;
+    ospf_->configurar("", 0, {});
+    return;
+  }
+
+  std::vector<ConfigInterfazOSPF> habilitadas;
+  uint32_t mayor_loopback = 0, mayor = 0;
+  for (const auto &intf : interfaces) {
+    uint32_t ip, mascara;
+    if (!intf.up || !ip_desde_texto(intf.ip, ip) ||
+        !ip_desde_texto(intf.netmask, mascara))
+      continue;
+    bool loopback = intf.nombre.rfind("Loopback", 0) == 0;
+    if (loopback)
+      mayor_loopback = std::max(mayor_loopback, ip);
+    else
+      mayor = std::max(mayor, ip);
+
+    for (const auto &red : ospf_config.networks) {
+      uint32_t direccion, wildcard;
+      if (!ip_desde_texto(red.network, direccion) ||
+          !ip_desde_texto(red.wildcard, wildcard) ||
+          (ip & ~wildcard) != (direccion & ~wildcard))
+        continue;
+      ConfigInterfazOSPF config;
+      config.ifindex = intf.ifindex;
+      config.enlace = intf.padre >= 0 ? intf.padre : intf.ifindex;
+      config.nombre = intf.nombre;
+      config.ip = ip;
+      config.mascara = mascara;
+      config.area = static_cast<uint32_t>(red.area);
+      config.loopback = loopback;
+      config.pasiva =
+          std::find(ospf_config.passive_interfaces.begin(),
+                    ospf_config.passive_interfaces.end(),
+                    intf.nombre) != ospf_config.passive_interfaces.end();
+      if (intf.ospf_hello)
+        config.hello = intf.ospf_hello;
+      config.dead = intf.ospf_dead ? intf.ospf_dead : 4u * config.hello;
+      if (intf.ospf_cost)
+        config.costo = intf.ospf_cost;
+      habilitadas.push_back(std::move(config));
+      break;
+    }
+  }
+
+  std::vector<RangoArea> rangos;
+  for (const auto &rango : ospf_config.ranges) {
+    uint32_t red, mascara;
+    if (ip_desde_texto(rango.network, red) &&
+        ip_desde_texto(rango.netmask, mascara))
+      rangos.push_back(
+          {static_cast<uint32_t>(rango.area), red & mascara, mascara});
+  }
+
+  uint32_t router_id = 0;
+  if (!ip_desde_texto(ospf_config.router_id, router_id) || router_id == 0) {
+    if (!router_id_auto_)
+      router_id_auto_ = mayor_loopback ? mayor_loopback : mayor;
+    router_id = router_id_auto_;
+  }
+  ospf_->configurar(ospf_config.process_id, router_id, std::move(habilitadas),
+                    ospf_config.throttle_spf, std::move(rangos));
+}
+
+// 'clear ip ospf process': adyacencias y base de datos desde cero, y un
+// router-id automático elegido de nuevo
+void RouterCore::reiniciar_ospf() {
+  if (!ospf_ || !ospf_config.active)
+    return;
+  router_id_auto_ = 0;
+  ospf_->configurar("", 0, {});
+  actualizar_ospf();
+}
+
+// try_lock: la rueda es compartida por todos los routers del emulador y no
+// puede quedarse esperando a que termine un comando (que además puede estar
+// esperando el mutex del proceso OSPF). El proceso vuelve a intentar.
+bool RouterCore::instalar_rutas_ospf(const std::vector<RutaOSPF> &nuevas) {
+  std::unique_lock<std::mutex> lock(mutex_config, std::try_to_lock);
+  if (!lock.owns_lock())
+    return false;
+
+  std::erase_if(rutas, [](const InfoRoute &r) { return r.protocolo == "O"; });
+  reconstruir_fib();
+  for (const auto &ruta : nuevas) {
+    InfoRoute *instalada =
+        set_route(ip_a_texto(ruta.red), ip_a_texto(ruta.mascara),
+                  ip_a_texto(ruta.via), ruta.salida, "O");
+    instalada->metrica = ruta.costo;
+    instalada->inter_area = ruta.inter_area;
+  }
+  publicar_estado();
+  return true;
+}
@@ -0,0 +1,255 @@
+#include "../include/shm_link.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint32_t SHM_MAGIC = 0x53484d4c; // "SHML"
+constexpr uint32_t SHM_VERSION = 1;
+constexpr std::size_t SLOT_DATOS = sizeof(WireHeader) + PACKET_MAX_PAYLOAD;
+
+} // namespace
+
+struct ShmSlot {
+  uint32_t len;
+  char datos[SLOT_DATOS];
+};
+
+struct ShmAnillo {
+  alignas(64) std::atomic<uint32_t> cabeza; // Consumidor
+  alignas(64) std::atomic<uint32_t> cola;   // Productor
+  alignas(64) std::atomic<uint32_t> timbre; // Palabra del futex
+  std::atomic<uint32_t> dormido;            // El consumidor espera en el futex
+  ShmSlot slots[ShmLink::SLOTS];
+};
+
+struct ShmSegmento {
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint32_t slots;
+  uint32_t slot_size;
+  std::atomic<int32_t> pid[2]; // Proceso dueño de cada lado (0 = libre)
+  ShmAnillo anillo[2];         // anillo[s]: lo que transmite el lado s
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "El segmento compartido necesita atómicos sin locks");
+
+#ifdef __linux__
+
+namespace {
+
+void futex_wait(std::atomic<uint32_t> &palabra, uint32_t valor) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&palabra), FUTEX_WAIT,
+          valor, nullptr, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t> &palabra) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&palabra), FUTEX_WAKE,
+          INT_MAX, nullptr, nullptr, 0);
+}
+
+bool proceso_vivo(int32_t pid) {
+  return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+} // namespace
+
+ShmLink::~ShmLink() {
+  if (!seg_)
+    return;
+  seg_->pid[side_].store(0);
+  // El último en salir borra el segmento
+  if (!proceso_vivo(seg_->pid[1 - side_].load()))
+    shm_unlink(path_.c_str());
+  munmap(seg_, len_);
+}
+
+bool ShmLink::open(const std::string &name) {
+  name_ = name;
+  path_ = "/router-" + name;
+  len_ = sizeof(ShmSegmento);
+
+  bool creado = true;
+  int fd = shm_open(path_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    creado = false;
+    fd = shm_open(path_.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    perror("Error en shm_open");
+    return false;
+  }
+  if (creado && ftruncate(fd, static_cast<off_t>(len_)) < 0) {
+    perror("Error en ftruncate");
+    close(fd);
+    shm_unlink(path_.c_str());
+    return false;
+  }
+
+  void *mem = mmap(nullptr, len_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    perror("Error en mmap del enlace shm");
+    return false;
+  }
+  seg_ = static_cast<ShmSegmento *>(mem);
+
+  if (creado) {
+    // ftruncate deja todo en cero: sólo falta la cabecera. 'magic' va al
+    // final para que el otro lado no use el segmento a medio preparar.
+    seg_->version = SHM_VERSION;
+    seg_->slots = SLOTS;
+    seg_->slot_size = sizeof(ShmSlot);
+    seg_->magic.store(SHM_MAGIC, std::memory_order_release);
+  } else {
+    auto limite = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (seg_->magic.load(std::memory_order_acquire) != SHM_MAGIC &&
+           std::chrono::steady_clock::now() < limite)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (seg_->magic.load() != SHM_MAGIC || seg_->version != SHM_VERSION ||
+        seg_->slots != SLOTS || seg_->slot_size != sizeof(ShmSlot)) {
+      std::cerr << "Error: segmento " << path_ << " incompatible" << std::endl;
+      munmap(seg_, len_);
+      seg_ = nullptr;
+      return false;
+    }
+  }
+
+  // Tomar un lado libre, o el de un proceso que ya terminó
+  int32_t yo = static_cast<int32_t>(getpid());
+  for (int s = 0; s < 2 && side_ < 0; ++s) {
+    int32_t actual = seg_->pid[s].load();
+    if (actual != 0 && proceso_vivo(actual))
+      continue;
+    if (seg_->pid[s].compare_exchange_strong(actual, yo))
+      side_ = s;
+  }
+  if (side_ < 0) {
+    std::cerr << "Error: el enlace shm " << name_ << " ya tiene dos extremos"
+              << std::endl;
+    munmap(seg_, len_);
+    seg_ = nullptr;
+    return false;
+  }
+
+  // Lo que quedó de un proceso anterior en nuestra cola de entrada se descarta
+  ShmAnillo &rx = rx_ring();
+  rx.cabeza.store(rx.cola.load());
+  return true;
+}
+
+void ShmLink::wait(const std::atomic<bool> &running) {
+  ShmAnillo &rx = rx_ring();
+  uint32_t timbre = rx.timbre.load();
+  rx.dormido.store(1);
+  // Volver a mirar la cola después de anunciarse dormido (ver send()). Quien
+  // detiene el hilo apaga 'running' antes de tocar el timbre.
+  if (running.load() &&
+      rx.cola.load() == rx.cabeza.load(std::memory_order_relaxed))
+    futex_wait(rx.timbre, timbre);
+  rx.dormido.store(0, std::memory_order_relaxed);
+}
+
+void ShmLink::wake() {
+  ShmAnillo &rx = rx_ring();
+  rx.timbre.fetch_add(1);
+  futex_wake(rx.timbre);
+}
+
+std::size_t ShmLink::send(const SimulatedPacket *const *packets,
+                          std::size_t count) {
+  std::lock_guard<std::mutex> lock(tx_mutex_);
+  ShmAnillo &tx = tx_ring();
+  uint32_t cola = tx.cola.load(std::memory_order_relaxed);
+  uint32_t libres = SLOTS - (cola - tx.cabeza.load(std::memory_order_acquire));
+  std::size_t n = count < libres ? count : libres;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const SimulatedPacket &pkt = *packets[i];
+    ShmSlot &slot = tx.slots[(cola + i) & (SLOTS - 1)];
+    WireHeader hdr;
+    codificar_cabecera(pkt, hdr);
+    std::memcpy(slot.datos, &hdr, sizeof(hdr));
+    std::memcpy(slot.datos + sizeof(hdr), pkt.payload, pkt.payload_len);
+    slot.len = static_cast<uint32_t>(pkt.wire_size());
+  }
+  if (n == 0)
+    return 0;
+
+  // seq_cst: publicar la cola antes de leer 'dormido' (el consumidor hace lo
+  // simétrico), así nunca se pierde un despertar
+  tx.cola.store(cola + static_cast<uint32_t>(n));
+  if (tx.dormido.load()) {
+    tx.timbre.fetch_add(1);
+    futex_wake(tx.timbre);
+  }
+  return n;
+}
+
+std::size_t ShmLink::receive(PacketPool &pool, PacketRef *out, std::size_t max,
+                             std::size_t &invalid, std::size_t &no_buffer) {
+  ShmAnillo &rx = rx_ring();
+  uint32_t cabeza = rx.cabeza.load(std::memory_order_relaxed);
+  uint32_t cola = rx.cola.load(std::memory_order_acquire);
+  std::size_t validos = 0;
+
+  while (cabeza != cola && validos < max) {
+    const ShmSlot &slot = rx.slots[cabeza & (SLOTS - 1)];
+    WireHeader hdr;
+    std::size_t len = slot.len;
+    if (len > sizeof(slot.datos))
+      len = 0;
+    std::memcpy(&hdr, slot.datos, len < sizeof(hdr) ? len : sizeof(hdr));
+
+    PacketRef ref = pool.alloc();
+    if (!ref) {
+      no_buffer++;
+    } else if (!decodificar_cabecera(hdr, len, *ref)) {
+      invalid++;
+    } else {
+      std::memcpy(ref->payload, slot.datos + sizeof(hdr), ref->payload_len);
+      out[validos++] = std::move(ref);
+    }
+    cabeza++;
+  }
+  rx.cabeza.store(cabeza, std::memory_order_release);
+  return validos;
+}
+
+#else // Sin futex ni shm_open: los enlaces shm no están disponibles
+
+ShmLink::~ShmLink() {}
+bool ShmLink::open(const std::string &) {
+  std::cerr << "Error: enlaces shm no soportados en esta plataforma"
+            << std::endl;
+  return false;
+}
+void ShmLink::wait(const std::atomic<bool> &) {}
+void ShmLink::wake() {}
+std::size_t ShmLink::send(const SimulatedPacket *const *, std::size_t) {
+  return 0;
+}
+std::size_t ShmLink::receive(PacketPool &, PacketRef *, std::size_t,
+                             std::size_t &, std::size_t &) {
+  return 0;
+}
+
+#endif
+
+ShmAnillo &ShmLink::tx_ring() { return seg_->anillo[side_]; }
+ShmAnillo &ShmLink::rx_ring() { return seg_->anillo[1 - side_]; }
@@ -0,0 +1,456 @@
+#include "../include/spf.hpp"
+#include <algorithm>
+
+// ------- HeapIndexado --------
+
+void HeapIndexado::insertar_o_bajar(uint32_t v, uint32_t clave) {
+  uint32_t pos = posicion_[v];
+  if (pos == NINGUNO) {
+    datos_.push_back({clave, v});
+    posicion_[v] = static_cast<uint32_t>(datos_.size() - 1);
+    subir(datos_.size() - 1);
+    return;
+  }
+  if (clave >= datos_[pos].clave)
+    return;
+  datos_[pos].clave = clave;
+  subir(pos);
+}
+
+uint32_t HeapIndexado::extraer() {
+  Entrada minimo = datos_.front();
+  posicion_[minimo.vertice] = NINGUNO;
+  Entrada ultimo = datos_.back();
+  datos_.pop_back();
+  if (!datos_.empty()) {
+    colocar(0, ultimo);
+    hundir(0);
+  }
+  return minimo.vertice;
+}
+
+void HeapIndexado::limpiar() {
+  for (const auto &e : datos_)
+    posicion_[e.vertice] = NINGUNO;
+  datos_.clear();
+}
+
+void HeapIndexado::subir(std::size_t i) {
+  Entrada e = datos_[i];
+  while (i > 0) {
+    std::size_t padre = (i - 1) / 2;
+    if (datos_[padre].clave <= e.clave)
+      break;
+    colocar(i, datos_[padre]);
+    i = padre;
+  }
+  colocar(i, e);
+}
+
+void HeapIndexado::hundir(std::size_t i) {
+  Entrada e = datos_[i];
+  std::size_t n = datos_.size();
+  while (true) {
+    std::size_t hijo = 2 * i + 1;
+    if (hijo >= n)
+      break;
+    if (hijo + 1 < n && datos_[hijo + 1].clave < datos_[hijo].clave)
+      ++hijo;
+    if (datos_[hijo].clave >= e.clave)
+      break;
+    colocar(i, datos_[hijo]);
+    i = hijo;
+  }
+  colocar(i, e);
+}
+
+// ------- CalculoSPF --------
+
+void CalculoSPF::reiniciar(uint32_t raiz) {
+  vertices_.clear();
+  por_router_id_.clear();
+  pendientes_.clear();
+  prefijos_.clear();
+  heap_ = HeapIndexado();
+  raiz_ = raiz ? vertice(raiz) : NINGUNO;
+  completo_ = true;
+}
+
+uint32_t CalculoSPF::vertice(uint32_t router_id) {
+  auto [it, nuevo] = por_router_id_.try_emplace(
+      router_id, static_cast<uint32_t>(vertices_.size()));
+  if (nuevo) {
+    vertices_.emplace_back();
+    vertices_.back().router_id = router_id;
+    heap_.redimensionar(vertices_.size());
+  }
+  return it->second;
+}
+
+// Leer el router-LSA del vértice. Los routers que nombra se crean como
+// vértices aunque todavía no haya llegado su LSA.
+void CalculoSPF::cargar(uint32_t v, const LSDB &lsdb) {
+  uint32_t router_id = vertices_[v].router_id;
+  const LSA *lsa = lsdb.buscar({LSA_ROUTER, router_id, router_id});
+  std::vector<EnlaceRouter> enlaces;
+  bool presente = lsa && !lsa->max_age(ahora_) &&
+                  leer_router_lsa(lsa->datos.data(), lsa->datos.size(),
+                                  enlaces);
+
+  std::vector<Arista> aristas;
+  std::vector<Stub> stubs;
+  for (const auto &e : enlaces) {
+    if (e.tipo == ENLACE_P2P)
+      aristas.push_back({vertice(e.id), e.datos, e.metrica});
+    else if (e.tipo == ENLACE_STUB)
+      stubs.push_back({e.id & e.datos, e.datos, e.metrica});
+  }
+  Vertice &vert = vertices_[v];
+  vert.presente = presente;
+  vert.aristas = std::move(aristas);
+  vert.stubs = std::move(stubs);
+}
+
+// Costo de la arista desde -> hasta. Sólo existe si cada uno nombra al otro
+// (RFC 2328, 16.1, paso 2b); entre dos enlaces paralelos gana el más barato.
+uint32_t CalculoSPF::costo(uint32_t desde, uint32_t hasta,
+                           uint32_t *datos) const {
+  const Vertice &a = vertices_[desde];
+  const Vertice &b = vertices_[hasta];
+  if (!a.presente || !b.presente)
+    return INFINITO;
+  uint32_t mejor = INFINITO;
+  for (const auto &arista : a.aristas) {
+    if (arista.vecino == hasta && arista.metrica < mejor) {
+      mejor = arista.metrica;
+      if (datos)
+        *datos = arista.datos;
+    }
+  }
+  if (mejor == INFINITO)
+    return INFINITO;
+  for (const auto &arista : b.aristas)
+    if (arista.vecino == desde)
+      return mejor;
+  return INFINITO;
+}
+
+void CalculoSPF::desenganchar(uint32_t v) {
+  uint32_t padre = vertices_[v].padre;
+  if (padre == NINGUNO)
+    return;
+  auto &hijos = vertices_[padre].hijos;
+  auto it = std::find(hijos.begin(), hijos.end(), v);
+  if (it != hijos.end()) {
+    *it = hijos.back();
+    hijos.pop_back();
+  }
+  vertices_[v].padre = NINGUNO;
+}
+
+void CalculoSPF::tocar(uint32_t v) {
+  if (vertices_[v].marca == marca_)
+    return;
+  vertices_[v].marca = marca_;
+  tocados_.push_back(v);
+}
+
+// Los vecinos directos de la raíz heredan la interfaz y el siguiente salto
+// del enlace; el resto, los de su padre
+void CalculoSPF::relajar(uint32_t desde, uint32_t hasta,
+                         const ResolverSalto &resolver) {
+  if (hasta == raiz_ || vertices_[desde].distancia == INFINITO)
+    return;
+  uint32_t datos = 0;
+  uint32_t c = costo(desde, hasta, &datos);
+  if (c == INFINITO)
+    return;
+  uint32_t distancia = vertices_[desde].distancia + c;
+  if (distancia >= vertices_[hasta].distancia)
+    return;
+
+  int salida = vertices_[desde].salida;
+  uint32_t via = vertices_[desde].via;
+  if (desde == raiz_ &&
+      !resolver(vertices_[hasta].router_id, datos, salida, via))
+    return;
+
+  desenganchar(hasta);
+  Vertice &v = vertices_[hasta];
+  v.distancia = distancia;
+  v.padre = desde;
+  v.salida = salida;
+  v.via = via;
+  vertices_[desde].hijos.push_back(hasta);
+  tocar(hasta);
+  heap_.insertar_o_bajar(hasta, distancia);
+}
+
+void CalculoSPF::dijkstra(const ResolverSalto &resolver) {
+  while (!heap_.vacio()) {
+    uint32_t v = heap_.extraer();
+    for (const auto &arista : vertices_[v].aristas)
+      relajar(v, arista.vecino, resolver);
+  }
+}
+
+void CalculoSPF::completo(const LSDB &lsdb, const ResolverSalto &resolver) {
+  lsdb.para_cada([&](const LSA &lsa) {
+    if (lsa.cabecera.tipo == LSA_ROUTER)
+      vertice(lsa.cabecera.anunciante);
+  });
+  for (uint32_t v = 0; v < vertices_.size(); ++v)
+    cargar(v, lsdb);
+
+  for (uint32_t v = 0; v < vertices_.size(); ++v) {
+    Vertice &vert = vertices_[v];
+    vert.distancia = INFINITO;
+    vert.padre = NINGUNO;
+    vert.salida = -1;
+    vert.via = 0;
+    vert.hijos.clear();
+    tocar(v);
+  }
+
+  // Los prefijos se vuelven a armar desde los stubs de todos los vértices
+  for (auto &[clave, prefijo] : prefijos_) {
+    prefijo.anunciantes.clear();
+    prefijos_sucios_.insert(clave);
+  }
+  for (uint32_t v = 0; v < vertices_.size(); ++v)
+    registrar_stubs(v, {});
+
+  if (raiz_ == NINGUNO)
+    return;
+  vertices_[raiz_].distancia = 0;
+  heap_.insertar_o_bajar(raiz_, 0);
+  dijkstra(resolver);
+}
+
+void CalculoSPF::incremental(const LSDB &lsdb, const ResolverSalto &resolver) {
+  struct Cambio {
+    uint32_t desde, hasta;
+    uint32_t antes, datos_antes;
+  };
+  std::vector<uint32_t> invalidar;
+  std::vector<std::pair<uint32_t, uint32_t>> mejorar;
+
+  for (uint32_t router_id : pendientes_) {
+    uint32_t v = vertice(router_id);
+
+    // Costos de las aristas en los dos sentidos antes del cambio
+    std::vector<Cambio> cambios;
+    auto agregar = [&](uint32_t n) {
+      for (const auto &c : cambios)
+        if (c.hasta == n)
+          return;
+      uint32_t ida = 0, vuelta = 0;
+      uint32_t costo_ida = costo(v, n, &ida);
+      uint32_t costo_vuelta = costo(n, v, &vuelta);
+      cambios.push_back({v, n, costo_ida, ida});
+      cambios.push_back({n, v, costo_vuelta, vuelta});
+    };
+    for (const auto &arista : vertices_[v].aristas)
+      agregar(arista.vecino);
+    std::size_t previos = cambios.size();
+    std::vector<Stub> stubs = vertices_[v].stubs;
+
+    cargar(v, lsdb);
+    // Vecinos nuevos: antes no había arista en ningún sentido
+    for (const auto &arista : vertices_[v].aristas) {
+      bool conocido = false;
+      for (std::size_t i = 0; i < previos && !conocido; i += 2)
+        conocido = cambios[i].hasta == arista.vecino;
+      if (!conocido && std::none_of(cambios.begin() + previos, cambios.end(),
+                                    [&](const Cambio &c) {
+                                      return c.hasta == arista.vecino;
+                                    })) {
+        cambios.push_back({v, arista.vecino, INFINITO, 0});
+        cambios.push_back({arista.vecino, v, INFINITO, 0});
+      }
+    }
+
+    for (const auto &c : cambios) {
+      uint32_t datos = 0;
+      uint32_t ahora = costo(c.desde, c.hasta, &datos);
+      // Para la raíz, 'datos' define la interfaz de salida
+      bool otro_enlace = c.desde == raiz_ && datos != c.datos_antes;
+      if (ahora == c.antes && !otro_enlace)
+        continue;
+      if (vertices_[c.hasta].padre == c.desde && (ahora > c.antes || otro_enlace))
+        invalidar.push_back(c.hasta);
+      else if (ahora != INFINITO)
+        mejorar.emplace_back(c.desde, c.hasta);
+    }
+    if (stubs != vertices_[v].stubs)
+      registrar_stubs(v, stubs);
+  }
+
+  // Invalidar los subárboles que colgaban de aristas que empeoraron
+  std::vector<uint32_t> invalidados;
+  while (!invalidar.empty()) {
+    uint32_t v = invalidar.back();
+    invalidar.pop_back();
+    Vertice &vert = vertices_[v];
+    if (vert.invalidado == marca_)
+      continue;
+    vert.invalidado = marca_;
+    invalidados.push_back(v);
+    tocar(v);
+    invalidar.insert(invalidar.end(), vert.hijos.begin(), vert.hijos.end());
+  }
+  for (uint32_t v : invalidados) {
+    desenganchar(v);
+    Vertice &vert = vertices_[v];
+    vert.hijos.clear();
+    vert.distancia = INFINITO;
+    vert.salida = -1;
+    vert.via = 0;
+  }
+
+  // Sembrar cada invalidado desde los vecinos que siguen en el árbol (los
+  // invalidados tienen distancia infinita y relajar los ignora)
+  for (uint32_t v : invalidados)
+    for (const auto &arista : vertices_[v].aristas)
+      relajar(arista.vecino, v, resolver);
+  for (const auto &[desde, hasta] : mejorar)
+    relajar(desde, hasta, resolver);
+  dijkstra(resolver);
+}
+
+// Actualizar qué prefijos anuncia 'v' tras cambiar sus stubs
+void CalculoSPF::registrar_stubs(uint32_t v,
+                                 const std::vector<Stub> &anteriores) {
+  const auto &actuales = vertices_[v].stubs;
+  auto anuncia = [&](uint64_t clave) {
+    return std::any_of(actuales.begin(), actuales.end(), [&](const Stub &s) {
+      return clave_prefijo(s.red, s.mascara) == clave;
+    });
+  };
+  for (const auto &s : anteriores) {
+    uint64_t clave = clave_prefijo(s.red, s.mascara);
+    prefijos_sucios_.insert(clave);
+    if (anuncia(clave))
+      continue;
+    auto &lista = prefijos_[clave].anunciantes;
+    lista.erase(std::remove(lista.begin(), lista.end(), v), lista.end());
+  }
+  for (const auto &s : actuales) {
+    uint64_t clave = clave_prefijo(s.red, s.mascara);
+    prefijos_sucios_.insert(clave);
+    auto &lista = prefijos_[clave].anunciantes;
+    if (std::find(lista.begin(), lista.end(), v) == lista.end())
+      lista.push_back(v);
+  }
+}
+
+// Elegir la mejor ruta al prefijo entre sus anunciantes alcanzables. Las
+// redes que anuncia la propia raíz son conectadas y no generan ruta.
+bool CalculoSPF::elegir_ruta(uint64_t clave, Prefijo &prefijo) {
+  RutaOSPF mejor;
+  bool hay = false;
+  bool propia = false;
+  for (uint32_t a : prefijo.anunciantes) {
+    if (a == raiz_) {
+      propia = true;
+      break;
+    }
+    const Vertice &v = vertices_[a];
+    if (v.distancia == INFINITO || v.salida < 0)
+      continue;
+    for (const auto &s : v.stubs) {
+      if (clave_prefijo(s.red, s.mascara) != clave)
+        continue;
+      uint32_t costo = v.distancia + s.metrica;
+      if (!hay || costo < mejor.costo ||
+          (costo == mejor.costo && v.router_id < mejor.anunciante)) {
+        mejor = {s.red, s.mascara, costo, v.salida, v.via, v.router_id};
+        hay = true;
+      }
+    }
+  }
+  if (propia)
+    hay = false;
+
+  bool cambio = hay != prefijo.tiene_ruta || (hay && !(mejor == prefijo.ruta));
+  prefijo.tiene_ruta = hay;
+  prefijo.ruta = mejor;
+  return cambio;
+}
+
+bool CalculoSPF::calcular(const LSDB &lsdb, const ResolverSalto &resolver,
+                          EjecucionSPF &ejecucion) {
+  ahora_ = std::chrono::steady_clock::now();
+  ejecucion = EjecucionSPF();
+  ejecucion.momento = ahora_;
+  ejecucion.lsas = pendientes_.size();
+  if (!pendientes_.empty())
+    ejecucion.disparador = *pendientes_.begin();
+
+  ++marca_;
+  tocados_.clear();
+  prefijos_sucios_.clear();
+
+  bool todo = completo_ || pendientes_.size() > vertices_.size() / 4 + 1;
+  if (todo)
+    completo(lsdb, resolver);
+  else
+    incremental(lsdb, resolver);
+  pendientes_.clear();
+  completo_ = false;
+
+  // Los prefijos de los vértices cuya distancia o salida cambió
+  for (uint32_t v : tocados_)
+    for (const auto &s : vertices_[v].stubs)
+      prefijos_sucios_.insert(clave_prefijo(s.red, s.mascara));
+
+  for (uint64_t clave : prefijos_sucios_) {
+    auto it = prefijos_.find(clave);
+    if (it == prefijos_.end())
+      continue;
+    if (elegir_ruta(clave, it->second))
+      ejecucion.rutas++;
+    if (it->second.anunciantes.empty() && !it->second.tiene_ruta)
+      prefijos_.erase(it);
+  }
+
+  ejecucion.tipo = todo ? EjecucionSPF::Tipo::COMPLETO
+                   : tocados_.empty() ? EjecucionSPF::Tipo::PARCIAL
+                                      : EjecucionSPF::Tipo::INCREMENTAL;
+  ejecucion.vertices = tocados_.size();
+  ejecucion.duracion_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - ahora_)
+                              .count();
+  return ejecucion.rutas > 0;
+}
+
+std::vector<RutaOSPF> CalculoSPF::rutas() const {
+  std::vector<RutaOSPF> lista;
+  for (const auto &[clave, prefijo] : prefijos_)
+    if (prefijo.tiene_ruta)
+      lista.push_back(prefijo.ruta);
+  std::sort(lista.begin(), lista.end(),
+            [](const RutaOSPF &a, const RutaOSPF &b) {
+              return a.red != b.red ? a.red < b.red : a.mascara < b.mascara;
+            });
+  return lista;
+}
+
+std::size_t CalculoSPF::alcanzados() const {
+  return std::count_if(vertices_.begin(), vertices_.end(),
+                       [](const Vertice &v) { return v.distancia != INFINITO; });
+}
+
+bool CalculoSPF::camino(uint32_t router_id, uint32_t &distancia, int &salida,
+                        uint32_t &via) const {
+  auto it = por_router_id_.find(router_id);
+  if (it == por_router_id_.end())
+    return false;
+  const Vertice &v = vertices_[it->second];
+  if (v.distancia == INFINITO || v.salida < 0)
+    return false;
+  distancia = v.distancia;
+  salida = v.salida;
+  via = v.via;
+  return true;
+}
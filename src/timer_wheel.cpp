@@ -0,0 +1,232 @@
+#include "../include/timer_wheel.hpp"
+#include <algorithm>
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick)
+    : tick_(std::max(tick, std::chrono::milliseconds(1))) {
+  for (auto &nivel : ranuras_)
+    std::fill(std::begin(nivel), std::end(nivel), NINGUNO);
+}
+
+TimerWheel::~TimerWheel() { stop(); }
+
+void TimerWheel::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_)
+    return;
+  running_ = true;
+  hilo_ = std::thread(&TimerWheel::bucle, this);
+}
+
+void TimerWheel::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  if (hilo_.joinable())
+    hilo_.join();
+}
+
+TimerWheel::Nodo *TimerWheel::buscar(Id id) {
+  uint32_t indice = static_cast<uint32_t>(id) - 1;
+  if (id == 0 || indice >= nodos_.size())
+    return nullptr;
+  Nodo &nodo = nodos_[indice];
+  if (nodo.generacion != static_cast<uint32_t>(id >> 32) || !nodo.lista)
+    return nullptr;
+  return &nodo;
+}
+
+const TimerWheel::Nodo *TimerWheel::buscar(Id id) const {
+  return const_cast<TimerWheel *>(this)->buscar(id);
+}
+
+uint64_t TimerWheel::ticks_de(std::chrono::milliseconds espera) const {
+  if (espera.count() <= 0)
+    return 1;
+  uint64_t ticks = (espera.count() + tick_.count() - 1) / tick_.count();
+  return std::clamp<uint64_t>(ticks, 1, MAX_TICKS);
+}
+
+// Ranura según cuánto falta: el nivel n guarda lo que vence dentro de
+// RANURAS^(n+1) ticks, indexado por los bits de 'vence' de ese nivel
+void TimerWheel::insertar(uint32_t indice) {
+  Nodo &nodo = nodos_[indice];
+  uint64_t falta = nodo.vence > ahora_ ? nodo.vence - ahora_ : 0;
+  std::size_t nivel = 0;
+  while (nivel + 1 < NIVELES && falta >= (uint64_t(1) << (BITS_RANURA * (nivel + 1))))
+    nivel++;
+  uint32_t *lista =
+      &ranuras_[nivel][(nodo.vence >> (BITS_RANURA * nivel)) & (RANURAS - 1)];
+
+  nodo.lista = lista;
+  nodo.anterior = NINGUNO;
+  nodo.siguiente = *lista;
+  if (*lista != NINGUNO)
+    nodos_[*lista].anterior = indice;
+  *lista = indice;
+}
+
+void TimerWheel::desenlazar(uint32_t indice) {
+  Nodo &nodo = nodos_[indice];
+  if (nodo.anterior != NINGUNO)
+    nodos_[nodo.anterior].siguiente = nodo.siguiente;
+  else
+    *nodo.lista = nodo.siguiente;
+  if (nodo.siguiente != NINGUNO)
+    nodos_[nodo.siguiente].anterior = nodo.anterior;
+  nodo.anterior = nodo.siguiente = NINGUNO;
+}
+
+void TimerWheel::liberar(uint32_t indice) {
+  Nodo &nodo = nodos_[indice];
+  nodo.lista = nullptr;
+  nodo.generacion++; // Los Id que apuntaban a este nodo dejan de valer
+  nodo.dueno = nullptr;
+  nodo.cb = nullptr;
+  libres_.push_back(indice);
+  pendientes_--;
+}
+
+TimerWheel::Id TimerWheel::programar(std::chrono::milliseconds espera,
+                                     Callback cb, const void *dueno) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t indice;
+  if (!libres_.empty()) {
+    indice = libres_.back();
+    libres_.pop_back();
+  } else {
+    indice = static_cast<uint32_t>(nodos_.size());
+    nodos_.emplace_back();
+  }
+  Nodo &nodo = nodos_[indice];
+  nodo.vence = ahora_ + ticks_de(espera);
+  nodo.dueno = dueno;
+  nodo.cb = std::move(cb);
+  insertar(indice);
+  pendientes_++;
+  return armar_id(indice, nodo.generacion);
+}
+
+bool TimerWheel::reprogramar(Id id, std::chrono::milliseconds espera) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Nodo *nodo = buscar(id);
+  if (!nodo || nodo->lista == &vencidos_lista_)
+    return false;
+  uint32_t indice = static_cast<uint32_t>(id) - 1;
+  desenlazar(indice);
+  nodo->vence = ahora_ + ticks_de(espera);
+  insertar(indice);
+  return true;
+}
+
+bool TimerWheel::cancelar(Id id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!buscar(id))
+    return false;
+  uint32_t indice = static_cast<uint32_t>(id) - 1;
+  desenlazar(indice);
+  liberar(indice);
+  return true;
+}
+
+void TimerWheel::cancelar_todos(const void *dueno) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (uint32_t i = 0; i < nodos_.size(); ++i) {
+    if (nodos_[i].lista && nodos_[i].dueno == dueno) {
+      desenlazar(i);
+      liberar(i);
+    }
+  }
+  if (std::this_thread::get_id() == hilo_callbacks_)
+    return;
+  cv_.wait(lock, [&] { return en_curso_ == 0 || dueno_en_curso_ != dueno; });
+}
+
+int64_t TimerWheel::restante_ms(Id id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Nodo *nodo = buscar(id);
+  if (!nodo)
+    return -1;
+  uint64_t falta = nodo->vence > ahora_ ? nodo->vence - ahora_ : 0;
+  return static_cast<int64_t>(falta) * tick_.count();
+}
+
+std::size_t TimerWheel::pendientes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pendientes_;
+}
+
+// Bajar un nivel los temporizadores de la ranura que corresponde al tick
+// actual; los que ya quedan a menos de RANURAS ticks caen en el primer nivel
+void TimerWheel::cascada(std::size_t nivel) {
+  uint32_t *lista =
+      &ranuras_[nivel][(ahora_ >> (BITS_RANURA * nivel)) & (RANURAS - 1)];
+  uint32_t indice = *lista;
+  *lista = NINGUNO;
+  while (indice != NINGUNO) {
+    uint32_t siguiente = nodos_[indice].siguiente;
+    insertar(indice);
+    indice = siguiente;
+  }
+}
+
+void TimerWheel::avanzar_un_tick(std::unique_lock<std::mutex> &lock) {
+  ahora_++;
+  // Cuando un nivel da la vuelta se reparte la ranura siguiente del de arriba
+  for (std::size_t nivel = 1; nivel < NIVELES; ++nivel) {
+    if ((ahora_ & ((uint64_t(1) << (BITS_RANURA * nivel)) - 1)) != 0)
+      break;
+    cascada(nivel);
+  }
+
+  // Lo que vence ahora pasa a la lista de vencidos (los callbacks pueden
+  // cancelar a otros de la misma lista)
+  uint32_t *ranura = &ranuras_[0][ahora_ & (RANURAS - 1)];
+  for (uint32_t i = *ranura; i != NINGUNO; i = nodos_[i].siguiente)
+    nodos_[i].lista = &vencidos_lista_;
+  vencidos_lista_ = *ranura;
+  *ranura = NINGUNO;
+
+  while (vencidos_lista_ != NINGUNO) {
+    uint32_t indice = vencidos_lista_;
+    desenlazar(indice);
+    Nodo &nodo = nodos_[indice];
+    Id id = armar_id(indice, nodo.generacion);
+    Callback cb = std::move(nodo.cb);
+    dueno_en_curso_ = nodo.dueno;
+    en_curso_ = id;
+    liberar(indice);
+    vencidos_.fetch_add(1, std::memory_order_relaxed);
+
+    lock.unlock();
+    cb(id);
+    lock.lock();
+    en_curso_ = 0;
+    dueno_en_curso_ = nullptr;
+    cv_.notify_all();
+  }
+}
+
+void TimerWheel::avanzar(uint64_t ticks) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  hilo_callbacks_ = std::this_thread::get_id();
+  for (uint64_t i = 0; i < ticks; ++i)
+    avanzar_un_tick(lock);
+}
+
+void TimerWheel::bucle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  hilo_callbacks_ = std::this_thread::get_id();
+  auto proximo = std::chrono::steady_clock::now() + tick_;
+  while (running_) {
+    if (cv_.wait_until(lock, proximo, [this] { return !running_; }))
+      break;
+    // Si el hilo se atrasó se procesan todos los ticks perdidos
+    auto ahora = std::chrono::steady_clock::now();
+    while (running_ && proximo <= ahora) {
+      avanzar_un_tick(lock);
+      proximo += tick_;
+    }
+  }
+}
@@ -0,0 +1,375 @@
+#include "../include/topology.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Formato del índice (todo en el orden de bytes del host, alineado a 4):
+//   CabeceraIndice | RouterIndice[routers] (orden de aparición)
+//   | uint32_t[routers] (posiciones ordenadas por nombre)
+//   | EntradaIndice[entries] (agrupadas por router) | cadenas
+constexpr char INDICE_MAGIC[8] = {'R', 'T', 'O', 'P', 'I', 'D', 'X', '\0'};
+constexpr uint32_t INDICE_VERSION = 1;
+
+struct CabeceraIndice {
+  char magic[8];
+  uint32_t version;
+  uint32_t routers;
+  uint32_t entries;
+  uint32_t strings_size;
+};
+
+struct RouterIndice {
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t first; // Primera entrada del router
+  uint32_t count;
+};
+
+struct EntradaIndice {
+  uint32_t interface_offset;
+  uint32_t interface_length;
+  uint32_t kind;
+  int32_t local_port;
+  uint32_t remote_offset;
+  uint32_t remote_length;
+  int32_t remote_port;
+  uint32_t rx_queues;
+};
+
+bool es_espacio(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Siguiente campo separado por espacios; vacío al final de la línea
+std::string_view siguiente_campo(const char *&p, const char *fin) {
+  while (p < fin && es_espacio(*p))
+    ++p;
+  const char *inicio = p;
+  while (p < fin && !es_espacio(*p))
+    ++p;
+  return std::string_view(inicio, p - inicio);
+}
+
+bool parsear_entero(std::string_view campo, int &valor) {
+  if (campo.empty())
+    return false;
+  auto [fin, ec] =
+      std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+  return ec == std::errc() && fin == campo.data() + campo.size();
+}
+
+// Formatos: [Router] [Interfaz] [PuertoLocal] [IP_Remota] [PuertoRemoto] [Colas]
+//           [Router] [Interfaz] shm|mem [NombreEnlace]
+// El router ya fue leído; 'p' queda después de él.
+bool parsear_resto(const char *p, const char *fin, TopologyEntry &entrada) {
+  entrada.interface_name = siguiente_campo(p, fin);
+  std::string_view tipo = siguiente_campo(p, fin);
+  if (tipo.empty())
+    return false;
+
+  if (tipo == "shm" || tipo == "mem") {
+    entrada.kind = tipo == "shm" ? TopologyEntry::Kind::SHM
+                                 : TopologyEntry::Kind::MEM;
+    entrada.remote = siguiente_campo(p, fin);
+    return !entrada.remote.empty();
+  }
+
+  entrada.kind = TopologyEntry::Kind::UDP;
+  if (!parsear_entero(tipo, entrada.local_port))
+    return false;
+  entrada.remote = siguiente_campo(p, fin);
+  if (entrada.remote.empty() ||
+      !parsear_entero(siguiente_campo(p, fin), entrada.remote_port))
+    return false;
+  int colas;
+  entrada.rx_queues =
+      parsear_entero(siguiente_campo(p, fin), colas) && colas > 0 ? colas : 1;
+  return true;
+}
+
+} // namespace
+
+TopologyFile::~TopologyFile() { close(); }
+
+bool TopologyFile::open(const std::string &path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Error: No se pudo abrir el archivo de topología: " << path
+              << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    perror("Error en fstat de la topología");
+    ::close(fd);
+    return false;
+  }
+  len_ = static_cast<std::size_t>(st.st_size);
+  if (len_ > 0) {
+    void *mem = mmap(nullptr, len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mem == MAP_FAILED) {
+      perror("Error en mmap de la topología");
+      ::close(fd);
+      len_ = 0;
+      return false;
+    }
+    data_ = static_cast<const char *>(mem);
+  }
+  ::close(fd); // El mapeo sigue valiendo sin el descriptor
+
+  format_ = Format::TEXT;
+  if (len_ >= sizeof(INDICE_MAGIC) &&
+      std::memcmp(data_, INDICE_MAGIC, sizeof(INDICE_MAGIC)) == 0) {
+    if (!open_index()) {
+      std::cerr << "Error: índice de topología inválido: " << path
+                << std::endl;
+      close();
+      return false;
+    }
+    format_ = Format::INDEX;
+  } else {
+    // Lectura secuencial: el kernel adelanta páginas
+    madvise(const_cast<char *>(data_), len_, MADV_SEQUENTIAL);
+  }
+  return true;
+}
+
+void TopologyFile::close() {
+  if (data_)
+    munmap(const_cast<char *>(data_), len_);
+  data_ = nullptr;
+  len_ = 0;
+  routers_ = entries_ = 0;
+}
+
+bool TopologyFile::open_index() {
+  if (len_ < sizeof(CabeceraIndice))
+    return false;
+  CabeceraIndice cabecera;
+  std::memcpy(&cabecera, data_, sizeof(cabecera));
+  if (cabecera.version != INDICE_VERSION)
+    return false;
+
+  // Sólo se validan los tamaños de las secciones; las posiciones de cada
+  // entrada se verifican al leerlas para no recorrer el índice entero
+  router_table_ = sizeof(CabeceraIndice);
+  sorted_table_ =
+      router_table_ + std::size_t(cabecera.routers) * sizeof(RouterIndice);
+  entry_table_ = sorted_table_ + std::size_t(cabecera.routers) * sizeof(uint32_t);
+  strings_ =
+      entry_table_ + std::size_t(cabecera.entries) * sizeof(EntradaIndice);
+  strings_size_ = cabecera.strings_size;
+  if (strings_ + strings_size_ > len_)
+    return false;
+  routers_ = cabecera.routers;
+  entries_ = cabecera.entries;
+  return true;
+}
+
+std::string_view TopologyFile::index_string(uint32_t offset,
+                                            uint32_t length) const {
+  if (std::size_t(offset) + length > strings_size_)
+    return {};
+  return std::string_view(data_ + strings_ + offset, length);
+}
+
+void TopologyFile::visit_router(uint32_t router, const Visitor &visit) const {
+  const auto *tabla =
+      reinterpret_cast<const RouterIndice *>(data_ + router_table_);
+  const auto *entradas =
+      reinterpret_cast<const EntradaIndice *>(data_ + entry_table_);
+  const RouterIndice &r = tabla[router];
+  if (std::size_t(r.first) + r.count > entries_)
+    return;
+
+  TopologyEntry entrada;
+  entrada.router = index_string(r.name_offset, r.name_length);
+  for (uint32_t i = r.first; i < r.first + r.count; ++i) {
+    const EntradaIndice &e = entradas[i];
+    entrada.interface_name =
+        index_string(e.interface_offset, e.interface_length);
+    entrada.kind = static_cast<TopologyEntry::Kind>(e.kind);
+    entrada.local_port = e.local_port;
+    entrada.remote = index_string(e.remote_offset, e.remote_length);
+    entrada.remote_port = e.remote_port;
+    entrada.rx_queues = e.rx_queues;
+    visit(entrada);
+  }
+}
+
+std::size_t TopologyFile::scan_text(std::string_view router,
+                                    const Visitor &visit) const {
+  std::size_t encontradas = 0;
+  const char *p = data_;
+  const char *fin_archivo = data_ + len_;
+  TopologyEntry entrada;
+  while (p < fin_archivo) {
+    const char *fin = static_cast<const char *>(
+        std::memchr(p, '\n', fin_archivo - p));
+    if (!fin)
+      fin = fin_archivo;
+    const char *linea = p;
+    p = fin + 1;
+    if (linea == fin || *linea == '#')
+      continue;
+
+    entrada = TopologyEntry{};
+    entrada.router = siguiente_campo(linea, fin);
+    if (entrada.router.empty() || (!router.empty() && entrada.router != router))
+      continue;
+    if (!parsear_resto(linea, fin, entrada))
+      continue;
+    visit(entrada);
+    encontradas++;
+  }
+  return encontradas;
+}
+
+std::size_t TopologyFile::for_each(const Visitor &visit) const {
+  if (format_ == Format::TEXT)
+    return scan_text({}, visit);
+  for (uint32_t r = 0; r < routers_; ++r)
+    visit_router(r, visit);
+  return entries_;
+}
+
+std::size_t TopologyFile::find(std::string_view router,
+                               const Visitor &visit) const {
+  if (router.empty())
+    return 0;
+  if (format_ == Format::TEXT)
+    return scan_text(router, visit);
+
+  const auto *tabla =
+      reinterpret_cast<const RouterIndice *>(data_ + router_table_);
+  const auto *ordenados =
+      reinterpret_cast<const uint32_t *>(data_ + sorted_table_);
+  const uint32_t *it = std::lower_bound(
+      ordenados, ordenados + routers_, router,
+      [&](uint32_t i, std::string_view nombre) {
+        return i < routers_ &&
+               index_string(tabla[i].name_offset, tabla[i].name_length) <
+                   nombre;
+      });
+  if (it == ordenados + routers_ || *it >= routers_)
+    return 0;
+  const RouterIndice &r = tabla[*it];
+  if (index_string(r.name_offset, r.name_length) != router)
+    return 0;
+  visit_router(*it, visit);
+  return r.count;
+}
+
+bool TopologyFile::compile(const std::string &source,
+                           const std::string &target) {
+  TopologyFile texto;
+  if (!texto.open(source))
+    return false;
+  if (texto.format() != Format::TEXT) {
+    std::cerr << "Error: " << source << " ya es un índice de topología"
+              << std::endl;
+    return false;
+  }
+
+  // Cadenas sin repetir (los nombres de interfaz se repiten en cada router)
+  std::string cadenas;
+  std::unordered_map<std::string_view, uint32_t> posiciones;
+  auto guardar = [&](std::string_view s) {
+    auto it = posiciones.find(s);
+    if (it != posiciones.end())
+      return it->second;
+    uint32_t pos = static_cast<uint32_t>(cadenas.size());
+    cadenas.append(s);
+    posiciones.emplace(s, pos); // Las vistas apuntan al archivo mapeado
+    return pos;
+  };
+
+  std::vector<RouterIndice> routers;
+  std::vector<std::vector<EntradaIndice>> por_router;
+  std::unordered_map<std::string_view, uint32_t> router_de;
+  std::size_t total = texto.for_each([&](const TopologyEntry &e) {
+    auto [it, nuevo] = router_de.emplace(e.router, routers.size());
+    if (nuevo) {
+      routers.push_back({guardar(e.router),
+                         static_cast<uint32_t>(e.router.size()), 0, 0});
+      por_router.emplace_back();
+    }
+    por_router[it->second].push_back(
+        {guardar(e.interface_name),
+         static_cast<uint32_t>(e.interface_name.size()),
+         static_cast<uint32_t>(e.kind), e.local_port, guardar(e.remote),
+         static_cast<uint32_t>(e.remote.size()), e.remote_port,
+         static_cast<uint32_t>(e.rx_queues)});
+  });
+  if (cadenas.size() > UINT32_MAX || total > UINT32_MAX) {
+    std::cerr << "Error: topología demasiado grande para el índice"
+              << std::endl;
+    return false;
+  }
+
+  std::vector<EntradaIndice> entradas;
+  entradas.reserve(total);
+  for (std::size_t r = 0; r < routers.size(); ++r) {
+    routers[r].first = static_cast<uint32_t>(entradas.size());
+    routers[r].count = static_cast<uint32_t>(por_router[r].size());
+    entradas.insert(entradas.end(), por_router[r].begin(), por_router[r].end());
+  }
+  std::vector<uint32_t> ordenados(routers.size());
+  for (uint32_t i = 0; i < ordenados.size(); ++i)
+    ordenados[i] = i;
+  auto nombre = [&](uint32_t i) {
+    return std::string_view(cadenas).substr(routers[i].name_offset,
+                                            routers[i].name_length);
+  };
+  std::sort(ordenados.begin(), ordenados.end(),
+            [&](uint32_t a, uint32_t b) { return nombre(a) < nombre(b); });
+
+  CabeceraIndice cabecera;
+  std::memcpy(cabecera.magic, INDICE_MAGIC, sizeof(INDICE_MAGIC));
+  cabecera.version = INDICE_VERSION;
+  cabecera.routers = static_cast<uint32_t>(routers.size());
+  cabecera.entries = static_cast<uint32_t>(entradas.size());
+  cabecera.strings_size = static_cast<uint32_t>(cadenas.size());
+
+  // Se escribe aparte y se renombra: un router que arranca mientras tanto ve
+  // el índice anterior o el nuevo completo
+  std::string temporal = target + ".tmp";
+  {
+    std::ofstream salida(temporal, std::ios::binary | std::ios::trunc);
+    if (!salida.is_open()) {
+      std::cerr << "Error: No se pudo crear " << temporal << std::endl;
+      return false;
+    }
+    salida.write(reinterpret_cast<const char *>(&cabecera), sizeof(cabecera));
+    salida.write(reinterpret_cast<const char *>(routers.data()),
+                 routers.size() * sizeof(RouterIndice));
+    salida.write(reinterpret_cast<const char *>(ordenados.data()),
+                 ordenados.size() * sizeof(uint32_t));
+    salida.write(reinterpret_cast<const char *>(entradas.data()),
+                 entradas.size() * sizeof(EntradaIndice));
+    salida.write(cadenas.data(), cadenas.size());
+    if (!salida) {
+      std::cerr << "Error al escribir " << temporal << std::endl;
+      std::remove(temporal.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporal.c_str(), target.c_str()) != 0) {
+    perror("Error al renombrar el índice de topología");
+    std::remove(temporal.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,287 @@
+#include "../include/traffic_gen.hpp"
+#include "../include/network_engine.hpp"
+#include "../include/ping.hpp"
+#include <algorithm>
+#include <bit>
+#include <random>
+
+namespace {
+
+// Actualizar un máximo compartido entre hilos
+void guardar_maximo(std::atomic<uint64_t> &maximo, uint64_t valor) {
+  uint64_t actual = maximo.load(std::memory_order_relaxed);
+  while (valor > actual &&
+         !maximo.compare_exchange_weak(actual, valor,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+// Percentil aproximado de un histograma en potencias de dos (límite superior
+// del bucket donde cae)
+double percentil_us(const uint64_t *histograma, std::size_t buckets,
+                    uint64_t total, double fraccion) {
+  uint64_t objetivo = static_cast<uint64_t>(total * fraccion);
+  uint64_t acumulado = 0;
+  for (std::size_t b = 0; b < buckets; ++b) {
+    acumulado += histograma[b];
+    if (acumulado > objetivo)
+      return static_cast<double>(uint64_t(1) << b) / 1000.0;
+  }
+  return static_cast<double>(uint64_t(1) << (buckets - 1)) / 1000.0;
+}
+
+} // namespace
+
+// ----------------------------- Generador -----------------------------
+
+bool GeneradorTrafico::start(const OpcionesGenerador &opciones) {
+  const PlantillaTrafico &p = opciones.plantilla;
+  if (activo_ || opciones.ifindex < 0 || p.destino_fin < p.destino_inicio ||
+      p.size_min < sizeof(CabeceraTrafico) || p.size_max < p.size_min ||
+      p.size_max > PACKET_MAX_PAYLOAD)
+    return false;
+  if (hilo_.joinable())
+    hilo_.join(); // Corrida anterior que terminó sola
+
+  opciones_ = opciones;
+  stats_.enviados = 0;
+  stats_.bytes = 0;
+  stats_.errores = 0;
+  stats_.sin_buffer = 0;
+  std::random_device azar;
+  do {
+    flujo_ = azar();
+  } while (flujo_ == 0);
+
+  inicio_ns_ = ahora_ns();
+  fin_ns_ = 0;
+  running_ = true;
+  activo_ = true;
+  hilo_ = std::thread(&GeneradorTrafico::bucle, this);
+  return true;
+}
+
+void GeneradorTrafico::stop() {
+  running_ = false;
+  if (hilo_.joinable())
+    hilo_.join();
+}
+
+double GeneradorTrafico::segundos() const {
+  uint64_t inicio = inicio_ns_.load();
+  if (inicio == 0)
+    return 0;
+  uint64_t fin = fin_ns_.load();
+  return ((fin ? fin : ahora_ns()) - inicio) / 1e9;
+}
+
+void GeneradorTrafico::bucle() {
+  const PlantillaTrafico &p = opciones_.plantilla;
+  const uint64_t destinos = uint64_t(p.destino_fin) - p.destino_inicio + 1;
+  const uint64_t inicio = inicio_ns_.load();
+  const uint64_t limite_ns =
+      opciones_.duracion.count() > 0
+          ? inicio + static_cast<uint64_t>(opciones_.duracion.count()) * 1000000
+          : UINT64_MAX;
+  std::minstd_rand azar(flujo_);
+  std::uniform_int_distribution<std::size_t> tamano(p.size_min, p.size_max);
+
+  TxBatch tx(net_); // Los paquetes de cada ráfaga salen con una sola llamada
+  uint64_t k = 0;   // Paquetes generados
+  while (running_) {
+    uint64_t ahora = ahora_ns();
+    if ((opciones_.total && k >= opciones_.total) || ahora >= limite_ns)
+      break;
+
+    // Cuántos paquetes deberían haber salido ya según el ritmo pedido
+    uint64_t objetivo = k + RAFAGA;
+    if (opciones_.pps) {
+      uint64_t debidos = static_cast<uint64_t>(
+          static_cast<double>(ahora - inicio) * opciones_.pps / 1e9) + 1;
+      objetivo = std::min(objetivo, debidos);
+    }
+    if (opciones_.total)
+      objetivo = std::min(objetivo, opciones_.total);
+    if (objetivo <= k) {
+      // Dormir hasta que toque el siguiente paquete (como mucho 1 ms para
+      // atender stop())
+      uint64_t siguiente =
+          inicio + static_cast<uint64_t>(k * 1e9 / opciones_.pps);
+      uint64_t espera = std::min<uint64_t>(siguiente - ahora, 1000000);
+      std::this_thread::sleep_for(std::chrono::nanoseconds(espera));
+      continue;
+    }
+
+    for (; k < objetivo; ++k) {
+      PacketRef ref = net_.pool().alloc();
+      if (!ref) {
+        stats_.sin_buffer.fetch_add(1, std::memory_order_relaxed);
+        break; // Se reintenta después del flush, que devuelve buffers
+      }
+      SimulatedPacket &pkt = *ref;
+      pkt.version = PACKET_VERSION;
+      pkt.ttl = p.ttl;
+      pkt.protocol = p.protocol;
+      pkt.flags = 0;
+      pkt.src_ip = p.origen;
+      pkt.dst_ip = p.destino_inicio + static_cast<uint32_t>(k % destinos);
+      pkt.payload_len = static_cast<uint16_t>(tamano(azar));
+
+      CabeceraTrafico cab;
+      std::memcpy(cab.marca, TRAFICO_MARCA, sizeof(cab.marca));
+      cab.flujo = htonl(flujo_);
+      cab.seq = htonl(static_cast<uint32_t>(k / destinos));
+      cab.enviado_ns = ahora_ns();
+      std::memcpy(pkt.payload, &cab, sizeof(cab));
+
+      std::size_t bytes = pkt.wire_size();
+      if (net_.queue_packet(opciones_.ifindex, std::move(ref))) {
+        stats_.enviados.fetch_add(1, std::memory_order_relaxed);
+        stats_.bytes.fetch_add(bytes, std::memory_order_relaxed);
+      } else {
+        stats_.errores.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    tx.flush();
+    if (k < objetivo)
+      std::this_thread::yield(); // Pool agotado: dejar que se vacíe
+  }
+
+  tx.flush();
+  fin_ns_ = ahora_ns();
+  activo_ = false;
+}
+
+// ----------------------------- Receptor -----------------------------
+
+ReceptorTrafico::Entrada *ReceptorTrafico::entrada(uint64_t clave) {
+  Entrada *entradas = entradas_.load(std::memory_order_acquire);
+  if (!entradas) {
+    Entrada *nueva = new Entrada[MAX_ENTRADAS];
+    if (entradas_.compare_exchange_strong(entradas, nueva,
+                                          std::memory_order_acq_rel))
+      entradas = nueva;
+    else
+      delete[] nueva; // Otro hilo RX la creó primero
+  }
+
+  // Mezcla de Fibonacci sobre la clave de 64 bits
+  std::size_t mascara = MAX_ENTRADAS - 1;
+  std::size_t i = static_cast<std::size_t>(
+      (clave * 0x9E3779B97F4A7C15ull) >> (64 - std::countr_zero(MAX_ENTRADAS)));
+  for (std::size_t intentos = 0; intentos < MAX_ENTRADAS; ++intentos) {
+    Entrada &e = entradas[(i + intentos) & mascara];
+    uint64_t actual = e.clave.load(std::memory_order_acquire);
+    if (actual == clave)
+      return &e;
+    if (actual == 0) {
+      if (e.clave.compare_exchange_strong(actual, clave) || actual == clave)
+        return &e;
+    }
+  }
+  return nullptr;
+}
+
+bool ReceptorTrafico::registrar(const SimulatedPacket &pkt) {
+  if (pkt.payload_len < sizeof(CabeceraTrafico) ||
+      std::memcmp(pkt.payload, TRAFICO_MARCA, sizeof(TRAFICO_MARCA)) != 0)
+    return false;
+
+  CabeceraTrafico cab;
+  std::memcpy(&cab, pkt.payload, sizeof(cab));
+  uint64_t clave = uint64_t(ntohl(cab.flujo)) << 32 | pkt.dst_ip;
+  Entrada *e = clave ? entrada(clave) : nullptr;
+  if (!e) {
+    sin_lugar_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  uint64_t ahora = ahora_ns();
+  uint64_t latencia = ahora > cab.enviado_ns ? ahora - cab.enviado_ns : 0;
+  uint64_t vacio = 0;
+  e->primero_ns.compare_exchange_strong(vacio, ahora,
+                                        std::memory_order_relaxed);
+  guardar_maximo(e->ultimo_ns, ahora);
+  guardar_maximo(e->esperados, uint64_t(ntohl(cab.seq)) + 1);
+  guardar_maximo(e->latencia_max_ns, latencia);
+  e->paquetes.fetch_add(1, std::memory_order_relaxed);
+  e->bytes.fetch_add(pkt.wire_size(), std::memory_order_relaxed);
+  e->latencia_ns.fetch_add(latencia, std::memory_order_relaxed);
+  std::size_t bucket = std::min<std::size_t>(std::bit_width(latencia),
+                                             BUCKETS - 1);
+  e->histograma[bucket].fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+std::vector<ReceptorTrafico::Resumen> ReceptorTrafico::resumen() const {
+  struct Acumulado {
+    Resumen r;
+    uint64_t primero = UINT64_MAX, ultimo = 0, latencia = 0, maximo = 0;
+    uint64_t histograma[BUCKETS] = {};
+  };
+  std::vector<Acumulado> flujos;
+
+  const Entrada *entradas = entradas_.load(std::memory_order_acquire);
+  for (std::size_t i = 0; entradas && i < MAX_ENTRADAS; ++i) {
+    const Entrada &e = entradas[i];
+    uint64_t clave = e.clave.load();
+    uint64_t paquetes = e.paquetes.load();
+    if (clave == 0 || paquetes == 0)
+      continue;
+    uint32_t flujo = static_cast<uint32_t>(clave >> 32);
+    auto it = std::find_if(flujos.begin(), flujos.end(),
+                           [flujo](const Acumulado &a) {
+                             return a.r.flujo == flujo;
+                           });
+    if (it == flujos.end()) {
+      flujos.emplace_back();
+      it = flujos.end() - 1;
+      it->r.flujo = flujo;
+    }
+    uint64_t esperados = e.esperados.load();
+    it->r.destinos++;
+    it->r.paquetes += paquetes;
+    it->r.bytes += e.bytes.load();
+    it->r.perdidos += esperados > paquetes ? esperados - paquetes : 0;
+    it->primero = std::min(it->primero, e.primero_ns.load());
+    it->ultimo = std::max(it->ultimo, e.ultimo_ns.load());
+    it->latencia += e.latencia_ns.load();
+    it->maximo = std::max(it->maximo, e.latencia_max_ns.load());
+    for (std::size_t b = 0; b < BUCKETS; ++b)
+      it->histograma[b] += e.histograma[b].load();
+  }
+
+  std::vector<Resumen> resultado;
+  for (auto &a : flujos) {
+    Resumen &r = a.r;
+    r.segundos = a.ultimo > a.primero ? (a.ultimo - a.primero) / 1e9 : 0;
+    r.lat_avg_us = a.latencia / 1000.0 / r.paquetes;
+    r.lat_max_us = a.maximo / 1000.0;
+    r.lat_p50_us = std::min(
+        r.lat_max_us, percentil_us(a.histograma, BUCKETS, r.paquetes, 0.50));
+    r.lat_p99_us = std::min(
+        r.lat_max_us, percentil_us(a.histograma, BUCKETS, r.paquetes, 0.99));
+    resultado.push_back(r);
+  }
+  return resultado;
+}
+
+// Los hilos RX pueden seguir contando mientras se limpia; a lo sumo queda
+// algún paquete de la medición anterior
+void ReceptorTrafico::limpiar() {
+  Entrada *entradas = entradas_.load(std::memory_order_acquire);
+  for (std::size_t i = 0; entradas && i < MAX_ENTRADAS; ++i) {
+    Entrada &e = entradas[i];
+    e.paquetes = 0;
+    e.bytes = 0;
+    e.esperados = 0;
+    e.primero_ns = 0;
+    e.ultimo_ns = 0;
+    e.latencia_ns = 0;
+    e.latencia_max_ns = 0;
+    for (auto &b : e.histograma)
+      b = 0;
+    e.clave = 0;
+  }
+  sin_lugar_ = 0;
+}
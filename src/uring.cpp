@@ -0,0 +1,293 @@
+#include "../include/uring.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ROUTER_HAVE_URING 1
+#include <algorithm>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef ROUTER_HAVE_URING
+
+namespace {
+
+int uring_setup(unsigned entries, io_uring_params *p) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+int uring_register(int fd, unsigned opcode, const void *arg, unsigned nr) {
+  return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr));
+}
+
+template <typename T> T *en(void *base, uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+} // namespace
+
+bool Uring::Completion::more() const { return flags & IORING_CQE_F_MORE; }
+bool Uring::Completion::has_buffer() const {
+  return flags & IORING_CQE_F_BUFFER;
+}
+uint16_t Uring::Completion::buffer_id() const {
+  return static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+Uring::~Uring() {
+  if (sqes_)
+    munmap(sqes_, sqes_len_);
+  if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+    munmap(cq_ptr_, cq_len_);
+  if (sq_ptr_)
+    munmap(sq_ptr_, sq_len_);
+  if (buf_ring_)
+    munmap(buf_ring_, buf_ring_len_);
+  if (buf_mem_)
+    munmap(buf_mem_, buf_mem_len_);
+  if (fd_ >= 0)
+    close(fd_);
+}
+
+bool Uring::init(unsigned entries, unsigned cq_entries) {
+  io_uring_params p;
+  std::memset(&p, 0, sizeof(p));
+  if (cq_entries > 0) {
+    p.flags |= IORING_SETUP_CQSIZE;
+    p.cq_entries = cq_entries;
+  }
+  fd_ = uring_setup(entries, &p);
+  if (fd_ < 0)
+    return false;
+
+  sq_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+  bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+  if (single)
+    sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+
+  sq_ptr_ = mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+  if (sq_ptr_ == MAP_FAILED) {
+    sq_ptr_ = nullptr;
+    return false;
+  }
+  cq_ptr_ = single ? sq_ptr_
+                   : mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+  if (cq_ptr_ == MAP_FAILED) {
+    cq_ptr_ = nullptr;
+    return false;
+  }
+  sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    return false;
+  }
+
+  sq_head_ = en<unsigned>(sq_ptr_, p.sq_off.head);
+  sq_tail_ = en<unsigned>(sq_ptr_, p.sq_off.tail);
+  sq_mask_ = *en<unsigned>(sq_ptr_, p.sq_off.ring_mask);
+  sq_entries_ = p.sq_entries;
+  cq_head_ = en<unsigned>(cq_ptr_, p.cq_off.head);
+  cq_tail_ = en<unsigned>(cq_ptr_, p.cq_off.tail);
+  cq_mask_ = *en<unsigned>(cq_ptr_, p.cq_off.ring_mask);
+  cqes_ = en<io_uring_cqe>(cq_ptr_, p.cq_off.cqes);
+
+  // Cada posición del arreglo apunta siempre a la SQE del mismo índice
+  unsigned *array = en<unsigned>(sq_ptr_, p.sq_off.array);
+  for (unsigned i = 0; i < sq_entries_; ++i)
+    array[i] = i;
+  sqe_tail_ = sqe_head_ = *sq_tail_;
+  return true;
+}
+
+unsigned Uring::sq_space() const {
+  return sq_entries_ - (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE));
+}
+
+bool Uring::register_files(const int *fds, unsigned count) {
+  return uring_register(fd_, IORING_REGISTER_FILES, fds, count) == 0;
+}
+
+bool Uring::setup_buffers(uint16_t group, unsigned count, unsigned size) {
+  if (count == 0 || (count & (count - 1)) || count > 32768)
+    return false;
+
+  buf_ring_len_ = count * sizeof(io_uring_buf);
+  buf_ring_ = mmap(nullptr, buf_ring_len_, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buf_ring_ == MAP_FAILED) {
+    buf_ring_ = nullptr;
+    return false;
+  }
+  buf_mem_len_ = static_cast<std::size_t>(count) * size;
+  buf_mem_ = static_cast<char *>(mmap(nullptr, buf_mem_len_,
+                                      PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (buf_mem_ == MAP_FAILED) {
+    buf_mem_ = nullptr;
+    return false;
+  }
+
+  io_uring_buf_reg reg;
+  std::memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+  reg.ring_entries = count;
+  reg.bgid = group;
+  if (uring_register(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    return false;
+
+  buf_count_ = count;
+  buf_size_ = size;
+  buf_group_ = group;
+  for (unsigned i = 0; i < count; ++i)
+    recycle_buffer(static_cast<uint16_t>(i));
+  commit_buffers();
+  return true;
+}
+
+void Uring::unregister_files() {
+  uring_register(fd_, IORING_UNREGISTER_FILES, nullptr, 0);
+}
+
+char *Uring::buffer(uint16_t id) const {
+  return buf_mem_ + static_cast<std::size_t>(id) * buf_size_;
+}
+
+// En C++ el arreglo flexible de io_uring_buf_ring queda desplazado (el macro
+// del kernel agrega un struct vacío), así que el anillo se recorre como un
+// arreglo de io_uring_buf y la cola es el campo 'resv' de la primera entrada.
+void Uring::recycle_buffer(uint16_t id) {
+  auto *bufs = static_cast<io_uring_buf *>(buf_ring_);
+  io_uring_buf &buf = bufs[buf_tail_ & (buf_count_ - 1)];
+  buf.addr = reinterpret_cast<uint64_t>(buffer(id));
+  buf.len = buf_size_;
+  buf.bid = id;
+  buf_tail_++;
+}
+
+void Uring::commit_buffers() {
+  auto *bufs = static_cast<io_uring_buf *>(buf_ring_);
+  __atomic_store_n(&bufs[0].resv, buf_tail_, __ATOMIC_RELEASE);
+}
+
+void *Uring::sqe_slot() {
+  if (sq_space() == 0)
+    return nullptr;
+  io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + (sqe_tail_ & sq_mask_);
+  sqe_tail_++;
+  std::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+bool Uring::prep_recv_multishot(unsigned fixed_file, uint16_t group,
+                                uint64_t user_data) {
+  auto *sqe = static_cast<io_uring_sqe *>(sqe_slot());
+  if (!sqe)
+    return false;
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = static_cast<int>(fixed_file);
+  sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->buf_group = group;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Uring::prep_poll(int fd, uint64_t user_data) {
+  auto *sqe = static_cast<io_uring_sqe *>(sqe_slot());
+  if (!sqe)
+    return false;
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = POLLIN;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Uring::prep_sendmsg(int fd, const struct msghdr *msg,
+                         uint64_t user_data) {
+  auto *sqe = static_cast<io_uring_sqe *>(sqe_slot());
+  if (!sqe)
+    return false;
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(msg);
+  sqe->len = 1;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Uring::prep_cancel_all(uint64_t user_data) {
+  auto *sqe = static_cast<io_uring_sqe *>(sqe_slot());
+  if (!sqe)
+    return false;
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_ANY;
+  sqe->user_data = user_data;
+  return true;
+}
+
+// Se pasan todas las SQEs publicadas que el kernel todavía no consumió, no
+// sólo las nuevas: si una llamada anterior falló (EINTR, EAGAIN, EBUSY), las
+// suyas siguen en la cola y las toma el reintento
+int Uring::submit(unsigned wait) {
+  __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+  unsigned to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  sqe_head_ = sqe_tail_;
+  if (to_submit == 0 && wait == 0)
+    return 0;
+  return uring_enter(fd_, to_submit, wait, wait ? IORING_ENTER_GETEVENTS : 0);
+}
+
+unsigned Uring::reap(Completion *out, unsigned max) {
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  unsigned n = 0;
+  auto *cqes = static_cast<io_uring_cqe *>(cqes_);
+  while (head != tail && n < max) {
+    const io_uring_cqe &cqe = cqes[head & cq_mask_];
+    out[n++] = {cqe.user_data, cqe.res, cqe.flags};
+    head++;
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  return n;
+}
+
+#else // Sin io_uring: todo falla y el motor usa sockets
+
+bool Uring::Completion::more() const { return false; }
+bool Uring::Completion::has_buffer() const { return false; }
+uint16_t Uring::Completion::buffer_id() const { return 0; }
+Uring::~Uring() {}
+bool Uring::init(unsigned, unsigned) { return false; }
+unsigned Uring::sq_space() const { return 0; }
+bool Uring::register_files(const int *, unsigned) { return false; }
+void Uring::unregister_files() {}
+bool Uring::setup_buffers(uint16_t, unsigned, unsigned) { return false; }
+char *Uring::buffer(uint16_t) const { return nullptr; }
+void Uring::recycle_buffer(uint16_t) {}
+void Uring::commit_buffers() {}
+void *Uring::sqe_slot() { return nullptr; }
+bool Uring::prep_recv_multishot(unsigned, uint16_t, uint64_t) { return false; }
+bool Uring::prep_poll(int, uint64_t) { return false; }
+bool Uring::prep_sendmsg(int, const struct msghdr *, uint64_t) { return false; }
+bool Uring::prep_cancel_all(uint64_t) { return false; }
+int Uring::submit(unsigned) { return -1; }
+unsigned Uring::reap(Completion *, unsigned) { return 0; }
+
+#endif
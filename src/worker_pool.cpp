@@ -0,0 +1,85 @@
+#include "../include/worker_pool.hpp"
+#include <algorithm>
+
+WorkerPool::WorkerPool(std::size_t hilos) {
+  if (hilos == 0)
+    hilos = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2, 9) - 1;
+  hilos_.reserve(hilos);
+  for (std::size_t i = 0; i < hilos; ++i)
+    hilos_.emplace_back(&WorkerPool::bucle, this);
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    detener_ = true;
+  }
+  hay_trabajo_.notify_all();
+  for (auto &hilo : hilos_)
+    hilo.join();
+}
+
+void WorkerPool::ejecutar(const std::vector<std::function<void()>> &tareas) {
+  if (tareas.empty())
+    return;
+  lotes_.fetch_add(1, std::memory_order_relaxed);
+  if (tareas.size() == 1 || hilos_.empty()) {
+    for (const auto &tarea : tareas)
+      tarea();
+    return;
+  }
+
+  auto lote = std::make_shared<Lote>();
+  lote->tareas = &tareas;
+  lote->total = tareas.size();
+  lote->pendientes.store(tareas.size(), std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lotes_pendientes_.push_back(lote);
+  }
+  hay_trabajo_.notify_all();
+
+  trabajar(*lote);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  terminado_.wait(lock, [&] {
+    return lote->pendientes.load(std::memory_order_acquire) == 0;
+  });
+  // Si ningún hilo llegó a verlo agotado, sigue en la cola
+  auto it = std::find(lotes_pendientes_.begin(), lotes_pendientes_.end(), lote);
+  if (it != lotes_pendientes_.end())
+    lotes_pendientes_.erase(it);
+}
+
+void WorkerPool::trabajar(Lote &lote) {
+  while (true) {
+    std::size_t i = lote.siguiente.fetch_add(1, std::memory_order_relaxed);
+    if (i >= lote.total)
+      return;
+    (*lote.tareas)[i]();
+    if (lote.pendientes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // Con el mutex tomado para que el llamador no se pierda el aviso
+      std::lock_guard<std::mutex> lock(mutex_);
+      terminado_.notify_all();
+    }
+  }
+}
+
+void WorkerPool::bucle() {
+  while (true) {
+    std::shared_ptr<Lote> lote;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      hay_trabajo_.wait(lock,
+                        [&] { return detener_ || !lotes_pendientes_.empty(); });
+      if (detener_)
+        return;
+      lote = lotes_pendientes_.front();
+      if (lote->siguiente.load(std::memory_order_relaxed) >= lote->total) {
+        lotes_pendientes_.pop_front(); // Todas tomadas: no queda qué hacer
+        continue;
+      }
+    }
+    trabajar(*lote);
+  }
+}